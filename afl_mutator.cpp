@@ -0,0 +1,146 @@
+// afl_mutator.cpp
+// AFL++ custom mutator for FormatFuzzer
+//
+// The AFL++ queue holds decision files (as created by `parse --decisions').
+// afl_custom_fuzz() applies smart mutations (replace, insert, delete,
+// abstract) to the decisions of the current queue entry, and
+// afl_custom_post_process() generates the file that is passed to the
+// target from the decisions.  All queue entries are parsed once into an
+// in-memory chunk corpus.  Inputs that cannot be parsed, or that no
+// smart mutation applies to, get random byte mutations instead.
+//
+// Build with `make gif-mutator.so' and run AFL++ with
+//   AFL_CUSTOM_MUTATOR_LIBRARY=./gif-mutator.so AFL_CUSTOM_MUTATOR_ONLY=1
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <random>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+
+#include "formatfuzzer.h"
+
+extern "C" size_t ff_generate(unsigned char* data, size_t size, unsigned char** new_data);
+extern "C" int process_data(const unsigned char *data, size_t size);
+extern "C" int one_smart_mutation(int target_file_index, unsigned char** file, unsigned* file_size);
+extern "C" void seed_mutations(unsigned seed);
+extern "C" void ff_set_decision_tail(int mode);
+extern thread_local bool get_parse_tree;
+extern thread_local std::mt19937 mutation_rng;
+uint64_t hash_data(const unsigned char *data, size_t size);
+unsigned copy_rand(unsigned char *dest);
+unsigned int consumedRand();
+void set_generator();
+
+// Smart mutations to try before giving up on an input
+#define MUTATION_TRIES 8
+// Most bytes changed by a random mutation
+#define HAVOC_BYTES 8
+
+struct afl_mutator {
+	// Corpus index of every queue entry seen so far
+	std::unordered_map<std::string, int> file_indices;
+	// Corpus index, or -1, of every input passed to afl_custom_fuzz()
+	// without a parsed queue entry, by hash of its contents
+	std::unordered_map<uint64_t, int> data_indices;
+	int current = -1;
+	std::vector<unsigned char> decisions;
+};
+
+static int add_queue_entry(afl_mutator *m, const char *file_name) {
+	auto it = m->file_indices.find(file_name);
+	if (it != m->file_indices.end())
+		return it->second;
+
+	int index = -1;
+	int file_fd = open(file_name, O_RDONLY);
+	struct stat st;
+	if (file_fd != -1 && fstat(file_fd, &st) == 0) {
+		m->decisions.resize(st.st_size);
+		if (read(file_fd, m->decisions.data(), st.st_size) == st.st_size)
+			index = process_data(m->decisions.data(), st.st_size);
+	}
+	if (file_fd != -1)
+		close(file_fd);
+	m->file_indices[file_name] = index;
+	return index;
+}
+
+// Overwrite a few random decisions of buf; this is the fallback when no
+// smart mutation applies
+static size_t havoc(afl_mutator *m, const uint8_t *buf, size_t buf_size, uint8_t **out_buf, size_t max_size) {
+	m->decisions.assign(buf, buf + std::min(buf_size, max_size));
+	if (m->decisions.empty() && max_size)
+		m->decisions.push_back(mutation_rng());
+	if (!m->decisions.empty()) {
+		int n = 1 + mutation_rng() % HAVOC_BYTES;
+		for (int i = 0; i < n; ++i)
+			m->decisions[mutation_rng() % m->decisions.size()] = mutation_rng();
+	}
+	*out_buf = m->decisions.data();
+	return m->decisions.size();
+}
+
+extern "C" void *afl_custom_init(void *afl, unsigned int seed) {
+	seed_mutations(seed);
+	// Trimmed queue entries may lack decisions at the end
+	ff_set_decision_tail(FF_TAIL_RANDOM);
+	return new afl_mutator;
+}
+
+extern "C" void afl_custom_deinit(void *data) {
+	delete (afl_mutator *) data;
+}
+
+extern "C" uint8_t afl_custom_queue_new_entry(void *data, const uint8_t *filename_new_queue, const uint8_t *filename_orig_queue) {
+	add_queue_entry((afl_mutator *) data, (const char *) filename_new_queue);
+	return 0;
+}
+
+extern "C" uint8_t afl_custom_queue_get(void *data, const uint8_t *filename) {
+	afl_mutator *m = (afl_mutator *) data;
+	m->current = add_queue_entry(m, (const char *) filename);
+	return 1;
+}
+
+extern "C" size_t afl_custom_fuzz(void *data, uint8_t *buf, size_t buf_size, uint8_t **out_buf, uint8_t *add_buf, size_t add_buf_size, size_t max_size) {
+	afl_mutator *m = (afl_mutator *) data;
+	if (m->current == -1) {
+		// Parse the input once; a failure is remembered, too
+		uint64_t hash = hash_data(buf, buf_size);
+		auto it = m->data_indices.find(hash);
+		if (it == m->data_indices.end())
+			it = m->data_indices.emplace(hash, process_data(buf, buf_size)).first;
+		m->current = it->second;
+	}
+	if (m->current == -1)
+		return havoc(m, buf, buf_size, out_buf, max_size);
+
+	for (int i = 0; i < MUTATION_TRIES; ++i) {
+		unsigned char *file = NULL;
+		unsigned file_size = 0;
+		one_smart_mutation(m->current, &file, &file_size);
+		if (!file || !file_size)
+			continue;
+		m->decisions.resize(consumedRand());
+		copy_rand(m->decisions.data());
+		*out_buf = m->decisions.data();
+		return std::min(m->decisions.size(), max_size);
+	}
+	return havoc(m, buf, buf_size, out_buf, max_size);
+}
+
+extern "C" size_t afl_custom_post_process(void *data, uint8_t *buf, size_t buf_size, uint8_t **out_buf) {
+	unsigned char *file = NULL;
+	set_generator();
+	get_parse_tree = false;
+	size_t file_size = ff_generate(buf, buf_size, &file);
+	*out_buf = file;
+	return file ? file_size : 0;
+}
@@ -65,21 +65,6 @@ typedef float HFLOAT;
 typedef unsigned long long OLETIME;
 typedef long time_t;
 
-const int CHECKSUM_BYTE = 0;
-const int CHECKSUM_SHORT_LE = 1;
-const int CHECKSUM_SHORT_BE = 2;
-const int CHECKSUM_INT_LE = 3;
-const int CHECKSUM_INT_BE = 4;
-const int CHECKSUM_INT64_LE = 5;
-const int CHECKSUM_INT64_BE = 6;
-const int CHECKSUM_SUM8 = 7;
-const int CHECKSUM_SUM16 = 8;
-const int CHECKSUM_SUM32 = 9;
-const int CHECKSUM_SUM64 = 10;
-const int CHECKSUM_CRC16 = 11;
-const int CHECKSUM_CRCCCITT = 12;
-const int CHECKSUM_CRC32 = 13;
-const int CHECKSUM_ADLER32 = 14;
 const int FINDMETHOD_NORMAL = 0;
 const int FINDMETHOD_WILDCARDS = 1;
 const int FINDMETHOD_REGEX = 2;
@@ -113,27 +98,27 @@ const int TRUE = 1;
 const int False = 0;
 const int FALSE = 0;
 
-#define GENERATE_VAR(name, index, value) do { \
-	start_generation(#name, index);       \
+#define GENERATE_VAR(name, index, field, value) do { \
+	start_generation(#name, index, field); \
 	name ## _var = (value);        \
 	name ## _exists = true;        \
 	end_generation();              \
 	} while (0)
 
-#define GENERATE(name, index, value) do {     \
-	start_generation(#name, index);       \
+#define GENERATE(name, index, field, value) do { \
+	start_generation(#name, index, field); \
 	(value);                       \
 	end_generation();              \
 	} while (0)
 
-#define GENERATE_EXISTS(name, index, value)   \
+#define GENERATE_EXISTS(name, index, field, value) \
 	name ## _exists = true
 
 
-unsigned long long STR2INT(std::string s) {
+unsigned long long STR2INT(const std::string& s) {
 	assert(s.size() <= 8);
 	unsigned long long result = 0;
-	for (char& c : s) {
+	for (const char& c : s) {
 		result = (result << 8) | c;
 	}
 	return result;
@@ -151,12 +136,81 @@ constexpr unsigned long long STR2INT(const char * s) {
 	return result;
 }
 
-extern unsigned char *rand_buffer;
-file_accessor file_acc;
+// Switch key for a string compared against literals of exactly len
+// characters: STR2INT(s) when the length matches, otherwise a value no
+// literal of up to 8 printable characters can produce.
+inline unsigned long long STR2KEY(const std::string& s, size_t len) {
+	if (s.size() != len)
+		return ~0ULL;
+	unsigned long long result = 0;
+	for (unsigned char c : s)
+		result = (result << 8) | c;
+	return result;
+}
 
-extern bool is_big_endian;
-extern bool is_padded_bitfield;
-void generate_file();
+extern thread_local unsigned char *rand_buffer;
+thread_local file_accessor file_acc;
+
+// Bump allocator for the globals object and the struct instances created
+// while generating one file.  delete_globals() runs their destructors and
+// then releases all memory at once with reset(); the blocks are kept and
+// reused for the next file.
+class generation_arena {
+	std::vector<std::pair<char*, size_t>> blocks;
+	size_t block = 0;
+	size_t used = 0;
+public:
+	void* allocate(size_t size, size_t align) {
+		while (true) {
+			if (block < blocks.size()) {
+				size_t start = (used + align - 1) & ~(align - 1);
+				if (start + size <= blocks[block].second) {
+					used = start + size;
+					return blocks[block].first + start;
+				}
+				++block;
+				used = 0;
+			} else {
+				size_t capacity = blocks.empty() ? 65536 : 2 * blocks.back().second;
+				while (capacity < size + align)
+					capacity *= 2;
+				blocks.emplace_back((char*) ::operator new(capacity), capacity);
+			}
+		}
+	}
+	void reset() {
+		block = 0;
+		used = 0;
+	}
+	~generation_arena() {
+		for (auto& b : blocks)
+			::operator delete(b.first);
+	}
+};
+thread_local generation_arena instance_arena;
+
+template<typename T, typename... Args>
+T* arena_new(Args&&... args) {
+	return new (instance_arena.allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+}
+
+template<typename T>
+void arena_delete(T* p) {
+	p->~T();
+}
+
+extern thread_local bool is_big_endian;
+extern thread_local bool is_padded_bitfield;
+template<bool Generate> void generate_file();
+
+// Run the template in the mode set by set_generator() or set_parser();
+// everything below generate_file<Generate>() is instantiated per mode
+void generate_file() {
+	if (file_acc.generate)
+		generate_file<true>();
+	else
+		generate_file<false>();
+}
 
 bool aflsmart_output = false;
 
@@ -164,23 +218,23 @@ double get_validity() {
 	return (double)file_acc.parsed_file_size / (double)file_acc.final_file_size;
 }
 
-std::vector<std::vector<int>> found_paths;
-extern std::vector<int> k_path_stack;
-extern unsigned int position;
-extern bool found_path;
-extern std::vector<int> to_cover;
-extern std::vector<int> chosen;
-extern int path_pos;
-bool is_k_paths = false;
-extern std::vector<std::pair<std::vector<int>, bool>> k_paths;
-extern unsigned int previous_gen_pos;
-extern int tries;
-extern bool FF_test;
-extern std::set<std::vector<int>> cov_IDs;
-extern long unsigned int test_k;
-
-
-void start_generation(const char* name, unsigned index) {
+thread_local std::vector<std::vector<int>> found_paths;
+extern thread_local std::vector<int> k_path_stack;
+extern thread_local unsigned int position;
+extern thread_local bool found_path;
+extern thread_local std::vector<int> to_cover;
+extern thread_local std::vector<int> chosen;
+extern thread_local int path_pos;
+thread_local bool is_k_paths = false;
+extern thread_local std::vector<std::pair<std::vector<int>, bool>> k_paths;
+extern thread_local unsigned int previous_gen_pos;
+extern thread_local int tries;
+extern thread_local bool FF_test;
+extern thread_local std::set<std::vector<int>> cov_IDs;
+extern thread_local long unsigned int test_k;
+
+
+void start_generation(const char* name, unsigned index, unsigned field) {
 	if (is_k_paths){
 		bool on_path;
 		unsigned int k = chosen.size();
@@ -240,12 +294,20 @@ void start_generation(const char* name, unsigned index) {
 	}
 	if (!get_parse_tree)
 		return;
-	generator_stack.emplace_back(name, file_acc.rand_prev, file_acc.rand_pos, index);
+	generator_stack.emplace_back(name, field, file_acc.rand_prev, file_acc.rand_pos, index);
+	if (debug_print || parse_tree.enabled) {
+		size_t row = (generator_stack.size() - 1) * field_count;
+		if (child_counts.size() < row + field_count)
+			child_counts.resize(row + field_count);
+		std::fill(child_counts.begin() + row, child_counts.begin() + row + field_count, 0);
+		if (parse_tree.enabled)
+			parse_tree.open(generator_stack.back(), generator_stack[generator_stack.size() - 2], child_counts[row - field_count + field]);
+	}
 	file_acc.rand_prev = file_acc.rand_pos;
 	file_acc.rand_last = UINT_MAX;
 }
 
-const char* mutated = "";
+thread_local const char* mutated = "";
 void end_generation() {
 	if (is_k_paths || FF_test)
 		k_path_stack.pop_back();
@@ -262,9 +324,9 @@ void end_generation() {
 	}
 	
 	if (smart_mutation && back.rand_start == rand_start && (is_optional || strcmp(back.name, chunk_name) == 0)) {
-		unsigned size = MAX_RAND_SIZE - file_acc.rand_pos;
-		if (size > MAX_RAND_SIZE - (rand_end + 1))
-			size = MAX_RAND_SIZE - (rand_end + 1);
+		unsigned size = file_acc.rand_size - file_acc.rand_pos;
+		if (size > file_acc.rand_size - (rand_end + 1))
+			size = file_acc.rand_size - (rand_end + 1);
 		memmove(file_acc.rand_buffer + file_acc.rand_pos, file_acc.rand_buffer + (rand_end + 1), size);
 		if (smart_swapping) {
 			if (rand_start2 > rand_end)
@@ -274,15 +336,15 @@ void end_generation() {
 		rand_end = file_acc.rand_pos - 1;
 	}
 	if (smart_swapping && back.rand_start == rand_start2 && (is_optional || strcmp(back.name, chunk_name2) == 0)) {
-		unsigned size = MAX_RAND_SIZE - file_acc.rand_pos;
-		if (size > MAX_RAND_SIZE - (rand_end2 + 1))
-			size = MAX_RAND_SIZE - (rand_end2 + 1);
+		unsigned size = file_acc.rand_size - file_acc.rand_pos;
+		if (size > file_acc.rand_size - (rand_end2 + 1))
+			size = file_acc.rand_size - (rand_end2 + 1);
 		memmove(file_acc.rand_buffer + file_acc.rand_pos, file_acc.rand_buffer + (rand_end2 + 1), size);
 		rand_end2 = file_acc.rand_pos - 1;
 	}
 	if (smart_abstraction && back.rand_start == rand_start && (is_optional || strcmp(back.name, chunk_name) == 0)) {
-		if (following_rand_size > MAX_RAND_SIZE - file_acc.rand_pos)
-			following_rand_size = MAX_RAND_SIZE - file_acc.rand_pos;
+		if (following_rand_size > file_acc.rand_size - file_acc.rand_pos)
+			following_rand_size = file_acc.rand_size - file_acc.rand_pos;
 		memcpy(file_acc.rand_buffer + file_acc.rand_pos, following_rand_buffer, following_rand_size);
 		smart_abstraction = false;
 	}
@@ -296,21 +358,18 @@ void end_generation() {
 		back.min = file_acc.file_pos;
 		back.max = file_acc.file_pos - 1;
 	}
+	if (parse_tree.enabled)
+		parse_tree.close(back, file_acc.rand_pos - 1, file_acc.rand_last != UINT_MAX ? FF_TREE_APPENDABLE : 0);
 	if (debug_print && back.min <= back.max) {
 		printf("%u,%u, ", back.rand_start, file_acc.rand_pos - 1);
 		printf("%u,%u,", back.min, back.max);
-		bool first = true;
-		stack_cell* parent = NULL;
-		for (auto& cell : generator_stack) {
-			if (first) {
-				printf("%s", cell.name);
-				first = false;
-			} else {
-				printf("~%s", cell.name);
-				if (parent->counts[cell.name])
-					printf("_%u", parent->counts[cell.name]);
-			}
-			parent = &cell;
+		printf("%s", generator_stack[0].name);
+		for (size_t level = 1; level < generator_stack.size(); ++level) {
+			stack_cell& cell = generator_stack[level];
+			printf("~%s", cell.name);
+			unsigned count = child_counts[(level - 1) * field_count + cell.field];
+			if (count)
+				printf("_%u", count);
 		}
 		if (aflsmart_output) {
 			printf(",Enabled\n");
@@ -349,34 +408,25 @@ void end_generation() {
 	
 	if (get_all_chunks) {
 		if (back.rand_start != back.rand_start_real) {
-			optional_chunks.emplace_back(file_index, back.rand_start, file_acc.rand_pos - 1, variable_types[back.name].c_str(), back.name);
-			insertion_points[file_index].emplace_back(back.rand_start, variable_types[back.name].c_str(), back.name);
+			found_chunks.optional_chunks.emplace_back(file_index, back.rand_start, file_acc.rand_pos - 1, field_types[back.field], back.name);
+			found_chunks.insertion_points.emplace_back(back.rand_start, field_types[back.field], back.name);
 			is_following = true;
 			chunk_name = back.name;
+			chunk_type = field_types[back.field];
 			rand_start = back.rand_start;
 			rand_end = file_acc.rand_pos - 1;
 		} else if (file_acc.rand_pos > back.rand_start) {
-			int size = non_optional_index[file_index].size();
-			int i;
-			for (i = 0; i < size; ++i) {
-				if (strcmp(non_optional_index[file_index][i].type, variable_types[back.name].c_str()) == 0) {
-					++non_optional_index[file_index][i].size;
-					break;
-				}
-			}
-			if (i == size) {
-				non_optional_index[file_index].emplace_back(variable_types[back.name].c_str(), non_optional_chunks[variable_types[back.name]].size(), 1);
-			}
-			non_optional_chunks[variable_types[back.name]].emplace_back(file_index, back.rand_start, file_acc.rand_pos - 1, variable_types[back.name].c_str(), back.name);
+			found_chunks.non_optional_chunks.emplace_back(file_index, back.rand_start, file_acc.rand_pos - 1, field_types[back.field], back.name);
 		}
 		if (file_acc.rand_last != UINT_MAX) {
-			insertion_points[file_index].emplace_back(file_acc.rand_last, variable_types[back.name].c_str(), back.name);
+			found_chunks.insertion_points.emplace_back(file_acc.rand_last, field_types[back.field], back.name);
 		}
 	}
 
 	file_acc.rand_last = UINT_MAX;
 
-	++prev.counts[back.name];
+	if (debug_print || parse_tree.enabled)
+		++child_counts[(generator_stack.size() - 2) * field_count + back.field];
 	generator_stack.pop_back();
 }
 
@@ -413,27 +463,30 @@ bool setup_input(const char* filename) {
 	}
     
     if (file_fd == STDIN_FILENO) {
-        // Read from stdin, up to MAX_RAND_SIZE
-        unsigned char *p = rand_buffer;
+        // Read from stdin, growing the buffer up to max_rand_size
 		ssize_t size;
-		ssize_t chars_left = MAX_RAND_SIZE;
+		ssize_t total = 0;
         
-        while (chars_left > 0 && 
-               (size = read(file_fd, p, chars_left)) > 0)
+        while ((size = read(file_fd, rand_buffer + total, file_acc.rand_capacity - total)) > 0)
         {
-            p += size;
-            chars_left -= size;
+            total += size;
+            if (total == file_acc.rand_capacity)
+            {
+                if (file_acc.rand_capacity == file_acc.max_rand_size)
+                {
+                    perror("Standard input size exceeds max_rand_size");
+                    exit(1);
+                }
+                file_acc.grow_rand(total + 1);
+            }
         }
-        if (chars_left == 0)
-        {
-			perror("Standard input size exceeds MAX_RAND_SIZE");
-			exit(1);
-        }
-        ssize_t total = p - rand_buffer;
-		file_acc.seed(rand_buffer, MAX_RAND_SIZE, total);
+		file_acc.seed(rand_buffer, file_acc.rand_capacity, total);
     }
 	if (file_acc.generate) {
-		ssize_t size = read(file_fd, rand_buffer, MAX_RAND_SIZE);
+		struct stat st;
+		if (fstat(file_fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > file_acc.rand_capacity)
+			file_acc.grow_rand(std::min((unsigned long long) st.st_size, (unsigned long long) file_acc.max_rand_size));
+		ssize_t size = read(file_fd, rand_buffer, file_acc.rand_capacity);
 		if (size < 0) {
 			perror("Failed to read seed file");
 			exit(1);
@@ -447,17 +500,18 @@ bool setup_input(const char* filename) {
 			exit(1);
 		}
 		ssize_t file_size = st.st_size;
-		if (file_size > MAX_FILE_SIZE) {
-			fprintf(stderr, "File size exceeds MAX_FILE_SIZE\n");
-			file_size = MAX_FILE_SIZE;
+		if (file_size > file_acc.max_file_size) {
+			fprintf(stderr, "File size exceeds max_file_size\n");
+			file_size = file_acc.max_file_size;
 			success = false;
 		}
+		file_acc.reserve_file(file_size);
 		ssize_t size = read(file_fd, file_acc.file_buffer, file_size);
 		if (size != file_size) {
 			perror("Failed to read input file");
 			exit(1);
 		}
-		file_acc.seed(rand_buffer, MAX_RAND_SIZE, file_size);
+		file_acc.seed(rand_buffer, file_acc.rand_capacity, file_size);
 	}
     
 	if (file_fd != STDIN_FILENO)
@@ -465,6 +519,12 @@ bool setup_input(const char* filename) {
 	return success;
 }
 
+// Take the decisions for the next generation from the given seed
+void setup_random(uint64_t seed) {
+	debug_print = false;
+	file_acc.seed_random(seed);
+}
+
 void save_output(const char* filename) {
 	int file_fd;
 	if (strcmp(filename, "-") == 0)
@@ -490,6 +550,25 @@ void save_output(const char* filename) {
         close(file_fd);
 }
 
+// Save the parse tree of the last file (see ff_record_parse_tree())
+void save_parse_tree(const char* filename) {
+	const unsigned char* tree;
+	size_t size = ff_parse_tree(&tree);
+	int file_fd;
+	if (strcmp(filename, "-") == 0)
+		file_fd = STDOUT_FILENO;
+	else
+		file_fd = open(filename, O_CREAT | O_WRONLY | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH);
+	if (file_fd == -1) {
+		perror(filename);
+		exit(1);
+	}
+	if (write(file_fd, tree, size) != (ssize_t) size)
+		fprintf(stderr, "Failed to write file\n");
+	if (file_fd != STDOUT_FILENO)
+		close(file_fd);
+}
+
 unsigned copy_rand(unsigned char *dest) {
 	memcpy(dest, file_acc.rand_buffer, file_acc.rand_pos);
 	return file_acc.rand_pos;
@@ -497,10 +576,11 @@ unsigned copy_rand(unsigned char *dest) {
 
 void delete_globals();
 
-extern "C" size_t ff_generate(unsigned char* data, size_t size, unsigned char** new_data) {
-	file_acc.seed(data, size, 0);
+// Generate a file from the decisions set up by file_acc.seed() or
+// file_acc.seed_random()
+static size_t generate_seeded(unsigned char** new_data) {
 	try {
-		generate_file();
+		generate_file<true>();
 	} catch (int status) {
 		delete_globals();
 		if (status) {
@@ -516,21 +596,44 @@ extern "C" size_t ff_generate(unsigned char* data, size_t size, unsigned char**
 	return file_acc.file_size;
 }
 
+extern "C" size_t ff_generate(unsigned char* data, size_t size, unsigned char** new_data) {
+	file_acc.seed(data, size, 0);
+	return generate_seeded(new_data);
+}
+
+// ff_generate_seed - generate a file from random decisions drawn from
+// seed, with no decision buffer to fill up front.  The same seed always
+// yields the same file; copy_rand() returns the decisions taken.
+extern "C" size_t ff_generate_seed(uint64_t seed, unsigned char** new_data) {
+	file_acc.seed_random(seed);
+	return generate_seeded(new_data);
+}
+
 extern "C" int ff_parse(unsigned char* data, size_t size, unsigned char** new_data, size_t* new_size) {
 	file_acc.generate = false;
 
-	if (size > MAX_FILE_SIZE) {
-		fprintf(stderr, "File size larger than MAX_FILE_SIZE\n");
-		size = MAX_FILE_SIZE;
+	// Keep room for a zero byte after the file
+	if (size >= file_acc.max_file_size) {
+		fprintf(stderr, "File size larger than max_file_size\n");
+		size = file_acc.max_file_size - 1;
 	}
+	file_acc.reserve_file(size + 1);
 	if (data != file_acc.file_buffer) {
 		memcpy(file_acc.file_buffer, data, size);
 	}
-	memset(file_acc.file_buffer + size, 0, MAX_FILE_SIZE - size);
-	file_acc.seed(rand_buffer, MAX_RAND_SIZE, size);
+	// Lookahead may read past the end of the file, where only zeros must
+	// be found: clear what earlier files left there.  The byte after the
+	// file is always cleared, so that strlen() and the like stop there
+	// even if the file fills the buffer.
+	unsigned used = std::min(file_acc.file_capacity, std::max(file_acc.file_used, std::max(file_acc.file_size, file_acc.final_file_size)));
+	if (used > size + 1)
+		memset(file_acc.file_buffer + size + 1, 0, used - size - 1);
+	file_acc.file_buffer[size] = 0;
+	file_acc.seed(rand_buffer, file_acc.rand_capacity, size);
+	file_acc.file_used = size;
 	bool success = true;
 	try {
-		generate_file();
+		generate_file<false>();
 	} catch (int status) {
 		delete_globals();
 		if (status)
@@ -545,6 +648,94 @@ extern "C" int ff_parse(unsigned char* data, size_t size, unsigned char** new_da
 	return success;
 }
 
+// Record a binary parse tree (see formatfuzzer.h) of every file this
+// thread generates or parses from the next one on, or stop doing so.
+extern "C" void ff_record_parse_tree(int enable) {
+	parse_tree.enabled = enable;
+	if (enable) {
+		get_parse_tree = true;
+		parse_tree.reset();
+	}
+}
+
+// ff_parse_tree - point *tree to the parse tree image of the last file
+// generated or parsed in this thread and return its size, or 0 if no
+// tree is being recorded.  The image is valid until the next call.  If
+// the generation failed, the chunks it was in are marked incomplete.
+extern "C" size_t ff_parse_tree(const unsigned char** tree) {
+	if (!parse_tree.enabled) {
+		*tree = NULL;
+		return 0;
+	}
+	const std::vector<unsigned char>& bytes = parse_tree.image(generator_stack, file_acc.rand_pos, file_acc.file_pos, file_acc.file_size);
+	*tree = bytes.data();
+	return bytes.size();
+}
+
+// ff_tree_check - return the number of nodes of the parse tree image of
+// size bytes at tree (say, mapped in from a file), or 0 if it is not a
+// well-formed image.  The other ff_tree_* functions expect a checked one.
+extern "C" uint32_t ff_tree_check(const unsigned char* tree, size_t size) {
+	ff_tree_header header;
+	if (size < sizeof(header))
+		return 0;
+	memcpy(&header, tree, sizeof(header));
+	if (header.magic != FF_TREE_MAGIC || header.version != FF_TREE_VERSION || header.node_count == 0)
+		return 0;
+	if (header.node_offset % alignof(ff_tree_node) || header.node_offset > size
+		|| header.node_count > (size - header.node_offset) / sizeof(ff_tree_node))
+		return 0;
+	if (header.string_offset > size || header.string_size > size - header.string_offset
+		|| header.string_size == 0 || tree[header.string_offset + header.string_size - 1] != '\0')
+		return 0;
+	const ff_tree_node* nodes = (const ff_tree_node*) (tree + header.node_offset);
+	for (uint32_t i = 0; i < header.node_count; ++i) {
+		const ff_tree_node& node = nodes[i];
+		if (i == 0 ? node.parent != FF_TREE_NONE || node.end != header.node_count
+			: node.parent >= i || node.end <= i || node.end > nodes[node.parent].end)
+			return 0;
+		if (node.name >= header.string_size || node.type >= header.string_size)
+			return 0;
+	}
+	return header.node_count;
+}
+
+extern "C" const ff_tree_node* ff_tree_node_at(const unsigned char* tree, uint32_t index) {
+	const ff_tree_header* header = (const ff_tree_header*) tree;
+	if (index >= header->node_count)
+		return NULL;
+	return (const ff_tree_node*) (tree + header->node_offset) + index;
+}
+
+extern "C" const char* ff_tree_string(const unsigned char* tree, uint32_t offset) {
+	const ff_tree_header* header = (const ff_tree_header*) tree;
+	return (const char*) tree + header->string_offset + offset;
+}
+
+// First child and next sibling of node index, or FF_TREE_NONE
+extern "C" uint32_t ff_tree_first_child(const unsigned char* tree, uint32_t index) {
+	const ff_tree_node* node = ff_tree_node_at(tree, index);
+	return index + 1 < node->end ? index + 1 : FF_TREE_NONE;
+}
+
+extern "C" uint32_t ff_tree_next_sibling(const unsigned char* tree, uint32_t index) {
+	const ff_tree_node* node = ff_tree_node_at(tree, index);
+	if (node->parent == FF_TREE_NONE)
+		return FF_TREE_NONE;
+	return node->end < ff_tree_node_at(tree, node->parent)->end ? node->end : FF_TREE_NONE;
+}
+
+// Set what generation in this thread does when it runs out of decisions
+// (FF_TAIL_FAIL or FF_TAIL_RANDOM).  With FF_TAIL_RANDOM, callers can
+// pass short or truncated decision buffers to ff_generate() as they are.
+extern "C" void ff_set_decision_tail(int mode) {
+	file_acc.decision_tail = mode;
+}
+
+extern "C" void ff_use_buffers(unsigned char* file, size_t file_limit, unsigned char* rand, size_t rand_limit) {
+	file_acc.use_buffers(file, file_limit, rand, rand_limit);
+}
+
 void exit_template(int status) {
 	if (debug_print || print_errors)
 		fprintf(stderr, "Template exited with code %d\n", status);
@@ -557,16 +748,17 @@ void exit_template(std::string message) {
 	throw -1;
 }
 
-bool change_array_length = false;
+thread_local bool change_array_length = false;
 
+template<bool Generate>
 void check_array_length(unsigned& size) {
-	if (change_array_length && size > MAX_FILE_SIZE/16 && file_acc.generate) {
-		unsigned new_size = file_acc.rand_int(16, file_acc.parse);
+	if (Generate && change_array_length && size > MAX_FILE_SIZE/16) {
+		unsigned new_size = file_acc.rand_int<Generate>(16, file_acc.parse);
 		if (debug_print)
 			fprintf(stderr, "Array length too large: %d, replaced with %u\n", (signed)size, new_size);
 		size = new_size;
 	}
-	assert_cond(size <= MAX_FILE_SIZE - file_acc.file_pos, "Array length too large");
+	assert_cond(size <= file_acc.max_file_size - file_acc.file_pos, "Array length too large");
 }
 
 void ChangeArrayLength() {
@@ -604,15 +796,42 @@ int SetEvilBit(int allow) {
 	return file_acc.set_evil_bit(allow);
 }
 
-uint32 Checksum(int checksum_type, int64 start, int64 size) {
-	assert_cond(start + size <= file_acc.file_size, "checksum range invalid");
-	switch(checksum_type) {
-	case CHECKSUM_CRC32: {
-		return crc32(0, file_acc.file_buffer + start, size);
-	}
-	default:
-		abort();
-	}
+int64 Checksum(int checksum_type, int64 start = 0, int64 size = 0) {
+	if (size == 0)
+		size = file_acc.file_size - start;
+	assert_cond(start >= 0 && size >= 0 && start + size <= file_acc.file_size, "checksum range invalid");
+	assert_cond(checksum_type >= 0 && checksum_type < CHECKSUM_TYPES, "unknown checksum type");
+	return ff_checksum(checksum_type, file_acc.file_buffer + start, size);
+}
+
+// ChecksumStart - start a checksum of the given type over the file bytes
+// from the current position on.  The checksum is updated as the bytes are
+// written, so ChecksumEnd() does not scan them again.
+int ChecksumStart(int checksum_type) {
+	assert_cond(checksum_type >= 0 && checksum_type < CHECKSUM_TYPES, "unknown checksum type");
+	unsigned pos = file_acc.file_pos;
+	file_acc.checksum_ranges.push_back({checksum_type, pos, pos, ff_checksum_init(checksum_type), false, true});
+	return file_acc.checksum_ranges.size() - 1;
+}
+
+// ChecksumEnd - return the checksum started by ChecksumStart() over the
+// bytes up to the current position, and stop updating it.
+int64 ChecksumEnd(int id) {
+	auto& ranges = file_acc.checksum_ranges;
+	assert_cond(id >= 0 && (unsigned) id < ranges.size() && ranges[id].active, "invalid checksum");
+	checksum_range& r = ranges[id];
+	int type = r.type;
+	unsigned end = file_acc.file_pos;
+	assert_cond(r.start <= end, "checksum range invalid");
+	uint64 state;
+	if (r.dirty || end < r.done)
+		state = ff_checksum_update(type, ff_checksum_init(type), file_acc.file_buffer + r.start, end - r.start);
+	else
+		state = ff_checksum_update(type, r.state, file_acc.file_buffer + r.done, end - r.done);
+	r.active = false;
+	while (!ranges.empty() && !ranges.back().active)
+		ranges.pop_back();
+	return ff_checksum_final(type, state);
 }
 
 void Warning(const std::string fmt, ...) {
@@ -644,18 +863,18 @@ void SPrintf(std::string& s, const char* fmt, ...) {
 	s = res;
 }
 
-std::string::size_type Strlen(std::string s) { return s.size(); }
+std::string::size_type Strlen(const std::string& s) { return s.size(); }
 
-int Strcmp(std::string s1, std::string s2) {
+int Strcmp(const std::string& s1, const std::string& s2) {
 	return strcmp(s1.c_str(), s2.c_str());
 }
 
-int Strncmp(std::string s1, std::string s2, int n) {
+int Strncmp(const std::string& s1, const std::string& s2, int n) {
 	assert ((unsigned) n <= s1.length() && (unsigned) n <= s2.length());
 	return strncmp(s1.c_str(), s2.c_str(), n);
 }
 
-std::string SubStr(std::string s, int start, int count = -1) {
+std::string SubStr(const std::string& s, int start, int count = -1) {
 	size_t len = s.length();
 	assert_cond((unsigned)start < len, "SubStr: invalid position");
 	if (count == -1)
@@ -664,28 +883,31 @@ std::string SubStr(std::string s, int start, int count = -1) {
 	return std::string(s.c_str() + start, count);
 }
 
-int Memcmp(std::string s1, std::string s2, int n) {
+int Memcmp(const std::string& s1, const std::string& s2, int n) {
 	assert ((unsigned) n <= s1.length() && (unsigned) n <= s2.length());
 	return memcmp(s1.c_str(), s2.c_str(), n);
 }
 
-void Memcpy(std::string& dest, std::string src, int n, int destOffset = 0, int srcOffset = 0) {
+void Memcpy(std::string& dest, const std::string& src, int n, int destOffset = 0, int srcOffset = 0) {
 	// Other configurations not yet handled
 	assert(destOffset == 0 && srcOffset == 0);
 	assert ((unsigned) n <= src.length());
 	dest = std::string(src.c_str(), n);
 }
 
+template<bool Generate>
 int IsParsing() {
-	return !file_acc.generate;
+	return !Generate;
 }
 
-int FEof(double p = 0.125) { return file_acc.feof(p); }
+template<bool Generate>
+int FEof(double p = 0.125) { return file_acc.feof<Generate>(p); }
 
 int64 FTell() { return file_acc.file_pos; }
 
+template<bool Generate>
 int FSeek(int64 pos, bool print = true) {
-	assert_cond(0 <= pos && pos <= MAX_FILE_SIZE, "FSeek/FSkip: invalid position");
+	assert_cond(0 <= pos && pos <= file_acc.max_file_size, "FSeek/FSkip: invalid position");
 	if (print && debug_print && file_acc.file_pos != pos)
 		fprintf(stderr, "FSeek from %u to %lld\n", file_acc.file_pos, pos);
 	if (pos > file_acc.file_size) {
@@ -694,7 +916,7 @@ int FSeek(int64 pos, bool print = true) {
 		file_acc.file_pos = file_acc.file_size;
 		file_acc.is_padding = true;
 		while (file_acc.file_pos < pos) {
-			file_acc.file_integer(1, 0, 0);
+			file_acc.file_integer<Generate>(1, 0, 0);
 		}
 		file_acc.is_padding = false;
 	} else {
@@ -703,57 +925,54 @@ int FSeek(int64 pos, bool print = true) {
 	return 0;
 }
 
+template<bool Generate>
 int FSkip(int64 offset) {
 	if (debug_print && offset != 0)
 		fprintf(stderr, "FSkip from %u to %lld\n", file_acc.file_pos, file_acc.file_pos + offset);
-	return FSeek(file_acc.file_pos + offset, false);
+	return FSeek<Generate>(file_acc.file_pos + offset, false);
 }
 
+template<bool Generate>
 int64 FileSize() {
 	if (!file_acc.has_size) {
 		file_acc.lookahead = true;
-		if (!file_acc.generate)
-			file_acc.parse = [](unsigned char* file_buf) -> long long { return file_acc.final_file_size - file_acc.file_size; };
-		unsigned new_file_size = file_acc.file_size + file_acc.rand_int(MAX_FILE_SIZE + 1 - file_acc.file_size, file_acc.parse);
+		unsigned new_file_size = file_acc.rand_position<Generate>(file_acc.file_size, 0, [](unsigned char* file_buf) -> long long { return file_acc.final_file_size - file_acc.file_size; });
 		file_acc.lookahead = false;
 		if (debug_print)
 			fprintf(stderr, "FileSize %u\n", new_file_size);
 		int64 original_pos = FTell();
-		FSeek(new_file_size, false);
-		FSeek(original_pos, false);
+		FSeek<Generate>(new_file_size, false);
+		FSeek<Generate>(original_pos, false);
 		file_acc.has_size = true;
 	}
 	return file_acc.file_size;
 }
 
-template<typename T>
+template<bool Generate, typename T>
 int64 FindFirst(T data, int matchcase=true, int wholeword=false, int method=0, double tolerance=0.0, int dir=1, int64 start=0, int64 size=0, int wildcardMatchLength=24) {
 	// Other configurations not yet handled
 	assert(matchcase == true && wholeword == false && method == 0 && tolerance == 0.0 && dir == 1 && size == 0 && wildcardMatchLength == 24);
 	T newdata = data;
 	swap_bytes(&newdata, sizeof(T));
 	file_acc.lookahead = true;
-	if (!file_acc.generate)
-		file_acc.evil_parse = [&start, &newdata](unsigned char* file_buf) -> bool {
-			return memmem(file_acc.file_buffer + start, file_acc.final_file_size - start, &newdata, sizeof(T)) == NULL;
-		};
-	if (file_acc.evil(file_acc.evil_parse)) {
+	auto evil_parse = [&start, &newdata](unsigned char* file_buf) -> bool {
+		return memmem(file_acc.file_buffer + start, file_acc.final_file_size - start, &newdata, sizeof(T)) == NULL;
+	};
+	if (file_acc.evil<Generate>(evil_parse)) {
 		file_acc.lookahead = false;
 		return -1;
 	}
-	if (!file_acc.generate)
-		file_acc.parse = [&start, &newdata](unsigned char* file_buf) -> long long {
-			return (unsigned char *)memmem(file_acc.file_buffer + start, file_acc.final_file_size - start, &newdata, sizeof(T)) - (file_acc.file_buffer + start);
-		};
-	int64 pos = start + file_acc.rand_int(MAX_FILE_SIZE + 1 - sizeof(T) - start, file_acc.parse);
+	auto parse = [&start, &newdata](unsigned char* file_buf) -> long long {
+		return (unsigned char *)memmem(file_acc.file_buffer + start, file_acc.final_file_size - start, &newdata, sizeof(T)) - (file_acc.file_buffer + start);
+	};
+	int64 pos = file_acc.rand_position<Generate>(start, sizeof(T), parse);
 	int64 original_pos = FTell();
-	FSeek(pos);
-	std::vector<T> values = { data };
+	FSeek<Generate>(pos);
 	bool evil = file_acc.set_evil_bit(false);
-	file_acc.file_integer(sizeof(T), 0, values);
+	file_acc.file_integer<Generate>(sizeof(T), 0, value_span<T>({ data }));
 	file_acc.set_evil_bit(evil);
         file_acc.lookahead = false;
-        FSeek(original_pos);
+        FSeek<Generate>(original_pos);
         return pos;
 
 }
@@ -764,24 +983,27 @@ void VectorRemove(std::vector<T>& vec, std::unordered_set<T> set) {
 }
 
 extern std::vector<std::string> ReadBytesInitValues;
+extern known_index<std::string> ReadBytesInitIndex;
 
+template<bool Generate>
 bool ReadBytes(std::string& s, int64 pos, int n) {
 	assert_cond(n > 0, "ReadBytes: invalid number of bytes");
 	int64 original_pos = FTell();
-	FSeek(pos);
+	FSeek<Generate>(pos);
 	file_acc.lookahead = true;
 
 	if (ReadBytesInitValues.size())
-		s = file_acc.file_string(ReadBytesInitValues);
+		s = file_acc.file_string<Generate>(ReadBytesInitValues, ReadBytesInitIndex);
 	else
-		s = file_acc.file_string(n);
+		s = file_acc.file_string<Generate>(n);
 
 	file_acc.lookahead = false;
-	FSeek(original_pos);
+	FSeek<Generate>(original_pos);
 	return true;
 }
 
-bool ReadBytes(std::string& s, int64 pos, int n, std::vector<std::string> preferred_values, std::vector<std::string> possible_values = {}, double p = 0.25) {
+template<bool Generate>
+bool ReadBytes(std::string& s, int64 pos, int n, value_span<std::string> preferred_values, value_span<std::string> possible_values = {}, double p = 0.25) {
 	assert_cond(n > 0, "ReadBytes: invalid number of bytes");
 	int64 original_pos = FTell();
 	file_acc.file_pos = pos;
@@ -789,78 +1011,69 @@ bool ReadBytes(std::string& s, int64 pos, int n, std::vector<std::string> prefer
 
 	int evil = SetEvilBit(false);
 	if (possible_values.size() && ReadBytesInitValues.size()) {
-		if (!file_acc.generate && preferred_values.size()) {
-			file_acc.parse = [&preferred_values, &possible_values, &n](unsigned char* file_buf) -> long long {
-					if (file_acc.file_pos + n > file_acc.final_file_size)
+		auto parse = [&preferred_values, &possible_values, &n](unsigned char* file_buf) -> long long {
+				if (file_acc.file_pos + n > file_acc.final_file_size)
+					return 0;
+				if (preferred_values.size()) {
+					if (std::find(preferred_values.begin(), preferred_values.end(), std::string_view((char*)file_buf, n)) != preferred_values.end())
 						return 0;
-			        	if (std::find(preferred_values.begin(), preferred_values.end(), std::string((char*)file_buf, n)) != preferred_values.end())
-			        		return 0;
-			        	if (std::find(possible_values.begin(), possible_values.end(), std::string((char*)file_buf, n)) != possible_values.end())
-			        		return 253;
-			        	return 255;
-			        };
-		} else if (!file_acc.generate) {
-			file_acc.parse = [&possible_values, &n](unsigned char* file_buf) -> long long {
-					if (file_acc.file_pos + n > file_acc.final_file_size)
-						return 0;
-			        	if (std::find(possible_values.begin(), possible_values.end(), std::string((char*)file_buf, n)) != possible_values.end())
-			        		return 253;
-			        	if (std::find(ReadBytesInitValues.begin(), ReadBytesInitValues.end(), std::string((char*)file_buf, n)) != ReadBytesInitValues.end())
-			        		return 255;
-			        	return 0;
-			        };
-		}
-		int choice = file_acc.rand_int(256, file_acc.parse);
+					if (std::find(possible_values.begin(), possible_values.end(), std::string_view((char*)file_buf, n)) != possible_values.end())
+						return 253;
+					return 255;
+				}
+				if (std::find(possible_values.begin(), possible_values.end(), std::string_view((char*)file_buf, n)) != possible_values.end())
+					return 253;
+				if (ReadBytesInitIndex.find(ReadBytesInitValues, std::string_view((char*)file_buf, n)) != (long long) ReadBytesInitValues.size())
+					return 255;
+				return 0;
+			};
+		int choice = file_acc.rand_int<Generate>(256, parse);
 		if (choice < 255 * p) {
 			if (preferred_values.size())
-				s = file_acc.file_string(preferred_values);
+				s = file_acc.file_string<Generate>(preferred_values);
 			else {
 				s = "";
 			}
 		} else if (choice < 254) {
 			if (preferred_values.size())
 				SetEvilBit(evil);
-			s = file_acc.file_string(possible_values);
+			s = file_acc.file_string<Generate>(possible_values);
 		} else {
 			if (preferred_values.size())
 				SetEvilBit(evil);
-			s = file_acc.file_string(ReadBytesInitValues);
+			s = file_acc.file_string<Generate>(ReadBytesInitValues, ReadBytesInitIndex);
 		}
 	} else if (!possible_values.size() && !ReadBytesInitValues.size()) {
 		if (preferred_values.size()) {
 			SetEvilBit(evil);
-			s = file_acc.file_string(preferred_values);
+			s = file_acc.file_string<Generate>(preferred_values);
 		} else {
 			s = "";
 		}
 	} else {
-		std::vector<std::string>& known_values = possible_values.size() ? possible_values : ReadBytesInitValues;
+		value_span<std::string> known_values = possible_values.size() ? possible_values : value_span<std::string>(ReadBytesInitValues);
+		known_index<std::string> linear;
+		const known_index<std::string>& known_lookup = possible_values.size() ? linear : ReadBytesInitIndex;
 		if (!possible_values.size())
 			p = 0.995;
-		if (!file_acc.generate && preferred_values.size()) {
-			file_acc.parse = [&preferred_values, &n](unsigned char* file_buf) -> long long {
-					if (file_acc.file_pos + n > file_acc.final_file_size)
-						return 0;
-			        	return 255 * (std::find(preferred_values.begin(), preferred_values.end(), std::string((char*)file_buf, n)) == preferred_values.end());
-			        };
-		} else if (!file_acc.generate) {
-			file_acc.parse = [&known_values, &n](unsigned char* file_buf) -> long long {
-					if (file_acc.file_pos + n > file_acc.final_file_size)
-						return 0;
-			        	return 255 * (std::find(known_values.begin(), known_values.end(), std::string((char*)file_buf, n)) != known_values.end());
-			        };
-		}
-		int choice = file_acc.rand_int(256, file_acc.parse);
+		auto parse = [&preferred_values, &known_values, &known_lookup, &n](unsigned char* file_buf) -> long long {
+				if (file_acc.file_pos + n > file_acc.final_file_size)
+					return 0;
+				if (preferred_values.size())
+					return 255 * (std::find(preferred_values.begin(), preferred_values.end(), std::string_view((char*)file_buf, n)) == preferred_values.end());
+				return 255 * (known_lookup.find(known_values, std::string_view((char*)file_buf, n)) != (long long) known_values.size());
+			};
+		int choice = file_acc.rand_int<Generate>(256, parse);
 		if (choice < 255 * p) {
 			if (preferred_values.size())
-				s = file_acc.file_string(preferred_values);
+				s = file_acc.file_string<Generate>(preferred_values);
 			else {
 				s = "";
 			}
 		} else {
 			if (preferred_values.size())
 				SetEvilBit(evil);
-			s = file_acc.file_string(known_values);
+			s = file_acc.file_string<Generate>(known_values, known_lookup);
 		}
 	}
 	SetEvilBit(evil);
@@ -871,236 +1084,262 @@ bool ReadBytes(std::string& s, int64 pos, int n, std::vector<std::string> prefer
 }
 
 extern std::vector<byte> ReadByteInitValues;
+extern known_index<byte> ReadByteInitIndex;
 
-byte ReadByte(int64 pos = FTell(), std::vector<byte> possible_values = {}) {
+template<bool Generate>
+byte ReadByte(int64 pos = FTell(), value_span<byte> possible_values = {}) {
 	int64 original_pos = FTell();
-	FSeek(pos);
+	FSeek<Generate>(pos);
 	file_acc.lookahead = true;
 	byte value;
 	if (possible_values.size())
-		value = file_acc.file_integer(sizeof(byte), 0, possible_values);
+		value = file_acc.file_integer<Generate>(sizeof(byte), 0, possible_values);
 	else if (ReadByteInitValues.size())
-		value = file_acc.file_integer(sizeof(byte), 0, ReadByteInitValues);
+		value = file_acc.file_integer<Generate>(sizeof(byte), 0, ReadByteInitValues, ReadByteInitIndex);
 	else
-		value = file_acc.file_integer(sizeof(byte), 0);
+		value = file_acc.file_integer<Generate>(sizeof(byte), 0);
 	file_acc.lookahead = false;
-	FSeek(original_pos);
+	FSeek<Generate>(original_pos);
 	return value;
 }
 
 extern std::vector<ubyte> ReadUByteInitValues;
+extern known_index<ubyte> ReadUByteInitIndex;
 
-ubyte ReadUByte(int64 pos = FTell(), std::vector<ubyte> possible_values = {}) {
+template<bool Generate>
+ubyte ReadUByte(int64 pos = FTell(), value_span<ubyte> possible_values = {}) {
 	int64 original_pos = FTell();
-	FSeek(pos);
+	FSeek<Generate>(pos);
 	file_acc.lookahead = true;
 	ubyte value;
 	if (possible_values.size())
-		value = file_acc.file_integer(sizeof(ubyte), 0, possible_values);
+		value = file_acc.file_integer<Generate>(sizeof(ubyte), 0, possible_values);
 	else if (ReadUByteInitValues.size())
-		value = file_acc.file_integer(sizeof(ubyte), 0, ReadUByteInitValues);
+		value = file_acc.file_integer<Generate>(sizeof(ubyte), 0, ReadUByteInitValues, ReadUByteInitIndex);
 	else
-		value = file_acc.file_integer(sizeof(ubyte), 0);
+		value = file_acc.file_integer<Generate>(sizeof(ubyte), 0);
 	file_acc.lookahead = false;
-	FSeek(original_pos);
+	FSeek<Generate>(original_pos);
 	return value;
 }
 
 extern std::vector<short> ReadShortInitValues;
+extern known_index<short> ReadShortInitIndex;
 
-short ReadShort(int64 pos = FTell(), std::vector<short> possible_values = {}) {
+template<bool Generate>
+short ReadShort(int64 pos = FTell(), value_span<short> possible_values = {}) {
 	int64 original_pos = FTell();
-	FSeek(pos);
+	FSeek<Generate>(pos);
 	file_acc.lookahead = true;
 	short value;
 	if (possible_values.size())
-		value = file_acc.file_integer(sizeof(short), 0, possible_values);
+		value = file_acc.file_integer<Generate>(sizeof(short), 0, possible_values);
 	else if (ReadShortInitValues.size())
-		value = file_acc.file_integer(sizeof(double), 0, ReadShortInitValues);
+		value = file_acc.file_integer<Generate>(sizeof(double), 0, ReadShortInitValues, ReadShortInitIndex);
 	else
-		value = file_acc.file_integer(sizeof(short), 0);
+		value = file_acc.file_integer<Generate>(sizeof(short), 0);
 	file_acc.lookahead = false;
-	FSeek(original_pos);
+	FSeek<Generate>(original_pos);
 	return value;
 }
 
 extern std::vector<ushort> ReadUShortInitValues;
+extern known_index<ushort> ReadUShortInitIndex;
 
-ushort ReadUShort(int64 pos = FTell(), std::vector<ushort> possible_values = {}) {
+template<bool Generate>
+ushort ReadUShort(int64 pos = FTell(), value_span<ushort> possible_values = {}) {
 	int64 original_pos = FTell();
-	FSeek(pos);
+	FSeek<Generate>(pos);
 	file_acc.lookahead = true;
 	ushort value;
 	if (possible_values.size())
-		value = file_acc.file_integer(sizeof(ushort), 0, possible_values);
+		value = file_acc.file_integer<Generate>(sizeof(ushort), 0, possible_values);
 	else if (ReadUShortInitValues.size())
-		value = file_acc.file_integer(sizeof(ushort), 0, ReadUShortInitValues);
+		value = file_acc.file_integer<Generate>(sizeof(ushort), 0, ReadUShortInitValues, ReadUShortInitIndex);
 	else
-		value = file_acc.file_integer(sizeof(ushort), 0);
+		value = file_acc.file_integer<Generate>(sizeof(ushort), 0);
 	file_acc.lookahead = false;
-	FSeek(original_pos);
+	FSeek<Generate>(original_pos);
 	return value;
 }
 
 extern std::vector<int> ReadIntInitValues;
+extern known_index<int> ReadIntInitIndex;
 
-int ReadInt(int64 pos = FTell(), std::vector<int> possible_values = {}) {
+template<bool Generate>
+int ReadInt(int64 pos = FTell(), value_span<int> possible_values = {}) {
 	int64 original_pos = FTell();
-	FSeek(pos);
+	FSeek<Generate>(pos);
 	file_acc.lookahead = true;
 	int value;
 	if (possible_values.size())
-		value = file_acc.file_integer(sizeof(int), 0, possible_values);
+		value = file_acc.file_integer<Generate>(sizeof(int), 0, possible_values);
 	else if (ReadIntInitValues.size())
-		value = file_acc.file_integer(sizeof(int), 0, ReadIntInitValues);
+		value = file_acc.file_integer<Generate>(sizeof(int), 0, ReadIntInitValues, ReadIntInitIndex);
 	else
-		value = file_acc.file_integer(sizeof(int), 0);
+		value = file_acc.file_integer<Generate>(sizeof(int), 0);
 	file_acc.lookahead = false;
-	FSeek(original_pos);
+	FSeek<Generate>(original_pos);
 	return value;
 }
 
 extern std::vector<uint> ReadUIntInitValues;
+extern known_index<uint> ReadUIntInitIndex;
 
-uint ReadUInt(int64 pos = FTell(), std::vector<uint> possible_values = {}) {
+template<bool Generate>
+uint ReadUInt(int64 pos = FTell(), value_span<uint> possible_values = {}) {
 	int64 original_pos = FTell();
-	FSeek(pos);
+	FSeek<Generate>(pos);
 	file_acc.lookahead = true;
 	uint value;
 	if (possible_values.size())
-		value = file_acc.file_integer(sizeof(uint), 0, possible_values);
+		value = file_acc.file_integer<Generate>(sizeof(uint), 0, possible_values);
 	else if (ReadUIntInitValues.size())
-		value = file_acc.file_integer(sizeof(uint), 0, ReadUIntInitValues);
+		value = file_acc.file_integer<Generate>(sizeof(uint), 0, ReadUIntInitValues, ReadUIntInitIndex);
 	else
-		value = file_acc.file_integer(sizeof(uint), 0);
+		value = file_acc.file_integer<Generate>(sizeof(uint), 0);
 	file_acc.lookahead = false;
-	FSeek(original_pos);
+	FSeek<Generate>(original_pos);
 	return value;
 }
 
 extern std::vector<int64> ReadQuadInitValues;
+extern known_index<int64> ReadQuadInitIndex;
 
-int64 ReadQuad(int64 pos = FTell(), std::vector<int64> possible_values = {}) {
+template<bool Generate>
+int64 ReadQuad(int64 pos = FTell(), value_span<int64> possible_values = {}) {
 	int64 original_pos = FTell();
-	FSeek(pos);
+	FSeek<Generate>(pos);
 	file_acc.lookahead = true;
 	int64 value;
 	if (possible_values.size())
-		value = file_acc.file_integer(sizeof(int64), 0, possible_values);
+		value = file_acc.file_integer<Generate>(sizeof(int64), 0, possible_values);
 	else if (ReadQuadInitValues.size())
-		value = file_acc.file_integer(sizeof(int64), 0, ReadQuadInitValues);
+		value = file_acc.file_integer<Generate>(sizeof(int64), 0, ReadQuadInitValues, ReadQuadInitIndex);
 	else
-		value = file_acc.file_integer(sizeof(int64), 0);
+		value = file_acc.file_integer<Generate>(sizeof(int64), 0);
 	file_acc.lookahead = false;
-	FSeek(original_pos);
+	FSeek<Generate>(original_pos);
 	return value;
 }
 
 extern std::vector<uint64> ReadUQuadInitValues;
+extern known_index<uint64> ReadUQuadInitIndex;
 
-uint64 ReadUQuad(int64 pos = FTell(), std::vector<uint64> possible_values = {}) {
+template<bool Generate>
+uint64 ReadUQuad(int64 pos = FTell(), value_span<uint64> possible_values = {}) {
 	int64 original_pos = FTell();
-	FSeek(pos);
+	FSeek<Generate>(pos);
 	file_acc.lookahead = true;
 	uint64 value;
 	if (possible_values.size())
-		value = file_acc.file_integer(sizeof(uint64), 0, possible_values);
+		value = file_acc.file_integer<Generate>(sizeof(uint64), 0, possible_values);
 	else if (ReadUQuadInitValues.size())
-		value = file_acc.file_integer(sizeof(uint64), 0, ReadUQuadInitValues);
+		value = file_acc.file_integer<Generate>(sizeof(uint64), 0, ReadUQuadInitValues, ReadUQuadInitIndex);
 	else
-		value = file_acc.file_integer(sizeof(uint64), 0);
+		value = file_acc.file_integer<Generate>(sizeof(uint64), 0);
 	file_acc.lookahead = false;
-	FSeek(original_pos);
+	FSeek<Generate>(original_pos);
 	return value;
 }
 
 extern std::vector<int64> ReadInt64InitValues;
+extern known_index<int64> ReadInt64InitIndex;
 
-int64 ReadInt64(int64 pos = FTell(), std::vector<int64> possible_values = {}) {
+template<bool Generate>
+int64 ReadInt64(int64 pos = FTell(), value_span<int64> possible_values = {}) {
 	int64 original_pos = FTell();
-	FSeek(pos);
+	FSeek<Generate>(pos);
 	file_acc.lookahead = true;
 	int64 value;
 	if (possible_values.size())
-		value = file_acc.file_integer(sizeof(int64), 0, possible_values);
+		value = file_acc.file_integer<Generate>(sizeof(int64), 0, possible_values);
 	else if (ReadInt64InitValues.size())
-		value = file_acc.file_integer(sizeof(int64), 0, ReadInt64InitValues);
+		value = file_acc.file_integer<Generate>(sizeof(int64), 0, ReadInt64InitValues, ReadInt64InitIndex);
 	else
-		value = file_acc.file_integer(sizeof(int64), 0);
+		value = file_acc.file_integer<Generate>(sizeof(int64), 0);
 	file_acc.lookahead = false;
-	FSeek(original_pos);
+	FSeek<Generate>(original_pos);
 	return value;
 }
 
 extern std::vector<uint64> ReadUInt64InitValues;
+extern known_index<uint64> ReadUInt64InitIndex;
 
-uint64 ReadUInt64(int64 pos = FTell(), std::vector<uint64> possible_values = {}) {
+template<bool Generate>
+uint64 ReadUInt64(int64 pos = FTell(), value_span<uint64> possible_values = {}) {
 	int64 original_pos = FTell();
-	FSeek(pos);
+	FSeek<Generate>(pos);
 	file_acc.lookahead = true;
 	uint64 value;
 	if (possible_values.size())
-		value = file_acc.file_integer(sizeof(uint64), 0, possible_values);
+		value = file_acc.file_integer<Generate>(sizeof(uint64), 0, possible_values);
 	else if (ReadUInt64InitValues.size())
-		value = file_acc.file_integer(sizeof(uint64), 0, ReadUInt64InitValues);
+		value = file_acc.file_integer<Generate>(sizeof(uint64), 0, ReadUInt64InitValues, ReadUInt64InitIndex);
 	else
-		value = file_acc.file_integer(sizeof(uint64), 0);
+		value = file_acc.file_integer<Generate>(sizeof(uint64), 0);
 	file_acc.lookahead = false;
-	FSeek(original_pos);
+	FSeek<Generate>(original_pos);
 	return value;
 }
 
 extern std::vector<hfloat> ReadHFloatInitValues;
+extern known_index<hfloat> ReadHFloatInitIndex;
 
-hfloat ReadHFloat(int64 pos = FTell(), std::vector<hfloat> possible_values = {}) {
+template<bool Generate>
+hfloat ReadHFloat(int64 pos = FTell(), value_span<hfloat> possible_values = {}) {
 	int64 original_pos = FTell();
-	FSeek(pos);
+	FSeek<Generate>(pos);
 	file_acc.lookahead = true;
 	hfloat value;
 	if (possible_values.size())
-		value = file_acc.file_integer(sizeof(hfloat), 0, possible_values);
+		value = file_acc.file_integer<Generate>(sizeof(hfloat), 0, possible_values);
 	else if (ReadHFloatInitValues.size())
-		value = file_acc.file_integer(sizeof(hfloat), 0, ReadHFloatInitValues);
+		value = file_acc.file_integer<Generate>(sizeof(hfloat), 0, ReadHFloatInitValues, ReadHFloatInitIndex);
 	else
-		value = file_acc.file_integer(sizeof(hfloat), 0);
+		value = file_acc.file_integer<Generate>(sizeof(hfloat), 0);
 	file_acc.lookahead = false;
-	FSeek(original_pos);
+	FSeek<Generate>(original_pos);
 	return value;
 }
 
 extern std::vector<float> ReadFloatInitValues;
+extern known_index<float> ReadFloatInitIndex;
 
-float ReadFloat(int64 pos = FTell(), std::vector<float> possible_values = {}) {
+template<bool Generate>
+float ReadFloat(int64 pos = FTell(), value_span<float> possible_values = {}) {
 	int64 original_pos = FTell();
-	FSeek(pos);
+	FSeek<Generate>(pos);
 	file_acc.lookahead = true;
 	float value;
 	if (possible_values.size())
-		value = file_acc.file_integer(sizeof(float), 0, possible_values);
+		value = file_acc.file_integer<Generate>(sizeof(float), 0, possible_values);
 	else if (ReadFloatInitValues.size())
-		value = file_acc.file_integer(sizeof(float), 0, ReadFloatInitValues);
+		value = file_acc.file_integer<Generate>(sizeof(float), 0, ReadFloatInitValues, ReadFloatInitIndex);
 	else
-		value = file_acc.file_integer(sizeof(float), 0);
+		value = file_acc.file_integer<Generate>(sizeof(float), 0);
 	file_acc.lookahead = false;
-	FSeek(original_pos);
+	FSeek<Generate>(original_pos);
 	return value;
 }
 
 extern std::vector<double> ReadDoubleInitValues;
+extern known_index<double> ReadDoubleInitIndex;
 
-double ReadDouble(int64 pos = FTell(), std::vector<double> possible_values = {}) {
+template<bool Generate>
+double ReadDouble(int64 pos = FTell(), value_span<double> possible_values = {}) {
 	int64 original_pos = FTell();
-	FSeek(pos);
+	FSeek<Generate>(pos);
 	file_acc.lookahead = true;
 	double value;
 	if (possible_values.size())
-		value = file_acc.file_integer(sizeof(double), 0, possible_values);
+		value = file_acc.file_integer<Generate>(sizeof(double), 0, possible_values);
 	else if (ReadDoubleInitValues.size())
-		value = file_acc.file_integer(sizeof(double), 0, ReadDoubleInitValues);
+		value = file_acc.file_integer<Generate>(sizeof(double), 0, ReadDoubleInitValues, ReadDoubleInitIndex);
 	else
-		value = file_acc.file_integer(sizeof(double), 0);
+		value = file_acc.file_integer<Generate>(sizeof(double), 0);
 	file_acc.lookahead = false;
-	FSeek(original_pos);
+	FSeek<Generate>(original_pos);
 	return value;
 }
 
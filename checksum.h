@@ -0,0 +1,470 @@
+#ifndef FF_CHECKSUM_H
+#define FF_CHECKSUM_H
+
+// Checksums over file data, as computed by the 010 Editor Checksum()
+// function.  Every algorithm has a portable scalar implementation; on
+// x86-64, CRC32, Adler32 and the sums also have vector kernels that are
+// selected at run time when the CPU supports them.  CRC16 and CRC-CCITT
+// process eight bytes per table lookup step.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <zlib.h>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define FF_CHECKSUM_X86 1
+#include <immintrin.h>
+#endif
+
+const int CHECKSUM_BYTE = 0;
+const int CHECKSUM_SHORT_LE = 1;
+const int CHECKSUM_SHORT_BE = 2;
+const int CHECKSUM_INT_LE = 3;
+const int CHECKSUM_INT_BE = 4;
+const int CHECKSUM_INT64_LE = 5;
+const int CHECKSUM_INT64_BE = 6;
+const int CHECKSUM_SUM8 = 7;
+const int CHECKSUM_SUM16 = 8;
+const int CHECKSUM_SUM32 = 9;
+const int CHECKSUM_SUM64 = 10;
+const int CHECKSUM_CRC16 = 11;
+const int CHECKSUM_CRCCCITT = 12;
+const int CHECKSUM_CRC32 = 13;
+const int CHECKSUM_ADLER32 = 14;
+const int CHECKSUM_TYPES = 15;
+
+// Sum of the size / sizeof(T) whole units of type T in data, read in
+// little- or big-endian order.  Trailing bytes that do not fill a unit
+// are added as a unit padded with zeros.
+template<typename T, bool big_endian>
+static inline __attribute__((always_inline)) uint64_t checksum_units(const unsigned char* data, size_t size) {
+	uint64_t sum = 0;
+	size_t n = size / sizeof(T);
+	for (size_t i = 0; i < n; ++i) {
+		T v;
+		memcpy(&v, data + i * sizeof(T), sizeof(T));
+		if (big_endian) {
+			if (sizeof(T) == 2) v = __builtin_bswap16(v);
+			if (sizeof(T) == 4) v = __builtin_bswap32(v);
+			if (sizeof(T) == 8) v = __builtin_bswap64(v);
+		}
+		sum += v;
+	}
+	T last = 0;
+	for (size_t i = n * sizeof(T); i < size; ++i) {
+		unsigned shift = big_endian ? 8 * (sizeof(T) - 1 - (i % sizeof(T))) : 8 * (i % sizeof(T));
+		last |= (T) data[i] << shift;
+	}
+	return sum + last;
+}
+
+static inline uint64_t checksum_sum_scalar(int type, const unsigned char* data, size_t size) {
+	switch (type) {
+	case CHECKSUM_SHORT_LE: return checksum_units<uint16_t, false>(data, size);
+	case CHECKSUM_SHORT_BE: return checksum_units<uint16_t, true>(data, size);
+	case CHECKSUM_INT_LE: return checksum_units<uint32_t, false>(data, size);
+	case CHECKSUM_INT_BE: return checksum_units<uint32_t, true>(data, size);
+	case CHECKSUM_INT64_LE: return checksum_units<uint64_t, false>(data, size);
+	case CHECKSUM_INT64_BE: return checksum_units<uint64_t, true>(data, size);
+	default: return checksum_units<uint8_t, false>(data, size);
+	}
+}
+
+// Byte-wise CRC tables, extended to process eight bytes per step.
+struct crc16_tables {
+	uint16_t arc[8][256];   // CRC-16/ARC: reflected polynomial 0x8005
+	uint16_t ccitt[8][256]; // CRC-CCITT: polynomial 0x1021, MSB first
+	crc16_tables() {
+		for (unsigned i = 0; i < 256; ++i) {
+			uint16_t a = i;
+			uint16_t c = i << 8;
+			for (int k = 0; k < 8; ++k) {
+				a = (a & 1) ? (a >> 1) ^ 0xA001 : a >> 1;
+				c = (c & 0x8000) ? (c << 1) ^ 0x1021 : c << 1;
+			}
+			arc[0][i] = a;
+			ccitt[0][i] = c;
+		}
+		for (unsigned i = 0; i < 256; ++i) {
+			for (int t = 1; t < 8; ++t) {
+				uint16_t a = arc[t - 1][i];
+				arc[t][i] = (a >> 8) ^ arc[0][a & 0xFF];
+				uint16_t c = ccitt[t - 1][i];
+				ccitt[t][i] = (c << 8) ^ ccitt[0][c >> 8];
+			}
+		}
+	}
+};
+
+static inline const crc16_tables& checksum_crc16_tables() {
+	static const crc16_tables tables;
+	return tables;
+}
+
+// One byte per step: the reference for the eight-byte versions below
+static inline uint16_t checksum_crc16_bytewise(uint16_t crc, const unsigned char* data, size_t size) {
+	const auto& t = checksum_crc16_tables().arc;
+	for (; size; ++data, --size)
+		crc = (crc >> 8) ^ t[0][(crc ^ *data) & 0xFF];
+	return crc;
+}
+
+static inline uint16_t checksum_crcccitt_bytewise(uint16_t crc, const unsigned char* data, size_t size) {
+	const auto& t = checksum_crc16_tables().ccitt;
+	for (; size; ++data, --size)
+		crc = (crc << 8) ^ t[0][(crc >> 8) ^ *data];
+	return crc;
+}
+
+static inline uint16_t checksum_crc16(uint16_t crc, const unsigned char* data, size_t size) {
+	const auto& t = checksum_crc16_tables().arc;
+	for (; size >= 8; data += 8, size -= 8) {
+		crc = t[7][(crc ^ data[0]) & 0xFF] ^ t[6][(crc >> 8) ^ data[1]]
+			^ t[5][data[2]] ^ t[4][data[3]] ^ t[3][data[4]]
+			^ t[2][data[5]] ^ t[1][data[6]] ^ t[0][data[7]];
+	}
+	return checksum_crc16_bytewise(crc, data, size);
+}
+
+static inline uint16_t checksum_crcccitt(uint16_t crc, const unsigned char* data, size_t size) {
+	const auto& t = checksum_crc16_tables().ccitt;
+	for (; size >= 8; data += 8, size -= 8) {
+		crc = t[7][(crc >> 8) ^ data[0]] ^ t[6][(crc ^ data[1]) & 0xFF]
+			^ t[5][data[2]] ^ t[4][data[3]] ^ t[3][data[4]]
+			^ t[2][data[5]] ^ t[1][data[6]] ^ t[0][data[7]];
+	}
+	return checksum_crcccitt_bytewise(crc, data, size);
+}
+
+#ifdef FF_CHECKSUM_X86
+// CRC32 by folding 64 bytes at a time with carry-less multiplication
+// (Gopal et al., "Fast CRC Computation for Generic Polynomials Using
+// PCLMULQDQ Instruction").  size must be a multiple of 16 and at least 64;
+// crc is the inverted register value.
+__attribute__((target("pclmul,sse4.1")))
+static inline uint32_t checksum_crc32_pclmul(uint32_t crc, const unsigned char* data, size_t size) {
+	alignas(16) static const uint64_t k1k2[] = { 0x0154442bd4, 0x01c6e41596 };
+	alignas(16) static const uint64_t k3k4[] = { 0x01751997d0, 0x00ccaa009e };
+	alignas(16) static const uint64_t k5k0[] = { 0x0163cd6124, 0x0000000000 };
+	alignas(16) static const uint64_t poly[] = { 0x01db710641, 0x01f7011641 };
+	__m128i x0, x1, x2, x3, x4, x5, x6, x7, x8;
+
+	x1 = _mm_loadu_si128((const __m128i*) (data + 0x00));
+	x2 = _mm_loadu_si128((const __m128i*) (data + 0x10));
+	x3 = _mm_loadu_si128((const __m128i*) (data + 0x20));
+	x4 = _mm_loadu_si128((const __m128i*) (data + 0x30));
+	x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(crc));
+	x0 = _mm_load_si128((const __m128i*) k1k2);
+	data += 64;
+	size -= 64;
+
+	// Fold four lanes in parallel
+	for (; size >= 64; data += 64, size -= 64) {
+		x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+		x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+		x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+		x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+		x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+		x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+		x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+		x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128((const __m128i*) (data + 0x00)));
+		x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128((const __m128i*) (data + 0x10)));
+		x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128((const __m128i*) (data + 0x20)));
+		x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128((const __m128i*) (data + 0x30)));
+	}
+
+	// Fold the four lanes into one
+	x0 = _mm_load_si128((const __m128i*) k3k4);
+	x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+	x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+	x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+	x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+	x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+	x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+	x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+	x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+	x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+	for (; size >= 16; data += 16, size -= 16) {
+		x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+		x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+		x1 = _mm_xor_si128(_mm_xor_si128(x1, _mm_loadu_si128((const __m128i*) data)), x5);
+	}
+
+	// Fold 128 bits to 64 bits
+	x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+	x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+	x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+	x0 = _mm_loadl_epi64((const __m128i*) k5k0);
+	x2 = _mm_srli_si128(x1, 4);
+	x1 = _mm_and_si128(x1, x3);
+	x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+	x1 = _mm_xor_si128(x1, x2);
+
+	// Barrett reduction to 32 bits
+	x0 = _mm_load_si128((const __m128i*) poly);
+	x2 = _mm_and_si128(x1, x3);
+	x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+	x2 = _mm_and_si128(x2, x3);
+	x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+	x1 = _mm_xor_si128(x1, x2);
+	return _mm_extract_epi32(x1, 1);
+}
+
+// Adler32 over 32-byte blocks: the byte sums go to s1 and the
+// position-weighted sums to s2, reducing modulo 65521 every NMAX bytes.
+__attribute__((target("ssse3")))
+static inline uint32_t checksum_adler32_ssse3(uint32_t adler, const unsigned char* data, size_t size) {
+	const uint32_t BASE = 65521;
+	const unsigned NMAX = 5552;
+	uint32_t s1 = adler & 0xFFFF;
+	uint32_t s2 = adler >> 16;
+	size_t blocks = size / 32;
+	size -= blocks * 32;
+	const __m128i tap1 = _mm_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17);
+	const __m128i tap2 = _mm_setr_epi8(16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i ones = _mm_set1_epi16(1);
+	while (blocks) {
+		unsigned n = NMAX / 32;
+		if (n > blocks)
+			n = blocks;
+		blocks -= n;
+		__m128i v_ps = _mm_setr_epi32(s1 * n, 0, 0, 0);
+		__m128i v_s2 = _mm_setr_epi32(s2, 0, 0, 0);
+		__m128i v_s1 = _mm_setzero_si128();
+		do {
+			const __m128i bytes1 = _mm_loadu_si128((const __m128i*) data);
+			const __m128i bytes2 = _mm_loadu_si128((const __m128i*) (data + 16));
+			v_ps = _mm_add_epi32(v_ps, v_s1);
+			v_s1 = _mm_add_epi32(v_s1, _mm_sad_epu8(bytes1, zero));
+			v_s2 = _mm_add_epi32(v_s2, _mm_madd_epi16(_mm_maddubs_epi16(bytes1, tap1), ones));
+			v_s1 = _mm_add_epi32(v_s1, _mm_sad_epu8(bytes2, zero));
+			v_s2 = _mm_add_epi32(v_s2, _mm_madd_epi16(_mm_maddubs_epi16(bytes2, tap2), ones));
+			data += 32;
+		} while (--n);
+		v_s2 = _mm_add_epi32(v_s2, _mm_slli_epi32(v_ps, 5));
+		v_s1 = _mm_add_epi32(v_s1, _mm_shuffle_epi32(v_s1, _MM_SHUFFLE(2, 3, 0, 1)));
+		v_s1 = _mm_add_epi32(v_s1, _mm_shuffle_epi32(v_s1, _MM_SHUFFLE(1, 0, 3, 2)));
+		s1 += _mm_cvtsi128_si32(v_s1);
+		v_s2 = _mm_add_epi32(v_s2, _mm_shuffle_epi32(v_s2, _MM_SHUFFLE(2, 3, 0, 1)));
+		v_s2 = _mm_add_epi32(v_s2, _mm_shuffle_epi32(v_s2, _MM_SHUFFLE(1, 0, 3, 2)));
+		s2 = _mm_cvtsi128_si32(v_s2);
+		s1 %= BASE;
+		s2 %= BASE;
+	}
+	return adler32(s1 | (s2 << 16), data, size);
+}
+
+// Byte sums with vpsadbw, 32 bytes per step
+__attribute__((target("avx2")))
+static inline uint64_t checksum_bytes_avx2(const unsigned char* data, size_t size) {
+	__m256i sum = _mm256_setzero_si256();
+	const __m256i zero = _mm256_setzero_si256();
+	size_t i = 0;
+	for (; i + 32 <= size; i += 32)
+		sum = _mm256_add_epi64(sum, _mm256_sad_epu8(_mm256_loadu_si256((const __m256i*) (data + i)), zero));
+	alignas(32) uint64_t lanes[4];
+	_mm256_store_si256((__m256i*) lanes, sum);
+	return lanes[0] + lanes[1] + lanes[2] + lanes[3] + checksum_units<uint8_t, false>(data + i, size - i);
+}
+
+// Sums of 2-byte units with vpsadbw: the sum of all bytes and of the
+// bytes at odd offsets give the sums of the low and high bytes
+template<bool big_endian>
+__attribute__((target("avx2")))
+static inline uint64_t checksum_shorts_avx2(const unsigned char* data, size_t size) {
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i odd = _mm256_set1_epi16((short) 0xFF00);
+	__m256i all_sum = zero, odd_sum = zero;
+	size_t i = 0;
+	for (; i + 32 <= size; i += 32) {
+		__m256i v = _mm256_loadu_si256((const __m256i*) (data + i));
+		all_sum = _mm256_add_epi64(all_sum, _mm256_sad_epu8(v, zero));
+		odd_sum = _mm256_add_epi64(odd_sum, _mm256_sad_epu8(_mm256_and_si256(v, odd), zero));
+	}
+	alignas(32) uint64_t a[4], o[4];
+	_mm256_store_si256((__m256i*) a, all_sum);
+	_mm256_store_si256((__m256i*) o, odd_sum);
+	uint64_t odd_bytes = o[0] + o[1] + o[2] + o[3];
+	uint64_t even_bytes = a[0] + a[1] + a[2] + a[3] - odd_bytes;
+	uint64_t sum = big_endian ? (even_bytes << 8) + odd_bytes : even_bytes + (odd_bytes << 8);
+	return sum + checksum_units<uint16_t, big_endian>(data + i, size - i);
+}
+
+// Sums of 4- and 8-byte units in 64-bit lanes; 4-byte units are split
+// into the low and high halves of each lane, big-endian units are
+// byte-swapped with vpshufb first
+template<typename T, bool big_endian>
+__attribute__((target("avx2")))
+static inline uint64_t checksum_words_avx2(const unsigned char* data, size_t size) {
+	const __m256i swap = sizeof(T) == 4
+		? _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12, 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12)
+		: _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+	const __m256i low = _mm256_set1_epi64x(0xFFFFFFFF);
+	__m256i sum0 = _mm256_setzero_si256(), sum1 = _mm256_setzero_si256();
+	size_t i = 0;
+	for (; i + 64 <= size; i += 64) {
+		__m256i v0 = _mm256_loadu_si256((const __m256i*) (data + i));
+		__m256i v1 = _mm256_loadu_si256((const __m256i*) (data + i + 32));
+		if (big_endian) {
+			v0 = _mm256_shuffle_epi8(v0, swap);
+			v1 = _mm256_shuffle_epi8(v1, swap);
+		}
+		if (sizeof(T) == 4) {
+			v0 = _mm256_add_epi64(_mm256_and_si256(v0, low), _mm256_srli_epi64(v0, 32));
+			v1 = _mm256_add_epi64(_mm256_and_si256(v1, low), _mm256_srli_epi64(v1, 32));
+		}
+		sum0 = _mm256_add_epi64(sum0, v0);
+		sum1 = _mm256_add_epi64(sum1, v1);
+	}
+	alignas(32) uint64_t lanes[4];
+	_mm256_store_si256((__m256i*) lanes, _mm256_add_epi64(sum0, sum1));
+	return lanes[0] + lanes[1] + lanes[2] + lanes[3] + checksum_units<T, big_endian>(data + i, size - i);
+}
+
+static inline uint64_t checksum_units_avx2(int type, const unsigned char* data, size_t size) {
+	switch (type) {
+	case CHECKSUM_SHORT_LE: return checksum_shorts_avx2<false>(data, size);
+	case CHECKSUM_SHORT_BE: return checksum_shorts_avx2<true>(data, size);
+	case CHECKSUM_INT_LE: return checksum_words_avx2<uint32_t, false>(data, size);
+	case CHECKSUM_INT_BE: return checksum_words_avx2<uint32_t, true>(data, size);
+	case CHECKSUM_INT64_LE: return checksum_words_avx2<uint64_t, false>(data, size);
+	default: return checksum_words_avx2<uint64_t, true>(data, size);
+	}
+}
+
+struct checksum_cpu {
+	bool pclmul, ssse3, avx2;
+	checksum_cpu() {
+		__builtin_cpu_init();
+		pclmul = __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+		ssse3 = __builtin_cpu_supports("ssse3");
+		avx2 = __builtin_cpu_supports("avx2");
+	}
+};
+
+static inline const checksum_cpu& checksum_features() {
+	static const checksum_cpu cpu;
+	return cpu;
+}
+#endif
+
+static inline uint32_t checksum_crc32(uint32_t crc, const unsigned char* data, size_t size) {
+#ifdef FF_CHECKSUM_X86
+	if (size >= 64 && checksum_features().pclmul) {
+		size_t n = size & ~(size_t) 15;
+		crc = ~checksum_crc32_pclmul(~crc, data, n);
+		data += n;
+		size -= n;
+	}
+#endif
+	return crc32(crc, data, size);
+}
+
+static inline uint32_t checksum_adler32(uint32_t adler, const unsigned char* data, size_t size) {
+#ifdef FF_CHECKSUM_X86
+	if (size >= 64 && checksum_features().ssse3)
+		return checksum_adler32_ssse3(adler, data, size);
+#endif
+	return adler32(adler, data, size);
+}
+
+// A checksum is computed incrementally: start from ff_checksum_init(),
+// feed the data through ff_checksum_update() in pieces whose sizes are
+// multiples of ff_checksum_unit() (except for the last one), and get the
+// result from ff_checksum_final().  With simd false, only the plain
+// reference implementations (zlib, byte-wise CRC16 tables and scalar
+// sums) are used.
+static inline uint64_t ff_checksum_init(int type) {
+	switch (type) {
+	case CHECKSUM_CRCCCITT: return 0xFFFF;
+	case CHECKSUM_ADLER32: return 1;
+	default: return 0;
+	}
+}
+
+static inline unsigned ff_checksum_unit(int type) {
+	switch (type) {
+	case CHECKSUM_SHORT_LE: case CHECKSUM_SHORT_BE: return 2;
+	case CHECKSUM_INT_LE: case CHECKSUM_INT_BE: return 4;
+	case CHECKSUM_INT64_LE: case CHECKSUM_INT64_BE: return 8;
+	default: return 1;
+	}
+}
+
+static inline uint64_t ff_checksum_update(int type, uint64_t state, const unsigned char* data, size_t size, bool simd = true) {
+	switch (type) {
+	case CHECKSUM_CRC16:
+		return simd ? checksum_crc16(state, data, size) : checksum_crc16_bytewise(state, data, size);
+	case CHECKSUM_CRCCCITT:
+		return simd ? checksum_crcccitt(state, data, size) : checksum_crcccitt_bytewise(state, data, size);
+	case CHECKSUM_CRC32:
+		return simd ? checksum_crc32(state, data, size) : crc32(state, data, size);
+	case CHECKSUM_ADLER32:
+		return simd ? checksum_adler32(state, data, size) : adler32(state, data, size);
+	}
+#ifdef FF_CHECKSUM_X86
+	if (simd && checksum_features().avx2)
+		return state + (ff_checksum_unit(type) == 1 ? checksum_bytes_avx2(data, size) : checksum_units_avx2(type, data, size));
+#endif
+	return state + checksum_sum_scalar(type, data, size);
+}
+
+static inline uint64_t ff_checksum_final(int type, uint64_t state) {
+	switch (type) {
+	case CHECKSUM_SUM8: return (uint8_t) state;
+	case CHECKSUM_SUM16: return (uint16_t) state;
+	case CHECKSUM_SUM32: return (uint32_t) state;
+	default: return state;
+	}
+}
+
+// Name of the implementation that ff_checksum() uses for the given type
+// with simd set, on this CPU.  CRC16 and CRC-CCITT have no vector kernel;
+// they process eight bytes per step with eight lookup tables.
+static inline const char* ff_checksum_kernel(int type) {
+	switch (type) {
+	case CHECKSUM_CRC16:
+	case CHECKSUM_CRCCCITT:
+		return "table x8";
+	case CHECKSUM_CRC32:
+#ifdef FF_CHECKSUM_X86
+		if (checksum_features().pclmul)
+			return "PCLMUL";
+#endif
+		return "zlib";
+	case CHECKSUM_ADLER32:
+#ifdef FF_CHECKSUM_X86
+		if (checksum_features().ssse3)
+			return "SSSE3";
+#endif
+		return "zlib";
+	}
+#ifdef FF_CHECKSUM_X86
+	if (checksum_features().avx2)
+		return "AVX2";
+#endif
+	return "scalar";
+}
+
+// Checksum of the given type over size bytes of data
+static inline uint64_t ff_checksum(int type, const unsigned char* data, size_t size, bool simd = true) {
+	return ff_checksum_final(type, ff_checksum_update(type, ff_checksum_init(type), data, size, simd));
+}
+
+// A checksum over the file bytes from start on, kept up to date while
+// they are written.  state covers the bytes up to done; dirty is set when
+// some of those bytes are written again.
+struct checksum_range {
+	int type;
+	unsigned start;
+	unsigned done;
+	uint64_t state;
+	bool dirty;
+	bool active;
+};
+
+#endif
@@ -1,51 +1,69 @@
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
 #include <random>
 #include <cassert>
 #include <algorithm>
 #include <functional>
+#include <initializer_list>
 #include <zlib.h>
 #include "formatfuzzer.h"
+#include "checksum.h"
+
+// Decision value of rand_position() that announces an exact file offset
+#define POSITION_ESCAPE 0xffffffffULL
 
 extern std::vector<std::vector<int>> integer_ranges;
 
-bool is_big_endian = false;
-bool is_bitfield_left_to_right[2] = {false, true};
-bool is_padded_bitfield = true;
+// All state touched while generating or parsing a file is thread_local,
+// so every thread owns an independent generator context (file_acc,
+// generator_stack, the template globals, ...) and any number of threads
+// can run ff_generate()/ff_parse() concurrently in one process.
+thread_local bool is_big_endian = false;
+thread_local bool is_bitfield_left_to_right[2] = {false, true};
+thread_local bool is_padded_bitfield = true;
+
+thread_local bool is_following = false;
+thread_local bool following_is_optional = false;
 
-bool is_following = false;
-bool following_is_optional = false;
+thread_local const char* chunk_name;
+thread_local const char* chunk_type;
+thread_local const char* chunk_name2;
+thread_local int file_index = 0;
 
-const char* chunk_name;
-const char* chunk_name2;
-int file_index = 0;
+thread_local bool get_chunk = false;
+thread_local bool get_all_chunks = false;
+thread_local bool smart_mutation = false;
+thread_local bool smart_abstraction = false;
+thread_local bool smart_swapping = false;
+thread_local unsigned chunk_start;
+thread_local unsigned chunk_end;
+thread_local unsigned rand_start;
+thread_local unsigned rand_end;
+thread_local unsigned rand_start2;
+thread_local unsigned rand_end2;
+thread_local bool is_optional = false;
+thread_local bool is_delete = false;
 
-bool get_chunk = false;
-bool get_all_chunks = false;
-bool smart_mutation = false;
-bool smart_abstraction = false;
-bool smart_swapping = false;
-unsigned chunk_start;
-unsigned chunk_end;
-unsigned rand_start;
-unsigned rand_end;
-unsigned rand_start2;
-unsigned rand_end2;
-bool is_optional = false;
-bool is_delete = false;
 
+// Chunks found by the current thread while parsing with get_all_chunks
+// set (see add_file_chunks() in fuzzer.cpp)
+thread_local file_chunks found_chunks;
 
+// The chunk corpus is shared by all threads.  add_file_chunks() and
+// one_smart_mutation() update it and must not run concurrently.
 std::vector<std::vector<InsertionPoint>> insertion_points;
 std::vector<std::vector<Chunk>> deletable_chunks;
 std::vector<Chunk> optional_chunks;
 std::vector<int> optional_index = { 0 };
-std::unordered_map<std::string, std::vector<Chunk>> non_optional_chunks;
+std::vector<std::string> chunk_types;
+std::vector<std::vector<Chunk>> non_optional_chunks; // by type id
 std::vector<std::vector<NonOptional>> non_optional_index;
 std::vector<std::string> rand_names;
-extern unsigned currentPos;
-bool mutatedDecision = false;
+extern thread_local unsigned currentPos;
+thread_local bool mutatedDecision = false;
 
 
 void swap_bytes(void* b, unsigned size) {
@@ -57,26 +75,127 @@ void swap_bytes(void* b, unsigned size) {
 }
 
 
-bool debug_print = false;
-bool print_errors = false;
-bool get_parse_tree = true;
+thread_local bool debug_print = false;
+thread_local bool print_errors = false;
+thread_local bool get_parse_tree = true;
 struct stack_cell {
 	const char* name;
-	std::unordered_map<std::string, int> counts;
+	unsigned field;
 	unsigned rand_start = 0;
 	unsigned rand_start_real = 0;
 	unsigned min = UINT_MAX;
 	unsigned max = 0;
 	unsigned ID = 0;
-	stack_cell(const char* name, unsigned rand_start, unsigned rand_start_real, unsigned ID) : name(name), rand_start(rand_start), rand_start_real(rand_start_real), ID(ID) {}
+	unsigned node = 0;
+	stack_cell(const char* name, unsigned field, unsigned rand_start, unsigned rand_start_real, unsigned ID) : name(name), field(field), rand_start(rand_start), rand_start_real(rand_start_real), ID(ID) {}
 	void clear() {
-		counts.clear();
 		min = UINT_MAX;
 		max = 0;
 	}
 };
-stack_cell root_cell("file", 0, 0, 0);
-std::vector<stack_cell> generator_stack = {root_cell};
+const stack_cell root_cell("file", UINT_MAX, 0, 0, 0);
+thread_local std::vector<stack_cell> generator_stack = {root_cell};
+// For each generator_stack level, how many children of each field id
+// (see field_id in the generated code) it has completed so far: one row
+// of field_count entries per level.  Only kept up to date under
+// debug_print, whose parse tree output is the one place it is read.
+thread_local std::vector<unsigned> child_counts;
+
+// Field ids of the generated template, one per field name of each struct
+// (field_id_<struct>_<name>, or field_id_<name> at the top level).  They
+// index field_types, which holds the class of that field.
+extern const unsigned field_count;
+extern const char* const field_types[];
+
+// Fingerprint of the generated code (see load_corpus() in fuzzer.cpp)
+extern const uint64_t template_hash;
+
+// Binary parse tree of the current file, recorded when enabled with
+// ff_record_parse_tree().  start_generation() appends a node for each
+// chunk and end_generation() fills in its ranges; image() lays it out
+// as described in formatfuzzer.h.  The string table is kept from file
+// to file, so each name and type is only added once per thread.
+struct parse_tree_recorder {
+	bool enabled = false;
+	std::vector<ff_tree_node> nodes;
+	std::string strings;
+	std::vector<uint32_t> names;	// string offset of each field id's name
+	std::vector<uint32_t> types;	// and of its type
+	std::unordered_map<std::string, uint32_t> type_offsets;
+	uint32_t root_name = 0;
+	uint32_t root_type = 0;
+	std::vector<unsigned char> bytes;
+
+	uint32_t add_string(const char* s) {
+		uint32_t offset = strings.size();
+		strings.append(s, strlen(s) + 1);
+		return offset;
+	}
+
+	// Start the tree of a new file with its root node
+	void reset() {
+		if (strings.empty()) {
+			root_name = add_string("file");
+			root_type = add_string("");
+			names.assign(field_count, FF_TREE_NONE);
+			types.assign(field_count, FF_TREE_NONE);
+		}
+		nodes.clear();
+		nodes.push_back({FF_TREE_NONE, 0, FF_TREE_NONE, root_name, root_type, 0, 0, 0, 0, 0, 0});
+	}
+
+	void open(stack_cell& cell, stack_cell& parent, unsigned index) {
+		if (names[cell.field] == FF_TREE_NONE) {
+			names[cell.field] = add_string(cell.name);
+			auto type = type_offsets.find(field_types[cell.field]);
+			if (type == type_offsets.end())
+				type = type_offsets.emplace(field_types[cell.field], add_string(field_types[cell.field])).first;
+			types[cell.field] = type->second;
+		}
+		cell.node = nodes.size();
+		nodes.push_back({parent.node, 0, cell.field, names[cell.field], types[cell.field], index, 0, 0, 0, 0, 0});
+	}
+
+	void close(const stack_cell& cell, unsigned rand_end, uint32_t flags) {
+		ff_tree_node& node = nodes[cell.node];
+		node.end = nodes.size();
+		node.rand_start = cell.rand_start;
+		node.rand_end = rand_end;
+		node.byte_start = cell.min;
+		node.byte_end = cell.max;
+		node.flags = flags;
+		if (cell.rand_start != cell.rand_start_real)
+			node.flags |= FF_TREE_OPTIONAL;
+	}
+
+	// Lay out the tree for the stack of chunks still being generated
+	// (just the root after a successful generation)
+	const std::vector<unsigned char>& image(const std::vector<stack_cell>& stack, unsigned rand_pos, unsigned file_pos, unsigned file_size) {
+		for (size_t level = stack.size(); level-- > 0; ) {
+			stack_cell cell = stack[level];
+			if (cell.min > cell.max) {
+				cell.min = file_pos;
+				cell.max = file_pos - 1;
+			}
+			close(cell, rand_pos - 1, stack.size() > 1 ? FF_TREE_INCOMPLETE : 0);
+		}
+		ff_tree_header header;
+		header.magic = FF_TREE_MAGIC;
+		header.version = FF_TREE_VERSION;
+		header.node_count = nodes.size();
+		header.node_offset = sizeof(header);
+		header.string_size = strings.size();
+		header.string_offset = sizeof(header) + nodes.size() * sizeof(ff_tree_node);
+		header.file_size = file_size;
+		header.decisions = rand_pos;
+		bytes.resize(header.string_offset + strings.size());
+		memcpy(bytes.data(), &header, sizeof(header));
+		memcpy(bytes.data() + header.node_offset, nodes.data(), nodes.size() * sizeof(ff_tree_node));
+		memcpy(bytes.data() + header.string_offset, strings.data(), strings.size());
+		return bytes;
+	}
+};
+thread_local parse_tree_recorder parse_tree;
 
 
 void assert_cond(bool cond, const char* error_msg) {
@@ -87,11 +206,92 @@ void assert_cond(bool cond, const char* error_msg) {
 	}
 }
 
-unsigned char *rand_buffer;
+thread_local unsigned char *rand_buffer;
+
+// wyrand - a small, fast PRNG for random decisions.  Each call yields
+// 64 fresh bits; equal seeds give equal streams on all platforms.
+struct wyrand {
+	uint64_t state;
+
+	explicit wyrand(uint64_t seed = 0) : state(seed) {}
+
+	uint64_t operator()() {
+		state += 0xa0761d6478bd642fULL;
+		__uint128_t t = (__uint128_t) state * (state ^ 0xe7037ed1a0b428dbULL);
+		return (uint64_t) (t >> 64) ^ (uint64_t) t;
+	}
+};
+
+// A read-only view of a set of known values.  Generated code passes
+// literal sets such as generate({ 0x3B }) as braced lists, which the
+// compiler places on the stack, so no vector is allocated per call.  The
+// viewed values must outlive the call they are passed to.
+template<typename T>
+struct value_span {
+	const T* values = NULL;
+	size_t count = 0;
+
+	value_span() {}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Winit-list-lifetime"
+#endif
+	value_span(std::initializer_list<T> list) : values(list.begin()), count(list.size()) {}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+	value_span(const std::vector<T>& vector) : values(vector.data()), count(vector.size()) {}
+	value_span(const T* values, size_t count) : values(values), count(count) {}
+
+	const T* begin() const { return values; }
+	const T* end() const { return values + count; }
+	size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+	const T& operator [] (size_t i) const { return values[i]; }
+};
+
+// Lookup table for a set of known values, built once by the generated code
+// for each field, enum and Read*InitValues set.  Sets with more than
+// KNOWN_INDEX_MIN values are sorted by value, so that parsing finds a
+// value in O(log n); smaller sets are searched linearly.
+#define KNOWN_INDEX_MIN 8
 
-unsigned char *following_rand_buffer = NULL;
-unsigned following_rand_size = 0;
+template<typename T>
+struct known_index {
+	std::vector<std::pair<T, unsigned>> sorted;
 
+	known_index() {}
+	known_index(value_span<T> values) {
+		if (values.size() <= KNOWN_INDEX_MIN)
+			return;
+		sorted.reserve(values.size());
+		for (unsigned i = 0; i < values.size(); ++i)
+			sorted.emplace_back(values[i], i);
+		std::sort(sorted.begin(), sorted.end());
+		// Keep the first position of each value, as std::find() would
+		sorted.erase(std::unique(sorted.begin(), sorted.end(), [](const std::pair<T, unsigned>& a, const std::pair<T, unsigned>& b) { return a.first == b.first; }), sorted.end());
+	}
+
+	// Position of value in values (the set this index was built from), or
+	// values.size() if it is not there
+	template<typename K>
+	long long find(value_span<T> values, const K& value) const {
+		if (sorted.empty())
+			return std::find(values.begin(), values.end(), value) - values.begin();
+		auto it = std::lower_bound(sorted.begin(), sorted.end(), value, [](const std::pair<T, unsigned>& e, const K& v) { return e.first < v; });
+		if (it == sorted.end() || !(it->first == value))
+			return values.size();
+		return it->second;
+	}
+};
+
+thread_local unsigned char *following_rand_buffer = NULL;
+thread_local unsigned following_rand_size = 0;
+
+// Every method that behaves differently when generating and when parsing
+// is a template on the mode and is instantiated once per mode, so that
+// mode checks fold away at compile time.  The generated code is templated
+// on the mode as well, and generate_file() picks it once per file.
 class file_accessor {
 	bool allow_evil_values = true;
 	bool dont_be_evil = false;
@@ -153,14 +353,15 @@ class file_accessor {
 		return value;
 	}
 
+	template<bool Generate>
 	void write_file_bits(unsigned long long value, size_t size, unsigned bits) {
 		if (is_padded_bitfield && bitfield_size && (bitfield_bits + bits > 8 * bitfield_size || size != bitfield_size)) {
 			is_padding = true;
-			file_integer(bitfield_size, 8 * bitfield_size - bitfield_bits, 0);
+			file_integer<Generate>(bitfield_size, 8 * bitfield_size - bitfield_bits, 0);
 			is_padding = false;
 		}
 		unsigned start_pos = file_pos;
-		assert_cond(file_pos + size <= MAX_FILE_SIZE, "file size exceeded MAX_FILE_SIZE");
+		reserve_file(file_pos + size);
 		assert_cond(!has_size || file_pos + size <= file_size, "file size exceeded known size");
 		value &= (1LLU << bits) - 1LLU;
 		unsigned new_bits = bits;
@@ -188,12 +389,12 @@ class file_accessor {
 				mask <<= bits_pos;
 			}
 			unsigned index = file_pos + byte_pos;
-			if (!generate)
+			if constexpr (!Generate)
 				assert_cond(index < final_file_size, "reading past the end of file");
 			unsigned char old = file_buffer[index];
 			file_buffer[index] &= ~mask;
 			file_buffer[index] |= c;
-			if (!generate)
+			if constexpr (!Generate)
 				assert_cond(file_buffer[index] == old, "parsed wrong file contents");
 			new_bits -= write_bits;
 			bitfield_bits += write_bits;
@@ -208,10 +409,14 @@ class file_accessor {
 
 		if (file_size < file_pos)
 			file_size = file_pos;
+		if (!checksum_ranges.empty() && !lookahead)
+			update_checksums(start_pos);
 		if (is_padding)
 			return;
-		if (!generate && parsed_file_size < file_pos)
-			parsed_file_size = file_pos;
+		if constexpr (!Generate) {
+			if (parsed_file_size < file_pos)
+				parsed_file_size = file_pos;
+		}
 		if (!get_parse_tree)
 			return;
 		if (start_pos < generator_stack.back().min)
@@ -221,17 +426,37 @@ class file_accessor {
 			generator_stack.back().max = end;
 	}
 
+	// Fold the bytes written since the last call into the running
+	// checksums, while they are still in cache.  A write at start_pos that
+	// overlaps bytes already folded makes the checksum dirty; it is then
+	// recomputed at the end.
+	__attribute__((noinline)) void update_checksums(unsigned start_pos) {
+		for (checksum_range& r : checksum_ranges) {
+			if (!r.active || r.dirty || file_pos <= r.start)
+				continue;
+			if (start_pos < r.done) {
+				r.dirty = true;
+				continue;
+			}
+			unsigned unit = ff_checksum_unit(r.type);
+			unsigned end = r.done + (file_pos - r.done) / unit * unit;
+			r.state = ff_checksum_update(r.type, r.state, file_buffer + r.done, end - r.done);
+			r.done = end;
+		}
+	}
+
+	template<bool Generate>
 	void write_file(const void *buf, size_t size) {
 		if (bitfield_bits) {
 			is_padding = true;
-			file_integer(bitfield_size, 8 * bitfield_size - bitfield_bits, 0);
+			file_integer<Generate>(bitfield_size, 8 * bitfield_size - bitfield_bits, 0);
 			is_padding = false;
 		}
 		unsigned start_pos = file_pos;
 		file_pos += size;
-		assert_cond(file_pos <= MAX_FILE_SIZE, "file size exceeded MAX_FILE_SIZE");
+		reserve_file(file_pos);
 		assert_cond(!has_size || file_pos <= file_size, "file size exceeded known size");
-		if (generate) {
+		if constexpr (Generate) {
 			memcpy(file_buffer + start_pos, buf, size);
 		} else {
 			assert_cond(file_pos <= final_file_size, "reading past the end of file");
@@ -241,6 +466,9 @@ class file_accessor {
 		if (file_size < file_pos)
 			file_size = file_pos;
 
+		if (!checksum_ranges.empty() && !lookahead)
+			update_checksums(start_pos);
+
 		if (lookahead) {
 			has_bitmap = true;
 			unsigned original_pos = file_pos - size;
@@ -250,8 +478,10 @@ class file_accessor {
 
 		if (is_padding || lookahead)
 			return;
-		if (!generate && parsed_file_size < file_pos)
-			parsed_file_size = file_pos;
+		if constexpr (!Generate) {
+			if (parsed_file_size < file_pos)
+				parsed_file_size = file_pos;
+		}
 		if (!get_parse_tree)
 			return;
 		if (start_pos < generator_stack.back().min)
@@ -275,19 +505,140 @@ public:
 	bool generate = true;
 	bool lookahead = false;
 	bool is_padding = false;
+	unsigned file_capacity = MAX_FILE_SIZE;
+	// file_buffer may hold nonzero bytes up to here (see ff_parse())
+	unsigned file_used = MAX_FILE_SIZE;
+	unsigned rand_capacity = MAX_RAND_SIZE;
+	unsigned max_file_size = MAX_FILE_SIZE_LIMIT;
+	unsigned max_rand_size = MAX_RAND_SIZE_LIMIT;
+	bool external_buffers = false;
+	bool random_decisions = false;
+	int decision_tail = FF_TAIL_FAIL;
+	wyrand decision_rng;
+	// Checksums registered with ChecksumStart()
+	std::vector<checksum_range> checksum_ranges;
 
 	file_accessor() : bitmap(MAX_FILE_SIZE) {
 		file_buffer = new unsigned char[MAX_FILE_SIZE];
 		::rand_buffer = new unsigned char[MAX_RAND_SIZE];
 		if (getenv("DONT_BE_EVIL"))
 			dont_be_evil = true;
+		if (getenv("FF_DECISION_TAIL") && strcmp(getenv("FF_DECISION_TAIL"), "random") == 0)
+			decision_tail = FF_TAIL_RANDOM;
+		if (getenv("FF_MAX_FILE_SIZE"))
+			max_file_size = std::max(strtoul(getenv("FF_MAX_FILE_SIZE"), NULL, 0), (unsigned long) MAX_FILE_SIZE);
+		if (getenv("FF_MAX_RAND_SIZE"))
+			max_rand_size = std::max(strtoul(getenv("FF_MAX_RAND_SIZE"), NULL, 0), (unsigned long) MAX_RAND_SIZE);
 	}
 	
 	~file_accessor() {
+		if (external_buffers)
+			return;
 		delete[] file_buffer;
 		delete[] ::rand_buffer;
 	}
 
+	// Use caller-owned memory (e.g. a shared memory region) of file_limit
+	// and rand_limit bytes as file and decision buffers.  The buffers still
+	// grow on demand up to these limits, but in place.
+	void use_buffers(unsigned char* file, unsigned file_limit, unsigned char* rand, unsigned rand_limit) {
+		if (!external_buffers) {
+			delete[] file_buffer;
+			delete[] ::rand_buffer;
+		}
+		external_buffers = true;
+		file_buffer = file;
+		rand_buffer = ::rand_buffer = rand;
+		max_file_size = file_limit;
+		max_rand_size = rand_limit;
+		file_capacity = std::min(file_capacity, file_limit);
+		rand_capacity = std::min(rand_capacity, rand_limit);
+		file_used = file_limit;
+		bitmap.resize(file_capacity);
+	}
+
+	void reserve_file(unsigned long long size) {
+		if (size > file_capacity)
+			grow_file(size);
+	}
+
+	// Reallocate file_buffer (and the lookahead bitmap) to hold at least
+	// size bytes.  The new tail is zeroed, like the tail of a parsed file.
+	// External buffers are extended in place and keep their contents.
+	__attribute__((noinline)) void grow_file(unsigned long long size) {
+		assert_cond(size <= max_file_size, "file size exceeded max_file_size");
+		unsigned long long capacity = file_capacity;
+		while (capacity < size)
+			capacity *= 2;
+		if (capacity > max_file_size)
+			capacity = max_file_size;
+		if (external_buffers) {
+			bitmap.resize(capacity);
+			file_capacity = capacity;
+			return;
+		}
+		unsigned char* buffer = new unsigned char[capacity];
+		memcpy(buffer, file_buffer, file_capacity);
+		memset(buffer + file_capacity, 0, capacity - file_capacity);
+		delete[] file_buffer;
+		file_buffer = buffer;
+		bitmap.resize(capacity);
+		file_capacity = capacity;
+	}
+
+	// Reallocate the decision buffer owned by the accessor (::rand_buffer)
+	// to hold at least size bytes, keeping the decisions made so far.
+	__attribute__((noinline)) void grow_rand(unsigned long long size) {
+		assert_cond(size <= max_rand_size, "random size exceeded max_rand_size");
+		unsigned long long capacity = rand_capacity;
+		while (capacity < size)
+			capacity *= 2;
+		if (capacity > max_rand_size)
+			capacity = max_rand_size;
+		if (external_buffers) {
+			rand_capacity = capacity;
+			return;
+		}
+		unsigned char* buffer = new unsigned char[capacity];
+		memcpy(buffer, ::rand_buffer, rand_capacity);
+		if (rand_buffer == ::rand_buffer)
+			rand_buffer = buffer;
+		delete[] ::rand_buffer;
+		::rand_buffer = buffer;
+		rand_capacity = capacity;
+	}
+
+	// Append random decisions to ::rand_buffer until at least size bytes
+	// are available.  Decisions are drawn in blocks of RANDOM_BLOCK bytes,
+	// so the stream only depends on the seed, not on how it is consumed.
+	// With FF_TAIL_RANDOM, the decisions given to seed() are first moved
+	// to ::rand_buffer, and their checksum seeds the stream that follows
+	// them, so that equal inputs still give equal files.
+	__attribute__((noinline)) void fill_random(unsigned long long size) {
+		if (!random_decisions) {
+			uint64_t s = crc32(0, rand_buffer, rand_size) | (uint64_t) rand_size << 32;
+			if (rand_buffer != ::rand_buffer) {
+				if (rand_size > rand_capacity)
+					grow_rand(rand_size);
+				memmove(::rand_buffer, rand_buffer, rand_size);
+				rand_buffer = ::rand_buffer;
+			}
+			random_decisions = true;
+			decision_rng = wyrand(s);
+		}
+		unsigned long long end = (size + RANDOM_BLOCK - 1) / RANDOM_BLOCK * RANDOM_BLOCK;
+		if (end > max_rand_size)
+			end = max_rand_size;
+		if (end > rand_capacity)
+			grow_rand(end);
+		while (rand_size < end) {
+			uint64_t v = decision_rng();
+			unsigned n = std::min(end - rand_size, (unsigned long long) sizeof(v));
+			memcpy(rand_buffer + rand_size, &v, n);
+			rand_size += n;
+		}
+	}
+
 	bool set_evil_bit(bool allow) {
 		bool old = allow_evil_values;
 		allow_evil_values = allow;
@@ -296,11 +647,11 @@ public:
 
 	std::function<bool (unsigned char*)> evil_parse;
 
-	bool evil(std::function<bool (unsigned char*)>& evil_parse) {
-		if (!generate)
-			parse = [&evil_parse](unsigned char* file_buf) -> long long { return evil_parse(file_buf) ? 127 : 0; };
-		bool is_evil = rand_int(127 + allow_evil_values, parse) == 127;
-		assert_cond(!(!generate && !allow_evil_values && rand_buffer[rand_pos-1] == 127), "Evil bit is disabled, but an evil decision is required to parse this file");
+	template<bool Generate, typename EvilParse>
+	bool evil(EvilParse&& evil_parse) {
+		bool is_evil = rand_int<Generate>(127 + allow_evil_values, [&evil_parse](unsigned char* file_buf) -> long long { return evil_parse(file_buf) ? 127 : 0; }) == 127;
+		if constexpr (!Generate)
+			assert_cond(!(!allow_evil_values && rand_buffer[rand_pos-1] == 127), "Evil bit is disabled, but an evil decision is required to parse this file");
 		return is_evil;
 	}
 
@@ -313,8 +664,39 @@ public:
 				mutatedDecision = true;
 			}
 	}
-	
-	long long rand_int(unsigned long long x, std::function<long long (unsigned char*)>& parse) {
+
+	// Consume one decision of type T.  The parse functor is only invoked
+	// when parsing, so generation never calls (or type-erases) it.
+	template<bool Generate, typename T, typename Parse>
+	T decision(Parse& parse) {
+		if (rand_pos + sizeof(T) > rand_size) {
+			// When generating from a seed or with FF_TAIL_RANDOM, draw more
+			// random decisions; when parsing into our own buffer, make room
+			// for more decisions
+			if constexpr (Generate) {
+				if (random_decisions || decision_tail == FF_TAIL_RANDOM)
+					fill_random(rand_pos + sizeof(T));
+			} else {
+				if (rand_buffer == ::rand_buffer) {
+					grow_rand(rand_pos + sizeof(T));
+					rand_size = rand_capacity;
+				}
+			}
+			assert_cond(rand_pos + sizeof(T) <= rand_size, "random size exceeded rand_size");
+		}
+		T* p = (T*) &rand_buffer[rand_pos];
+		if constexpr (!Generate) {
+			*p = parse(&file_buffer[file_pos]);
+		}
+		rand_pos += sizeof(T);
+		checkIfMutated();
+		return *p;
+	}
+
+	// Parse may be any callable taking the current file position and
+	// returning the decision value, e.g. a lambda or the parse member.
+	template<bool Generate, typename Parse>
+	long long rand_int(unsigned long long x, Parse&& parse) {
 		unsigned long long max = x-1;
 		if (!max)
 			return 0;
@@ -329,59 +711,30 @@ public:
 				following_is_optional = lookahead;
 				is_following = false;
 				if (get_all_chunks && lookahead) {
-					deletable_chunks[file_index].emplace_back(file_index, rand_start, rand_end, variable_types[chunk_name].c_str(), chunk_name);
+					found_chunks.deletable_chunks.emplace_back(file_index, rand_start, rand_end, chunk_type, chunk_name);
 				}
 			}
 		}
-		if (!(max>>8)) {
-			assert_cond(rand_pos + 1 <= rand_size, "random size exceeded rand_size");
-			unsigned char* p = (unsigned char*) &rand_buffer[rand_pos];
-			if (!generate) {
-				*p = parse(&file_buffer[file_pos]);
-			}
-			++rand_pos;
-			checkIfMutated();
-			return (*p) % x;
-		}
-		if (!(max>>16)) {
-			assert_cond(rand_pos + 2 <= rand_size, "random size exceeded rand_size");
-			unsigned short* p = (unsigned short*) &rand_buffer[rand_pos];
-			if (!generate) {
-				*p = parse(&file_buffer[file_pos]);
-			}
-			rand_pos += 2;
-			checkIfMutated();
-			return (*p) % x;
-		}
-		if (!(max>>32)) {
-			assert_cond(rand_pos + 4 <= rand_size, "random size exceeded rand_size");
-			unsigned* p = (unsigned*) &rand_buffer[rand_pos];
-			if (!generate) {
-				*p = parse(&file_buffer[file_pos]);
-			}
-			rand_pos += 4;
-			checkIfMutated();
-			return (*p) % x;
-		}
-		assert_cond(rand_pos + 8 <= rand_size, "random size exceeded rand_size");
-		unsigned long long* p = (unsigned long long*) &rand_buffer[rand_pos];
-		if (!generate) {
-			*p = parse(&file_buffer[file_pos]);
-		}
-		rand_pos += 8;
-		checkIfMutated();
+		if (!(max>>8))
+			return decision<Generate, unsigned char>(parse) % x;
+		if (!(max>>16))
+			return decision<Generate, unsigned short>(parse) % x;
+		if (!(max>>32))
+			return decision<Generate, unsigned>(parse) % x;
+		unsigned long long v = decision<Generate, unsigned long long>(parse);
 		if (!x)
-			return *p;
-		return (*p) % x;
+			return v;
+		return v % x;
 	}
 
+	template<bool Generate>
 	void finish() {
 		if (bitfield_bits) {
 			is_padding = true;
-			file_integer(bitfield_size, 8 * bitfield_size - bitfield_bits, 0);
+			file_integer<Generate>(bitfield_size, 8 * bitfield_size - bitfield_bits, 0);
 			is_padding = false;
 		}
-		if (!generate) {
+		if constexpr (!Generate) {
 			assert_cond(file_size == final_file_size, "unparsed bytes left at the end of file");
 			if (parsed_file_size != final_file_size && (debug_print || print_errors))
 				fprintf(stderr, "Warning: unparsed (lookahead) bytes left at the end of file\n");
@@ -392,30 +745,55 @@ public:
 				chunk_name = "file";
 			}
 			if (get_parse_tree && get_all_chunks && rand_last != UINT_MAX) {
-				insertion_points[file_index].emplace_back(rand_last, "File", "file");
+				found_chunks.insertion_points.emplace_back(rand_last, "File", "file");
 			}
 		}
 	}
 
+	// Choose a file position from start on for an object of the given size.
+	// Generation keeps positions within MAX_FILE_SIZE.  Parsing records an
+	// offset beyond that range as POSITION_ESCAPE followed by the exact
+	// offset, so that it decodes back verbatim; random decisions hit the
+	// escape once in 2^32 draws.
+	template<bool Generate, typename Parse>
+	unsigned long long rand_position(unsigned long long start, unsigned size, Parse&& parse) {
+		unsigned long long range = start + size < MAX_FILE_SIZE ? MAX_FILE_SIZE + 1 - size - start : 1;
+		unsigned long long offset = rand_int<Generate>(1ULL << 32, [&](unsigned char* file_buf) -> long long {
+			long long offset = parse(file_buf);
+			return offset >= 0 && (unsigned long long) offset < range ? offset : POSITION_ESCAPE;
+		});
+		if (offset != POSITION_ESCAPE)
+			return start + offset % range;
+		offset = rand_int<Generate>(1ULL << 32, parse);
+		if (start + size <= max_file_size && offset <= max_file_size - size - start)
+			return start + offset;
+		return start + offset % range;
+	}
+
+	template<bool Generate>
 	std::string rand_bytes(int size) {
 		std::string result;
 		for (int i = 0; i < size; ++i) {
-			unsigned char byte = rand_int(256, parse);
+			unsigned char byte = rand_int<Generate>(256, parse);
 			result += byte;
 		}
 		return result;
 	}
 
+
 	void seed(unsigned char* b, unsigned rsize, unsigned fsize) {
 		rand_buffer = b;
 		rand_size = rsize;
+		random_decisions = false;
 		rand_pos = 0;
 		file_pos = 0;
+		file_used = std::max(file_used, std::max(file_size, final_file_size));
 		file_size = 0;
 		final_file_size = fsize;
 		parsed_file_size = 0;
 		rand_prev = 0;
 		rand_last = UINT_MAX;
+		checksum_ranges.clear();
 		following_is_optional = false;
 		is_following = false;
 
@@ -435,18 +813,29 @@ public:
 		if (get_parse_tree) {
 			generator_stack.erase(generator_stack.begin() + 1, generator_stack.end());
 			generator_stack[0].clear();
+			child_counts.clear();
 		}
+		if (parse_tree.enabled)
+			parse_tree.reset();
 	}
 
+	// Take all decisions from a wyrand stream seeded with s instead of a
+	// given buffer.  Only the decisions consumed are ever drawn; they end
+	// up in ::rand_buffer, where copy_rand() and save_output() find them.
+	void seed_random(uint64_t s) {
+		seed(::rand_buffer, 0, 0);
+		random_decisions = true;
+		decision_rng = wyrand(s);
+	}
+
+	template<bool Generate>
 	int feof(double p) {
 		if (file_pos < file_size)
 			return 0;
 		if (has_size)
 			return 1;
 		lookahead = true;
-		if (!generate)
-			parse = [this](unsigned char* file_buf) -> long long { return file_pos == final_file_size ? 255 : 0; };
-		int is_feof = (rand_int(256, parse) >= 255 * (1.0 - p));
+		int is_feof = (rand_int<Generate>(256, [this](unsigned char* file_buf) -> long long { return file_pos == final_file_size ? 255 : 0; }) >= 255 * (1.0 - p));
 		lookahead = false;
 		if (is_feof)
 			has_size = true;
@@ -454,8 +843,8 @@ public:
 	}
 
 	template<typename T>
-	bool is_compatible_integer(unsigned size, T& v) {
-		unsigned char* p = (unsigned char*) &v;
+	bool is_compatible_integer(unsigned size, const T& v) {
+		const unsigned char* p = (const unsigned char*) &v;
 		for (unsigned i = 0; i < size; ++i) {
 			if (bitmap[file_pos + i]) {
 				unsigned index = is_big_endian ? size - 1 - i : i;
@@ -466,11 +855,12 @@ public:
 		return true;
 	}
 
-	template<typename T>
-	long long file_integer(unsigned size, unsigned bits, std::vector<T>& known) {
+	template<bool Generate, typename T>
+	long long file_integer(unsigned size, unsigned bits, value_span<T> known, const known_index<T>* index = NULL) {
 		assert_cond(0 < size && size <= 8, "sizeof integer invalid");
-		assert_cond(file_pos + size <= MAX_FILE_SIZE, "file size exceeded MAX_FILE_SIZE");
-		std::vector<T> compatible;
+		reserve_file(file_pos + size);
+		static thread_local std::vector<T> compatible;
+		compatible.clear();
 		bool match = false;
 		if (has_bitmap) {
 			for (unsigned i = 0; i < size; ++i) {
@@ -481,121 +871,121 @@ public:
 			}
 			if (match) {
 				assert_cond(bits == 0, "bitfield lookahead not implemented");
-				for (T& v : known) {
+				for (const T& v : known) {
 					if (is_compatible_integer(size, v))
 						compatible.push_back(v);
 				}
+				index = NULL;
 			}
 		}
-		std::vector<T>& good = match ? compatible : known;
+		value_span<T> good = match ? value_span<T>(compatible) : known;
+		known_index<T> linear;
+		const known_index<T>& lookup = index ? *index : linear;
 
-		if (!generate)
-			evil_parse = [&size, &bits, &good, this](unsigned char* file_buf) -> bool {
-				T value = (T)parse_integer(file_buf, size, bits);
-				return std::find(good.begin(), good.end(), value) == good.end();
-			};
+		auto evil_parse = [&size, &bits, &good, &lookup, this](unsigned char* file_buf) -> bool {
+			T value = (T)parse_integer(file_buf, size, bits);
+			return lookup.find(good, value) == (long long) good.size();
+		};
 
-		if ((match && compatible.empty()) || evil(evil_parse)) {
-			return file_integer(size, bits);
+		if ((match && compatible.empty()) || evil<Generate>(evil_parse)) {
+			return file_integer<Generate>(size, bits, 1);
 		}
 
-		if (!generate)
-			parse = [&size, &bits, &good, this](unsigned char* file_buf) -> long long {
-				T value = (T)parse_integer(file_buf, size, bits);
-				return std::find(good.begin(), good.end(), value) - good.begin();
-			};
+		auto index_parse = [&size, &bits, &good, &lookup, this](unsigned char* file_buf) -> long long {
+			T value = (T)parse_integer(file_buf, size, bits);
+			return lookup.find(good, value);
+		};
 
-		T value = good[rand_int(good.size(), parse)];
+		T value = good[rand_int<Generate>(good.size(), index_parse)];
 		T newvalue = value;
 		if (bits) {
 			value = (T)((unsigned long long)value & ((1LLU << bits) - 1LLU));
-			write_file_bits(value, size, bits);
+			write_file_bits<Generate>(value, size, bits);
 		} else {
 			swap_bytes(&newvalue, size);
-			write_file(&newvalue, size);
+			write_file<Generate>(&newvalue, size);
 		}
 
 		return value;
 	}
 
+	template<bool Generate, typename T>
+	long long file_integer(unsigned size, unsigned bits, const std::vector<T>& known) {
+		return file_integer<Generate>(size, bits, value_span<T>(known));
+	}
+
+	template<bool Generate, typename T>
+	long long file_integer(unsigned size, unsigned bits, const std::vector<T>& known, const known_index<T>& index) {
+		return file_integer<Generate>(size, bits, value_span<T>(known), &index);
+	}
+
+	template<bool Generate>
 	long long file_integer(unsigned size, unsigned bits, int small = 1) {
 		assert_cond(0 < size && size <= 8, "sizeof integer invalid");
-		assert_cond(file_pos + size <= MAX_FILE_SIZE, "file size exceeded MAX_FILE_SIZE");
+		reserve_file(file_pos + size);
 
 		unsigned long long range = bits ? bits : 8*size;
 		range = range == 64 ? 0 : 1LLU << range;
 		long long value;
 
+		auto value_parse = [&size, &bits, this](unsigned char* file_buf) -> long long {
+			return parse_integer(file_buf, size, bits);
+		};
+
 		if (small == 0) {
-			if (!generate)
-				parse = [&size, &bits, this](unsigned char* file_buf) -> long long {
-					return parse_integer(file_buf, size, bits);
-				};
-			value = rand_int(range, parse);
+			value = rand_int<Generate>(range, value_parse);
 		} else if (small == 1 || (small >= 2 && integer_ranges[small-2][1] == INT_MAX)) {
 			int min = 0;
 			if (small >= 2)
 				min = integer_ranges[small-2][0];
-			std::function<long long (unsigned char*)> choice_parse;
-			if (!generate) {
-				choice_parse = [&size, &bits, &min, this](unsigned char* file_buf) -> long long {
-					unsigned long long value = parse_integer(file_buf, size, bits) - min;
-					if (value > 0 && value <= 1<<4)
-						return 0;
-					if (value < 1<<8)
-						return 256 - 32;
-					if (value < 1<<16)
-						return 256 - 8;
-					return 256 - 2;
-				};
-				parse = [&size, &bits, &min, this](unsigned char* file_buf) -> long long {
-					long long value = parse_integer(file_buf, size, bits);
-					value -= min;
-					return value;
-				};
-			}
-			int s = rand_int(256, choice_parse);
+			auto choice_parse = [&size, &bits, &min, this](unsigned char* file_buf) -> long long {
+				unsigned long long value = parse_integer(file_buf, size, bits) - min;
+				if (value > 0 && value <= 1<<4)
+					return 0;
+				if (value < 1<<8)
+					return 256 - 32;
+				if (value < 1<<16)
+					return 256 - 8;
+				return 256 - 2;
+			};
+			auto offset_parse = [&size, &bits, &min, this](unsigned char* file_buf) -> long long {
+				long long value = parse_integer(file_buf, size, bits);
+				value -= min;
+				return value;
+			};
+			int s = rand_int<Generate>(256, choice_parse);
 			if (s >= 256 - 2)
-				value = rand_int(range, parse);
+				value = rand_int<Generate>(range, offset_parse);
 			else if (s >= 256 - 8)
-				value = rand_int(1<<16, parse);
+				value = rand_int<Generate>(1<<16, offset_parse);
 			else if (s >= 256 - 32)
-				value = rand_int(1<<8, parse);
+				value = rand_int<Generate>(1<<8, offset_parse);
 			else {
-				if (!generate)
-					parse = [&size, &bits, &min, this](unsigned char* file_buf) -> long long {
-						long long value = parse_integer(file_buf, size, bits);
-						value -= min + 1;
-						return value;
-					};
-				value = 1+rand_int(1<<4, parse);
+				value = 1+rand_int<Generate>(1<<4, [&size, &bits, &min, this](unsigned char* file_buf) -> long long {
+					long long value = parse_integer(file_buf, size, bits);
+					value -= min + 1;
+					return value;
+				});
 			}
 			value += min;
 		} else {
 			int min = integer_ranges[small-2][0];
 			int max = integer_ranges[small-2][1];
-			if (!generate)
-				evil_parse = [&size, &bits, &min, &max, this](unsigned char* file_buf) -> bool {
-					long long value = parse_integer(file_buf, size, bits);
-					if (value >= min && value <= max)
-						return false;
-					return true;
-				};
-
-			if (evil(evil_parse)) {
-				if (!generate)
-					parse = [&size, &bits, this](unsigned char* file_buf) -> long long {
-						return parse_integer(file_buf, size, bits);
-					};
-				value = rand_int(range, parse);
+			auto evil_parse = [&size, &bits, &min, &max, this](unsigned char* file_buf) -> bool {
+				long long value = parse_integer(file_buf, size, bits);
+				if (value >= min && value <= max)
+					return false;
+				return true;
+			};
+
+			if (evil<Generate>(evil_parse)) {
+				value = rand_int<Generate>(range, value_parse);
 			} else {
-				if (!generate)
-					parse = [&size, &bits, &min, this](unsigned char* file_buf) -> long long {
-						long long value = parse_integer(file_buf, size, bits);
-						value -= min;
-						return value;
-					};
-				value = min + rand_int(max + 1 - min, parse);
+				value = min + rand_int<Generate>(max + 1 - min, [&size, &bits, &min, this](unsigned char* file_buf) -> long long {
+					long long value = parse_integer(file_buf, size, bits);
+					value -= min;
+					return value;
+				});
 			}
 		}
 		if (has_bitmap) {
@@ -611,17 +1001,17 @@ public:
 		long long newvalue = value;
 		if (bits) {
 			value &= (1LLU << bits) - 1LLU;
-			write_file_bits(value, size, bits);
+			write_file_bits<Generate>(value, size, bits);
 		} else {
 			swap_bytes(&newvalue, size);
-			write_file(&newvalue, size);
+			write_file<Generate>(&newvalue, size);
 		}
 
 		return value;
 	}
 
-	bool is_compatible_string(std::string& v) {
-		unsigned char* p = (unsigned char*) v.c_str();
+	bool is_compatible_string(const std::string& v) {
+		const unsigned char* p = (const unsigned char*) v.c_str();
 		for (unsigned i = 0; i < v.length(); ++i) {
 			if (bitmap[file_pos + i] && p[i] != file_buffer[file_pos + i])
 				return false;
@@ -629,10 +1019,12 @@ public:
 		return true;
 	}
 	
-	std::string file_string(std::vector<std::string>& known) {
+	template<bool Generate>
+	std::string file_string(value_span<std::string> known, const known_index<std::string>* index = NULL) {
 		int size = known[0].length();
-		assert_cond(file_pos + size <= MAX_FILE_SIZE, "file size exceeded MAX_FILE_SIZE");
-		std::vector<std::string> compatible;
+		reserve_file(file_pos + size);
+		static thread_local std::vector<std::string> compatible;
+		compatible.clear();
 		bool match = false;
 		if (has_bitmap) {
 			for (int i = 0; i < size; ++i) {
@@ -642,71 +1034,70 @@ public:
 				}
 			}
 			if (match) {
-				for (std::string& v : known) {
+				for (const std::string& v : known) {
 					if (is_compatible_string(v))
 						compatible.push_back(v);
 				}
+				index = NULL;
 			}
 		}
-		std::vector<std::string>& good = match ? compatible : known;
+		value_span<std::string> good = match ? value_span<std::string>(compatible) : known;
+		known_index<std::string> linear;
+		const known_index<std::string>& lookup = index ? *index : linear;
 
-		if (!generate)
-			evil_parse = [&good](unsigned char* file_buf) -> bool {
-				std::string value((char*) file_buf, good[0].length());
-				return std::find(good.begin(), good.end(), value) == good.end();
-			};
-		if ((match && compatible.empty()) || evil(evil_parse)) {
-			return file_string(size);
+		auto evil_parse = [&good, &lookup](unsigned char* file_buf) -> bool {
+			std::string_view value((char*) file_buf, good[0].length());
+			return lookup.find(good, value) == (long long) good.size();
+		};
+		if ((match && compatible.empty()) || evil<Generate>(evil_parse)) {
+			return file_string<Generate>(size);
 		}
-		if (!generate)
-			parse = [&good](unsigned char* file_buf) -> long long {
-				std::string value((char*) file_buf, good[0].length());
-				return std::find(good.begin(), good.end(), value) - good.begin();
-			};
-		std::string value = good[rand_int(good.size(), parse)];
+		auto index_parse = [&good, &lookup](unsigned char* file_buf) -> long long {
+			std::string_view value((char*) file_buf, good[0].length());
+			return lookup.find(good, value);
+		};
+		std::string value = good[rand_int<Generate>(good.size(), index_parse)];
 		ssize_t len = value.length();
-		write_file(value.c_str(), len);
+		write_file<Generate>(value.c_str(), len);
 		return value;
 	}
+
+	template<bool Generate>
+	std::string file_string(value_span<std::string> known, const known_index<std::string>& index) {
+		return file_string<Generate>(known, &index);
+	}
 	
+	template<bool Generate>
 	std::string file_string(int size = 0) {
 		assert_cond(size >= 0, "negative string length");
-		assert_cond(file_pos + size <= MAX_FILE_SIZE, "file size exceeded MAX_FILE_SIZE");
-		if (!generate)
-			parse = [&size](unsigned char* file_buf) -> long long {
-				int len = size ? size : INT_MAX;
-				for (int i = 0; i < len && (size || file_buf[i]); ++i)
-					if (file_buf[i] < 32 || file_buf[i] >= 127)
-						return 15;
-				return 0;
-			};
-		int choice = rand_int(16, parse);
+		reserve_file(file_pos + size);
+		int choice = rand_int<Generate>(16, [&size](unsigned char* file_buf) -> long long {
+			int len = size ? size : INT_MAX;
+			for (int i = 0; i < len && (size || file_buf[i]); ++i)
+				if (file_buf[i] < 32 || file_buf[i] >= 127)
+					return 15;
+			return 0;
+		});
 		if (choice < 14) {
-			return file_ascii_string(size);
+			return file_ascii_string<Generate>(size);
 		} else if (choice == 14) {
-			return file_latin1_string(size);
+			return file_latin1_string<Generate>(size);
 		}
 		ssize_t len = size;
-		if (!len) {
-			if (!generate)
-				parse = [](unsigned char* file_buf) -> long long { return strlen((char*)file_buf); };
-			len = rand_int(80, parse);
-		}
+		if (!len)
+			len = rand_int<Generate>(80, [](unsigned char* file_buf) -> long long { return strlen((char*)file_buf); });
 
 		string_buf.resize(len + 1);
 		for (int i = 0; i < len; ++i) {
 			if (size == 0) {
-				if (!generate)
-					parse = [&i](unsigned char* file_buf) -> long long { return file_buf[i] - 1; };
-				string_buf[i] = rand_int(255, parse) + 1;
+				string_buf[i] = rand_int<Generate>(255, [&i](unsigned char* file_buf) -> long long { return file_buf[i] - 1; }) + 1;
 			} else {
-				if (!generate)
-					parse = [&i](unsigned char* file_buf) -> long long { return file_buf[i]; };
-				string_buf[i] = rand_int(256, parse);
+				string_buf[i] = rand_int<Generate>(256, [&i](unsigned char* file_buf) -> long long { return file_buf[i]; });
 			}
 		}
 		string_buf[len] = '\0';
 		if (has_bitmap) {
+			reserve_file(file_pos + len);
 			for (int i = 0; i < len; ++i) {
 				if (bitmap[file_pos + i]) {
 					string_buf[i] = file_buffer[file_pos + i];
@@ -716,28 +1107,25 @@ public:
 		std::string value(string_buf.c_str(), len);
 		if (size == 0)
 			++len;
-		write_file(value.c_str(), len);
+		write_file<Generate>(value.c_str(), len);
 		return value;
 	}
 
-	std::string file_ascii_string(int size = 0) {
+	template<bool Generate>
+	std::string file_ascii_string(int size) {
 		assert_cond(size >= 0, "negative string length");
-		assert_cond(file_pos + size <= MAX_FILE_SIZE, "file size exceeded MAX_FILE_SIZE");
+		reserve_file(file_pos + size);
 		ssize_t len = size;
-		if (!len) {
-			if (!generate)
-				parse = [](unsigned char* file_buf) -> long long { return strlen((char*)file_buf); };
-			len = rand_int(80, parse);
-		}
+		if (!len)
+			len = rand_int<Generate>(80, [](unsigned char* file_buf) -> long long { return strlen((char*)file_buf); });
 
 		string_buf.resize(len + 1);
 		for (int i = 0; i < len; ++i) {
-			if (!generate)
-				parse = [&i](unsigned char* file_buf) -> long long { return file_buf[i] - 32; };
-			string_buf[i] = rand_int(95, parse) + 32;
+			string_buf[i] = rand_int<Generate>(95, [&i](unsigned char* file_buf) -> long long { return file_buf[i] - 32; }) + 32;
 		}
 		string_buf[len] = '\0';
 		if (has_bitmap) {
+			reserve_file(file_pos + len);
 			for (int i = 0; i < len; ++i) {
 				if (bitmap[file_pos + i]) {
 					string_buf[i] = file_buffer[file_pos + i];
@@ -747,30 +1135,27 @@ public:
 		std::string value(string_buf.c_str(), len);
 		if (size == 0)
 			++len;
-		write_file(value.c_str(), len);
+		write_file<Generate>(value.c_str(), len);
 		return value;
 	}
 
-	std::string file_latin1_string(int size = 0) {
+	template<bool Generate>
+	std::string file_latin1_string(int size) {
 		assert_cond(size >= 0, "negative string length");
-		assert_cond(file_pos + size <= MAX_FILE_SIZE, "file size exceeded MAX_FILE_SIZE");
+		reserve_file(file_pos + size);
 		ssize_t len = size;
-		if (!len) {
-			if (!generate)
-				parse = [](unsigned char* file_buf) -> long long { return strlen((char*)file_buf); };
-			len = rand_int(80, parse);
-		}
+		if (!len)
+			len = rand_int<Generate>(80, [](unsigned char* file_buf) -> long long { return strlen((char*)file_buf); });
 
 		string_buf.resize(len + 1);
 		for (int i = 0; i < len; ++i) {
-			if (!generate)
-				parse = [&i](unsigned char* file_buf) -> long long { return file_buf[i] >= 161 ? file_buf[i] - 66 : file_buf[i] - 32; };
-			string_buf[i] = rand_int(190, parse) + 32;
+			string_buf[i] = rand_int<Generate>(190, [&i](unsigned char* file_buf) -> long long { return file_buf[i] >= 161 ? file_buf[i] - 66 : file_buf[i] - 32; }) + 32;
 			if (string_buf[i] >= 127)
 				string_buf[i] += 34;
 		}
 		string_buf[len] = '\0';
 		if (has_bitmap) {
+			reserve_file(file_pos + len);
 			for (int i = 0; i < len; ++i) {
 				if (bitmap[file_pos + i]) {
 					string_buf[i] = file_buffer[file_pos + i];
@@ -780,7 +1165,7 @@ public:
 		std::string value(string_buf.c_str(), len);
 		if (size == 0)
 			++len;
-		write_file(value.c_str(), len);
+		write_file<Generate>(value.c_str(), len);
 		return value;
 	}
 };
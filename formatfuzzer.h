@@ -1,11 +1,30 @@
+// Initial sizes of the decision and file buffers.  Generation also uses
+// MAX_FILE_SIZE as the largest file size it invents on its own.
 #define MAX_RAND_SIZE 131072
 #define MAX_FILE_SIZE 65536
 
+// Buffers grow on demand up to these limits, which can be overridden with
+// the FF_MAX_RAND_SIZE and FF_MAX_FILE_SIZE environment variables.
+#define MAX_RAND_SIZE_LIMIT (1U << 25)
+#define MAX_FILE_SIZE_LIMIT (1U << 24)
+
+// Random decisions are drawn from the seed in blocks of this many bytes
+#define RANDOM_BLOCK 256
+
+// What generation does when it runs out of given decisions (see
+// ff_set_decision_tail() and the FF_DECISION_TAIL environment variable)
+#define FF_TAIL_FAIL 0		// the generation fails
+#define FF_TAIL_RANDOM 1	// random decisions follow, seeded from the given ones
+
 #include <vector>
+#include <stdint.h>
 
 
+// Chunk types are interned when a file is added to the chunk corpus:
+// type_id is the index of type in chunk_types.
 struct InsertionPoint {
 	unsigned pos;
+	unsigned type_id = 0;
 	const char* type;
 	const char* name;
 	InsertionPoint(unsigned pos, const char* type, const char* name) : pos(pos), type(type), name(name) {}
@@ -15,16 +34,155 @@ struct Chunk {
 	int file_index;
 	unsigned start;
 	unsigned end;
+	unsigned type_id = 0;
 	const char* type;
 	const char* name;
 	Chunk(int file_index, unsigned start, unsigned end, const char* type, const char* name) : file_index(file_index), start(start), end(end), type(type), name(name) {}
 };
 
+// Chunks found while parsing one file with get_all_chunks set.  Each
+// thread collects them in its own tables, so that files can be parsed in
+// parallel and added to the shared chunk corpus afterwards.
+struct file_chunks {
+	std::vector<InsertionPoint> insertion_points;
+	std::vector<Chunk> deletable_chunks;
+	std::vector<Chunk> optional_chunks;
+	std::vector<Chunk> non_optional_chunks;
+
+	void clear() {
+		insertion_points.clear();
+		deletable_chunks.clear();
+		optional_chunks.clear();
+		non_optional_chunks.clear();
+	}
+};
+
+// Shared memory protocol of the `serve' command.  The region starts with
+// an ff_shm_header, followed by the decision and file buffers at the given
+// offsets.  Requests are read from standard input and answered on
+// standard output, one fixed-size message each.
+#define FF_SHM_MAGIC 0x4d534646 // "FFSM"
+#define FF_SERVE_GENERATE 'g' // generate from `size' decisions into the file buffer
+#define FF_SERVE_PARSE 'p' // parse `size' file bytes into the decision buffer
+
+struct ff_shm_header {
+	uint32_t magic;
+	uint32_t rand_offset;
+	uint32_t rand_limit;
+	uint32_t file_offset;
+	uint32_t file_limit;
+};
+
+struct ff_request {
+	uint32_t command;
+	uint32_t size;
+};
+
+// status is 1 on success, 0 on failure and -1 for an invalid request;
+// size is the file size (generate) or number of decisions (parse)
+struct ff_reply {
+	int32_t status;
+	uint32_t size;
+};
+
+// Binary parse tree (see ff_record_parse_tree() in bt.h).  An image
+// starts with an ff_tree_header, followed by the node table and the
+// string table at the given offsets; it holds no pointers, so it can be
+// written to a file and mapped back in as it is.  Nodes are stored in
+// pre-order, node 0 being the whole file: the children of node i start
+// at i + 1, and the subtree of node i ends before node `end'.
+#define FF_TREE_MAGIC 0x54504646 // "FFPT"
+#define FF_TREE_VERSION 1
+#define FF_TREE_NONE 0xffffffffU
+
+#define FF_TREE_OPTIONAL 1	// the chunk may be left out
+#define FF_TREE_APPENDABLE 2	// chunks can be inserted after this one
+#define FF_TREE_INCOMPLETE 4	// generation or parsing failed inside it
+
+struct ff_tree_header {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t node_count;
+	uint32_t node_offset;
+	uint32_t string_size;
+	uint32_t string_offset;
+	uint32_t file_size;
+	uint32_t decisions;
+};
+
+// Decision and byte ranges are inclusive; a chunk that wrote no bytes
+// has byte_start == byte_end + 1.  name and type are offsets into the
+// string table; field is the field id of name in the generated code.
+struct ff_tree_node {
+	uint32_t parent;
+	uint32_t end;
+	uint32_t field;
+	uint32_t name;
+	uint32_t type;
+	uint32_t index;		// number of earlier siblings with the same name
+	uint32_t rand_start;
+	uint32_t rand_end;
+	uint32_t byte_start;
+	uint32_t byte_end;
+	uint32_t flags;
+};
+
+// Chunk database (see save_corpus() in fuzzer.cpp): the chunk corpus and
+// the decisions of every file in it, so that it can be loaded without
+// parsing the seeds again.  A database starts with an ff_corpus_header,
+// followed by the file table, the chunk table, the string table and the
+// decisions at the given offsets.  It only holds offsets, and is mapped
+// into memory as it is when loaded.
+#define FF_CORPUS_MAGIC 0x44434646 // "FFCD"
+#define FF_CORPUS_VERSION 1
+
+struct ff_corpus_header {
+	uint32_t magic;
+	uint32_t version;
+	uint64_t template_hash;	// template_hash of the generated code
+	uint64_t file_count;
+	uint64_t file_offset;
+	uint64_t chunk_count;
+	uint64_t chunk_offset;
+	uint64_t string_size;
+	uint64_t string_offset;
+	uint64_t decision_size;
+	uint64_t decision_offset;
+};
+
+// The chunks of a file are stored one kind after the other, starting at
+// index `chunks' of the chunk table.  Non-optional chunks are grouped by
+// type.
+struct ff_corpus_file {
+	uint64_t seed_hash;	// FNV-1a hash of the seed file
+	uint64_t decisions;	// offset into the decisions
+	uint32_t decision_size;
+	uint32_t name;		// decision file name in the string table
+	uint32_t chunks;
+	uint32_t insertion_points;
+	uint32_t deletable_chunks;
+	uint32_t optional_chunks;
+	uint32_t non_optional_chunks;
+	uint32_t reserved;
+};
+
+// name and type are offsets into the string table; insertion points
+// only use start
+struct ff_corpus_chunk {
+	uint32_t start;
+	uint32_t end;
+	uint32_t type;
+	uint32_t name;
+};
+
+// The non-optional chunks of one type in a file: non_optional_chunks[type_id]
+// from start on
 struct NonOptional {
 	const char* type;
+	unsigned type_id;
 	int start;
 	int size;
-	NonOptional(const char* type, int start, int size) : type(type), start(start), size(size) {}
+	NonOptional(const char* type, unsigned type_id, int start, int size) : type(type), type_id(type_id), start(start), size(size) {}
 };
 
 extern std::unordered_map<std::string, std::string> variable_types;
@@ -32,7 +190,8 @@ extern std::vector<std::vector<InsertionPoint>> insertion_points;
 extern std::vector<std::vector<Chunk>> deletable_chunks;
 extern std::vector<Chunk> optional_chunks;
 extern std::vector<int> optional_index;
-extern std::unordered_map<std::string, std::vector<Chunk>> non_optional_chunks;
+extern std::vector<std::string> chunk_types;
+extern std::vector<std::vector<Chunk>> non_optional_chunks;
 extern std::vector<std::vector<NonOptional>> non_optional_index;
 extern std::vector<std::string> rand_names;
 unsigned int consumedRand();
@@ -43,6 +202,8 @@ void set_generator();
 
 bool setup_input(const char* filename);
 
+void setup_random(uint64_t seed);
+
 void generate_file();
 
 unsigned get_file_size();
@@ -55,3 +216,9 @@ char* get_bin_name(char* arg);
 
 void save_output(const char* filename);
 
+void save_parse_tree(const char* filename);
+
+extern "C" void ff_record_parse_tree(int enable);
+
+extern "C" size_t ff_parse_tree(const unsigned char** tree);
+
@@ -13,12 +13,18 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/time.h>
+#include <sys/mman.h>
 #include <fcntl.h>
 #include <string>
 #include <stdarg.h>
 #include <time.h>
+#include <errno.h>
+#include <thread>
+#include <atomic>
+#include <random>
 
 #include "formatfuzzer.h"
+#include "checksum.h"
 #include "iostream"
 #include <tuple>
 #include <map>
@@ -28,17 +34,153 @@
 
 static const char *bin_name = "formatfuzzer";
 
-extern bool get_parse_tree;
-extern bool debug_print;
+extern thread_local bool get_parse_tree;
+extern thread_local bool debug_print;
 
 extern bool aflsmart_output;
 
+extern "C" size_t ff_generate(unsigned char* data, size_t size, unsigned char** new_data);
+extern "C" size_t ff_generate_seed(uint64_t seed, unsigned char** new_data);
+static uint64_t get_cur_time_us(void);
+
+// Files per output subdirectory in `fuzz --count' mode
+#define FILES_PER_SHARD 1000
+
+// Tasks a worker claims at once from the shared task counter
+#define FUZZ_BATCH 16
+
+// Generate files on `jobs' threads.  Workers repeatedly claim the next
+// batch of task indices from a shared counter, so faster workers take
+// over the remaining tasks of slower ones.  Each worker has its own
+// generator context (see file_accessor.h), decision buffer and
+// descriptor for the decision source.  Without a decision source, task
+// i takes random decisions from seed + i.  Task i is written to
+// outputs[i] or, if outputs is empty, to OUT_DIR/<i / FILES_PER_SHARD>/<i>.
+static int fuzz_jobs(const char *decision_source, uint64_t seed, unsigned jobs, unsigned count,
+		const std::vector<const char*>& outputs, const char *out_dir)
+{
+	std::atomic<unsigned> next_task(0);
+	std::atomic<int> errors(0);
+	// Set by a worker that cannot go on; the others stop at their next task
+	std::atomic<bool> failed(false);
+	bool parse_tree = get_parse_tree;
+
+	auto worker = [&]() {
+		get_parse_tree = parse_tree;
+		int rand_fd = -1;
+		bool regular = false;
+		std::vector<unsigned char> data;
+		ssize_t size = 0;
+		if (decision_source) {
+			rand_fd = open(decision_source, O_RDONLY);
+			if (rand_fd == -1) {
+				perror(decision_source);
+				failed = true;
+				return;
+			}
+			struct stat st;
+			regular = fstat(rand_fd, &st) == 0 && S_ISREG(st.st_mode);
+			data.resize(regular ? std::min((unsigned long long) st.st_size, (unsigned long long) MAX_RAND_SIZE_LIMIT) : MAX_RAND_SIZE);
+			// Generation does not change the decisions, so a decision file
+			// is read once and reused for every output, as with sequential
+			// `fuzz'
+			if (regular && (size = read(rand_fd, data.data(), data.size())) < 0) {
+				perror("Failed to read seed file");
+				failed = true;
+				close(rand_fd);
+				return;
+			}
+		}
+		char path[PATH_MAX];
+
+		while (!failed) {
+			unsigned first = next_task.fetch_add(FUZZ_BATCH);
+			if (first >= count)
+				break;
+			unsigned last = std::min(first + FUZZ_BATCH, count);
+			for (unsigned i = first; i < last && !failed; ++i) {
+				unsigned char *file = NULL;
+				size_t file_size;
+				if (decision_source) {
+					if (!regular && (size = read(rand_fd, data.data(), data.size())) < 0) {
+						perror("Failed to read seed file");
+						failed = true;
+						break;
+					}
+					file_size = ff_generate(data.data(), size, &file);
+				} else {
+					file_size = ff_generate_seed(seed + i, &file);
+				}
+				if (!file) {
+					errors++;
+					continue;
+				}
+
+				const char *out = path;
+				if (outputs.empty())
+					snprintf(path, sizeof(path), "%s/%04u/%08u", out_dir, i / FILES_PER_SHARD, i);
+				else
+					out = outputs[i];
+				int file_fd = strcmp(out, "-") == 0 ? STDOUT_FILENO
+					: open(out, O_CREAT | O_WRONLY | O_TRUNC, S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH);
+				if (file_fd == -1) {
+					perror(out);
+					failed = true;
+					break;
+				}
+				ssize_t res = write(file_fd, file, file_size);
+				if (res != (ssize_t) file_size) {
+					fprintf(stderr, "Failed to write file\n");
+					errors++;
+				}
+				if (file_fd != STDOUT_FILENO)
+					close(file_fd);
+			}
+		}
+		if (rand_fd != -1)
+			close(rand_fd);
+	};
+
+	if (outputs.empty()) {
+		if (mkdir(out_dir, 0777) == -1 && errno != EEXIST) {
+			perror(out_dir);
+			return 1;
+		}
+		char path[PATH_MAX];
+		for (unsigned shard = 0; shard * FILES_PER_SHARD < count; ++shard) {
+			snprintf(path, sizeof(path), "%s/%04u", out_dir, shard);
+			if (mkdir(path, 0777) == -1 && errno != EEXIST) {
+				perror(path);
+				return 1;
+			}
+		}
+	}
+
+	uint64_t start = get_cur_time_us();
+	std::vector<std::thread> workers;
+	for (unsigned j = 0; j < jobs; ++j)
+		workers.emplace_back(worker);
+	for (std::thread& w : workers)
+		w.join();
+	if (failed)
+		return 1;
+	uint64_t end = get_cur_time_us();
+	double time = (end - start) / 1.0e6;
+	if (outputs.empty())
+		fprintf(stderr, "%s: generated %u files in %s with %u jobs in %f s (%f / s)\n", bin_name, count, out_dir, jobs, time, count / time);
+	return errors;
+}
+
 // Each command comes as if it were invoked from the command line
 
 // fuzz - generate random inputs
 int fuzz(int argc, char **argv)
 {
-	const char *decision_source = "/dev/urandom";
+	const char *decision_source = NULL;
+	uint64_t seed = 0;
+	bool has_seed = false;
+	unsigned jobs = 0;
+	unsigned count = 0;
 
 	// Process options
 	while (1)
@@ -47,9 +189,12 @@ int fuzz(int argc, char **argv)
 			{
 				{"help", no_argument, 0, 'h'},
 				{"decisions", required_argument, 0, 'd'},
+				{"seed", required_argument, 0, 's'},
+				{"jobs", required_argument, 0, 'j'},
+				{"count", required_argument, 0, 'n'},
 				{0, 0, 0, 0}};
 		int option_index = 0;
-		int c = getopt_long(argc, argv, "d:p",
+		int c = getopt_long(argc, argv, "d:s:pj:n:",
 							long_options, &option_index);
 
 		// Detect the end of the options.
@@ -60,16 +205,37 @@ int fuzz(int argc, char **argv)
 		{
 		case 'h':
 		case '?':
-			fprintf(stderr, "fuzz: usage: fuzz [--decisions SOURCE] [FILES...|-]\n");
+			fprintf(stderr, "fuzz: usage: fuzz [--decisions SOURCE|--seed S] [--jobs N] [FILES...|-]\n");
+			fprintf(stderr, "       fuzz [--decisions SOURCE|--seed S] [--jobs N] --count M DIR\n");
 			fprintf(stderr, "Outputs random data to given FILES (or `-' for standard output).\n");
+			fprintf(stderr, "With --count, writes M files to numbered subdirectories of DIR\n");
+			fprintf(stderr, "(%d files each).\n", FILES_PER_SHARD);
 			fprintf(stderr, "Options:\n");
-			fprintf(stderr, "--decisions SOURCE: Use SOURCE for generation decisions (default %s)\n", decision_source);
+			fprintf(stderr, "--decisions SOURCE: Use SOURCE for generation decisions (default: random)\n");
+			fprintf(stderr, "--seed S: Take random decisions for the i-th output from seed S+i\n");
+			fprintf(stderr, "          (default: a fresh seed, which is printed)\n");
+			fprintf(stderr, "--jobs N: Generate on N threads (default 1, or all cores with --count)\n");
+			fprintf(stderr, "--count M: Generate M files into DIR\n");
 			fprintf(stderr, "-p: print parse tree\n");
 			return 0;
 
 		case 'd':
 			decision_source = optarg;
 			break;
+		case 's':
+			seed = strtoull(optarg, NULL, 0);
+			has_seed = true;
+			break;
+		case 'j':
+			jobs = strtoul(optarg, NULL, 10);
+			if (jobs == 0) {
+				fprintf(stderr, "%s: --jobs must be positive\n", bin_name);
+				return 1;
+			}
+			break;
+		case 'n':
+			count = strtoul(optarg, NULL, 10);
+			break;
 		case 'p':
 			get_parse_tree = true;
 			break;
@@ -81,13 +247,36 @@ int fuzz(int argc, char **argv)
         return 1;
     }
 
+	if (!decision_source && !has_seed) {
+		std::random_device rd;
+		seed = ((uint64_t) rd() << 32) | rd();
+		fprintf(stderr, "%s: seed %llu\n", bin_name, (unsigned long long) seed);
+	}
+
+	if (count) {
+		if (optind + 1 != argc) {
+			fprintf(stderr, "%s: --count takes a single output directory\n", bin_name);
+			return 1;
+		}
+		if (!jobs)
+			jobs = std::max(std::thread::hardware_concurrency(), 1U);
+		return fuzz_jobs(decision_source, seed, jobs, count, {}, argv[optind]);
+	}
+	if (jobs > 1) {
+		std::vector<const char*> outputs(argv + optind, argv + argc);
+		return fuzz_jobs(decision_source, seed, std::min(jobs, (unsigned) outputs.size()), outputs.size(), outputs, NULL);
+	}
+
 	// Main function
 	int errors = 0;
 	for (int arg = optind; arg < argc; arg++)
 	{
 		char *out = argv[arg];
 		bool success = false;
-		setup_input(decision_source);
+		if (decision_source)
+			setup_input(decision_source);
+		else
+			setup_random(seed + (arg - optind));
 		try
 		{
 			generate_file();
@@ -121,6 +310,7 @@ int fuzz(int argc, char **argv)
 int parse(int argc, char **argv)
 {
 	const char *decision_sink = 0;
+	const char *tree_sink = 0;
 
 	// Process options
 	while (1)
@@ -129,9 +319,10 @@ int parse(int argc, char **argv)
 			{
 				{"help", no_argument, 0, 'h'},
 				{"decisions", required_argument, 0, 'd'},
+				{"tree", required_argument, 0, 't'},
 				{0, 0, 0, 0}};
 		int option_index = 0;
-		int c = getopt_long(argc, argv, "d:s",
+		int c = getopt_long(argc, argv, "d:st:",
 							long_options, &option_index);
 
 		// Detect the end of the options.
@@ -142,15 +333,19 @@ int parse(int argc, char **argv)
 		{
 		case 'h':
 		case '?':
-			fprintf(stderr, "parse: usage: parse [--decisions SINK] [FILES...|-]\n");
+			fprintf(stderr, "parse: usage: parse [--decisions SINK] [--tree SINK] [FILES...|-]\n");
 			fprintf(stderr, "Parses given FILES (or `-' for standard input).\n");
 			fprintf(stderr, "Options:\n");
 			fprintf(stderr, "--decisions SINK: Save parsing decisions in SINK (default: none)\n");
+			fprintf(stderr, "--tree SINK: Save the binary parse tree in SINK (default: none)\n");
 			return 0;
 
 		case 'd':
 			decision_sink = optarg;
 			break;
+		case 't':
+			tree_sink = optarg;
+			break;
 		case 's':
 			aflsmart_output = true;
 			break;
@@ -162,6 +357,9 @@ int parse(int argc, char **argv)
         return 1;
     }
 
+	if (tree_sink)
+		ff_record_parse_tree(1);
+
 	int errors = 0;
 	for (int arg = optind; arg < argc; arg++)
 	{
@@ -197,41 +395,45 @@ int parse(int argc, char **argv)
 
 		if (decision_sink)
 			save_output(decision_sink);
+		if (tree_sink)
+			save_parse_tree(tree_sink);
 	}
 
 	return errors;
 }
 
 extern "C" size_t ff_generate(unsigned char* data, size_t size, unsigned char** new_data);
+extern const uint64_t template_hash;
 extern "C" int ff_parse(unsigned char* data, size_t size, unsigned char** new_data, size_t* new_size);
-extern bool print_errors;
+extern thread_local bool print_errors;
 extern std::unordered_map<std::string, std::string> variable_types;
 
 unsigned copy_rand(unsigned char *dest);
 
-extern const char* chunk_name;
-extern const char* chunk_name2;
-extern int file_index;
-
-extern bool get_chunk;
-extern bool get_all_chunks;
-extern bool smart_mutation;
-extern bool smart_abstraction;
-extern bool smart_swapping;
-extern unsigned chunk_start;
-extern unsigned chunk_end;
-extern unsigned rand_start;
-extern unsigned rand_end;
-extern unsigned rand_start2;
-extern unsigned rand_end2;
-extern bool is_optional;
-extern bool is_delete;
-extern bool following_is_optional;
-extern unsigned char *following_rand_buffer;
-extern unsigned following_rand_size;
-
-
-extern unsigned char *rand_buffer;
+extern thread_local const char* chunk_name;
+extern thread_local const char* chunk_name2;
+extern thread_local int file_index;
+extern thread_local file_chunks found_chunks;
+
+extern thread_local bool get_chunk;
+extern thread_local bool get_all_chunks;
+extern thread_local bool smart_mutation;
+extern thread_local bool smart_abstraction;
+extern thread_local bool smart_swapping;
+extern thread_local unsigned chunk_start;
+extern thread_local unsigned chunk_end;
+extern thread_local unsigned rand_start;
+extern thread_local unsigned rand_end;
+extern thread_local unsigned rand_start2;
+extern thread_local unsigned rand_end2;
+extern thread_local bool is_optional;
+extern thread_local bool is_delete;
+extern thread_local bool following_is_optional;
+extern thread_local unsigned char *following_rand_buffer;
+extern thread_local unsigned following_rand_size;
+
+
+extern thread_local unsigned char *rand_buffer;
 
 /* Get unix time in microseconds */
 
@@ -254,6 +456,44 @@ void write_file(const char* filename, unsigned char* data, size_t size) {
 	close(file_fd);
 }
 
+// Seed for the mutation source of a new thread: the time, mixed with
+// the number of threads started before, so that threads created in the
+// same second do not share a sequence
+static unsigned mutation_seed() {
+	static std::atomic<unsigned> threads(0);
+	return (unsigned) time(NULL) ^ (threads++ * 0x9e3779b9U);
+}
+
+// Random source of smart mutations.  Each thread seeds its own from
+// mutation_seed(), or with seed_mutations() for reproducible runs; it
+// needs no file access.
+thread_local std::mt19937 mutation_rng(mutation_seed());
+
+extern "C" void seed_mutations(unsigned seed) {
+	mutation_rng.seed(seed);
+}
+
+void random_fill(unsigned char* buffer, size_t size) {
+	for (size_t i = 0; i < size; ++i)
+		buffer[i] = mutation_rng();
+}
+
+// Grow a decision buffer of the given capacity to hold at least size
+// bytes, keeping its contents.  The new tail gets fresh random decisions.
+void reserve_rand(unsigned char*& buffer, unsigned& capacity, unsigned size) {
+	if (size <= capacity)
+		return;
+	unsigned new_capacity = capacity;
+	while (new_capacity < size)
+		new_capacity *= 2;
+	unsigned char* new_buffer = new unsigned char[new_capacity];
+	memcpy(new_buffer, buffer, capacity);
+	random_fill(new_buffer + capacity, new_capacity - capacity);
+	delete[] buffer;
+	buffer = new_buffer;
+	capacity = new_capacity;
+}
+
 // smart_replace - apply a smart replacement
 int smart_replace(int argc, char **argv)
 {
@@ -273,12 +513,10 @@ int smart_replace(int argc, char **argv)
 
 	unsigned char *rand_t = new unsigned char[MAX_RAND_SIZE];
 	unsigned char *rand_s = new unsigned char[MAX_RAND_SIZE];
+	unsigned capacity_t = MAX_RAND_SIZE;
+	unsigned capacity_s = MAX_RAND_SIZE;
 	unsigned len_t;
-	int rand_fd = open("/dev/urandom", O_RDONLY);
-	ssize_t r = read(rand_fd, rand_t, MAX_RAND_SIZE);
-	if (r != MAX_RAND_SIZE)
-		printf("Read only %ld bytes from /dev/urandom\n", r);
-	close(rand_fd);
+	random_fill(rand_t, MAX_RAND_SIZE);
 	// Process options
 	while (1)
 	{
@@ -389,6 +627,7 @@ number of decision bytes in file_t than it did in file_s.
 		fprintf(stderr, "%s: Unable to find chunk in file %s\n", bin_name, file_s);
 		return -2;
 	}
+	reserve_rand(rand_s, capacity_s, consumedRand());
 	copy_rand(rand_s);
 	start_s = rand_start;
 	end_s = rand_end;
@@ -427,6 +666,7 @@ number of decision bytes in file_t than it did in file_s.
 		fprintf(stderr, "%s: Unable to find chunk in file %s\n", bin_name, file_t);
 		return -2;
 	}
+	reserve_rand(rand_t, capacity_t, consumedRand());
 	len_t = copy_rand(rand_t);
 	start_t = rand_start;
 	end_t = rand_end;
@@ -449,7 +689,7 @@ number of decision bytes in file_t than it did in file_s.
 	printf("\nGenerating file %s\n\n", out);
 
 	unsigned rand_size = len_t + (end_s - start_s) - (end_t - start_t);
-	assert(rand_size <= MAX_RAND_SIZE);
+	reserve_rand(rand_t, capacity_t, rand_size);
 	memmove(rand_t + start_t + end_s + 1 - start_s, rand_t + end_t + 1, len_t - (end_t + 1));
 	memcpy(rand_t + start_t, rand_s + start_s, end_s + 1 - start_s);
 
@@ -459,7 +699,7 @@ number of decision bytes in file_t than it did in file_s.
 	set_generator();
 
 	unsigned char* file = NULL;
-	unsigned file_size = ff_generate(rand_t, MAX_RAND_SIZE, &file);
+	unsigned file_size = ff_generate(rand_t, capacity_t, &file);
 	if (!file || !file_size) {
 		printf("Failed to generate mutated file!\n");
 		return -2;
@@ -493,12 +733,9 @@ int smart_delete(int argc, char **argv)
 	bool success = false;
 
 	unsigned char *rand_t = new unsigned char[MAX_RAND_SIZE];
+	unsigned capacity_t = MAX_RAND_SIZE;
 	unsigned len_t;
-	int rand_fd = open("/dev/urandom", O_RDONLY);
-	ssize_t r = read(rand_fd, rand_t, MAX_RAND_SIZE);
-	if (r != MAX_RAND_SIZE)
-		printf("Read only %ld bytes from /dev/urandom\n", r);
-	close(rand_fd);
+	random_fill(rand_t, MAX_RAND_SIZE);
 	// Process options
 	while (1)
 	{
@@ -591,6 +828,7 @@ the binary template (such as length fields).
 		fprintf(stderr, "%s: Unable to find chunk in file %s\n", bin_name, file_t);
 		return -2;
 	}
+	reserve_rand(rand_t, capacity_t, consumedRand());
 	len_t = copy_rand(rand_t);
 	start_t = rand_start;
 	end_t = rand_end;
@@ -613,7 +851,7 @@ the binary template (such as length fields).
 	set_generator();
 
 	unsigned char* file = NULL;
-	unsigned file_size = ff_generate(rand_t, MAX_RAND_SIZE, &file);
+	unsigned file_size = ff_generate(rand_t, capacity_t, &file);
 	if (!file || !file_size) {
 		printf("Failed to generate mutated file!\n");
 		return -2;
@@ -644,12 +882,10 @@ int smart_insert(int argc, char **argv)
 
 	unsigned char *rand_t = new unsigned char[MAX_RAND_SIZE];
 	unsigned char *rand_s = new unsigned char[MAX_RAND_SIZE];
+	unsigned capacity_t = MAX_RAND_SIZE;
+	unsigned capacity_s = MAX_RAND_SIZE;
 	unsigned len_t;
-	int rand_fd = open("/dev/urandom", O_RDONLY);
-	ssize_t r = read(rand_fd, rand_t, MAX_RAND_SIZE);
-	if (r != MAX_RAND_SIZE)
-		printf("Read only %ld bytes from /dev/urandom\n", r);
-	close(rand_fd);
+	random_fill(rand_t, MAX_RAND_SIZE);
 	// Process options
 	while (1)
 	{
@@ -759,6 +995,7 @@ smaller number of decision bytes in file_t than it did in file_s.
 		fprintf(stderr, "%s: Unable to find chunk in file %s\n", bin_name, file_s);
 		return -2;
 	}
+	reserve_rand(rand_s, capacity_s, consumedRand());
 	copy_rand(rand_s);
 	start_s = rand_start;
 	end_s = rand_end;
@@ -792,6 +1029,7 @@ smaller number of decision bytes in file_t than it did in file_s.
 	{
 		fprintf(stderr, "%s: Parsing %s failed\n", bin_name, file_t);
 	}
+	reserve_rand(rand_t, capacity_t, consumedRand());
 	len_t = copy_rand(rand_t);
 	start_t = rand_start;
 
@@ -808,7 +1046,7 @@ smaller number of decision bytes in file_t than it did in file_s.
 	printf("\nGenerating file %s\n\n", out);
 
 	unsigned rand_size = len_t + (end_s + 1 - start_s);
-	assert(rand_size <= MAX_RAND_SIZE);
+	reserve_rand(rand_t, capacity_t, rand_size);
 	memmove(rand_t + start_t + end_s + 1 - start_s, rand_t + start_t, len_t - start_t);
 	memcpy(rand_t + start_t, rand_s + start_s, end_s + 1 - start_s);
 
@@ -819,7 +1057,7 @@ smaller number of decision bytes in file_t than it did in file_s.
 	set_generator();
 
 	unsigned char* file = NULL;
-	unsigned file_size = ff_generate(rand_t, MAX_RAND_SIZE, &file);
+	unsigned file_size = ff_generate(rand_t, capacity_t, &file);
 	if (!file || !file_size) {
 		printf("Failed to generate mutated file!\n");
 		return -2;
@@ -850,11 +1088,9 @@ int smart_abstract(int argc, char **argv)
 	bool success = false;
 
 	unsigned char *rand_t = new unsigned char[MAX_RAND_SIZE];
+	unsigned capacity_t = MAX_RAND_SIZE;
 	unsigned len_t;
-	int rand_fd = open("/dev/urandom", O_RDONLY);
-	ssize_t r = read(rand_fd, rand_t, MAX_RAND_SIZE);
-	if (r != MAX_RAND_SIZE)
-		printf("Read only %ld bytes from /dev/urandom\n", r);
+	random_fill(rand_t, MAX_RAND_SIZE);
 
 	// Process options
 	while (1)
@@ -946,6 +1182,7 @@ the binary template (such as length fields).
 		fprintf(stderr, "%s: Unable to find chunk in file %s\n", bin_name, file_t);
 		return -2;
 	}
+	reserve_rand(rand_t, capacity_t, consumedRand());
 	len_t = copy_rand(rand_t);
 	start_t = rand_start;
 	end_t = rand_end;
@@ -956,17 +1193,14 @@ the binary template (such as length fields).
 	following_rand_buffer = new unsigned char[following_rand_size];
 	memcpy(following_rand_buffer, rand_t + end_t + 1, following_rand_size);
 
-	r = read(rand_fd, rand_t + start_t, len_t - start_t);
-	if (r != len_t - start_t)
-		printf("Read only %ld bytes from /dev/urandom\n", r);
-	close(rand_fd);
+	random_fill(rand_t + start_t, len_t - start_t);
 
 	get_chunk = false;
 	smart_abstraction = true;
 	set_generator();
 
 	unsigned char* file = NULL;
-	unsigned file_size = ff_generate(rand_t, MAX_RAND_SIZE, &file);
+	unsigned file_size = ff_generate(rand_t, capacity_t, &file);
 	if (!file || !file_size) {
 		printf("Failed to generate mutated file!\n");
 		return -2;
@@ -1001,12 +1235,10 @@ int smart_swap(int argc, char **argv)
 
 	unsigned char *rand_t = new unsigned char[MAX_RAND_SIZE];
 	unsigned char *rand_s = new unsigned char[MAX_RAND_SIZE];
+	unsigned capacity_t = MAX_RAND_SIZE;
+	unsigned capacity_s = MAX_RAND_SIZE;
 	unsigned len_t;
-	int rand_fd = open("/dev/urandom", O_RDONLY);
-	ssize_t r = read(rand_fd, rand_t, MAX_RAND_SIZE);
-	if (r != MAX_RAND_SIZE)
-		printf("Read only %ld bytes from /dev/urandom\n", r);
-	close(rand_fd);
+	random_fill(rand_t, MAX_RAND_SIZE);
 	// Process options
 	while (1)
 	{
@@ -1120,6 +1352,7 @@ smaller number of decision bytes.
 		fprintf(stderr, "%s: Unable to find source chunk in file %s\n", bin_name, file_t);
 		return -2;
 	}
+	reserve_rand(rand_s, capacity_s, consumedRand());
 	copy_rand(rand_s);
 	start_s = rand_start;
 	end_s = rand_end;
@@ -1159,6 +1392,7 @@ smaller number of decision bytes.
 		fprintf(stderr, "%s: Unable to find target chunk in file %s\n", bin_name, file_t);
 		return -2;
 	}
+	reserve_rand(rand_t, capacity_t, consumedRand());
 	len_t = copy_rand(rand_t);
 	start_t = rand_start;
 	end_t = rand_end;
@@ -1178,6 +1412,8 @@ smaller number of decision bytes.
 
 	unsigned rand_end20 = rand_end2 = 0;
 	
+	if (end_t - start_t < end_s - start_s)
+		reserve_rand(rand_t, capacity_t, len_t + (end_s - start_s) - (end_t - start_t));
 	if (start_s > end_t) {
 		memcpy(rand_t + start_t, rand_s + start_s, end_s + 1 - start_s);
 		memcpy(rand_t + start_t + end_s + 1 - start_s, rand_s + end_t + 1, start_s - end_t - 1);
@@ -1205,7 +1441,7 @@ smaller number of decision bytes.
 	set_generator();
 
 	unsigned char* file = NULL;
-	unsigned file_size = ff_generate(rand_t, MAX_RAND_SIZE, &file);
+	unsigned file_size = ff_generate(rand_t, capacity_t, &file);
 	if (!file || !file_size) {
 		printf("Failed to generate mutated file!\n");
 		return -2;
@@ -1230,13 +1466,188 @@ smaller number of decision bytes.
 }
 
 
-extern "C" int process_file(const char *file_name, const char *rand_name) {
-	rand_names.push_back(rand_name);
-	insertion_points.push_back({});
-	deletable_chunks.push_back({});
+// In-memory decision corpus, indexed by file index, so that mutations
+// need no file access.  Entries hold a heap copy of the decisions or, if
+// FF_MMAP_DECISIONS is set, a read-only mapping of the decision file
+// written by process_file().  Files loaded from a chunk database point
+// into its mapping (see load_corpus()).
+struct Decisions {
+	const unsigned char *data;
+	unsigned size;
+	bool mapped;
+	bool in_database;
+};
+std::vector<Decisions> rand_data;
+
+// Hash of the seed each corpus file was parsed from, by file index
+std::vector<uint64_t> seed_hashes;
+
+// Chunk databases loaded into the corpus
+struct corpus_mapping {
+	void *data;
+	size_t size;
+};
+static std::vector<corpus_mapping> corpus_mappings;
+
+#define FNV_OFFSET 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+
+static uint64_t fnv1a(const unsigned char *data, size_t size, uint64_t hash = FNV_OFFSET) {
+	for (size_t i = 0; i < size; ++i)
+		hash = (hash ^ data[i]) * FNV_PRIME;
+	return hash;
+}
+
+// The hash of an input held in memory; the mutator adapters use it to
+// recognize inputs they have parsed before
+uint64_t hash_data(const unsigned char *data, size_t size) {
+	return fnv1a(data, size);
+}
+
+// The hash of the contents of file_name, which identifies a seed in chunk
+// databases, or 0 if it cannot be read
+static uint64_t hash_file(const char *file_name) {
+	int file_fd = open(file_name, O_RDONLY);
+	if (file_fd == -1)
+		return 0;
+	unsigned char buffer[65536];
+	uint64_t hash = FNV_OFFSET;
+	ssize_t size;
+	while ((size = read(file_fd, buffer, sizeof(buffer))) > 0)
+		hash = fnv1a(buffer, size, hash);
+	close(file_fd);
+	return size == 0 ? hash : 0;
+}
+
+// The decisions of the file just parsed on this thread
+static Decisions get_decisions(const char *rand_name) {
+	static const bool use_mmap = getenv("FF_MMAP_DECISIONS") != NULL;
+	unsigned size = consumedRand();
+	if (use_mmap && rand_name && *rand_name && size) {
+		int file_fd = open(rand_name, O_RDONLY);
+		void *data = file_fd == -1 ? MAP_FAILED : mmap(NULL, size, PROT_READ, MAP_PRIVATE, file_fd, 0);
+		if (file_fd != -1)
+			close(file_fd);
+		if (data != MAP_FAILED)
+			return {(const unsigned char *) data, size, true, false};
+	}
+	unsigned char *data = new unsigned char[size];
+	copy_rand(data);
+	return {data, size, false, false};
+}
+
+// Donor pools for smart replacement and insertion, one per chunk type
+// id: the indices of the chunks of that type (in optional_chunks or
+// non_optional_chunks[type_id]), and the same indices grouped by size
+// class, i.e. the bit width of their number of decisions.  A donor of
+// the same type and about the same size as the chunk it replaces is
+// the most likely to consume as many decisions in its new place.
+struct chunk_pool {
+	std::vector<int> chunks;
+	std::vector<std::vector<int>> sizes;
+
+	static unsigned size_class(const Chunk& c) {
+		unsigned size = c.end + 1 - c.start;
+		return size ? 32 - __builtin_clz(size) : 0;
+	}
+
+	void add(int index, const Chunk& c) {
+		unsigned size = size_class(c);
+		if (size >= sizes.size())
+			sizes.resize(size + 1);
+		chunks.push_back(index);
+		sizes[size].push_back(index);
+	}
+
+	// A random chunk of the pool, of the size class of `like' if there is
+	// one.  The pool must not be empty.
+	int pick(const Chunk& like) const {
+		unsigned size = size_class(like);
+		if (size < sizes.size() && !sizes[size].empty())
+			return sizes[size][mutation_rng() % sizes[size].size()];
+		return chunks[mutation_rng() % chunks.size()];
+	}
+};
+static std::vector<chunk_pool> optional_pools;
+static std::vector<chunk_pool> non_optional_pools;
+
+// Interned chunk types.  Types come from a few string tables (the
+// generated code, or a loaded chunk database), so they are looked up by
+// address before they are compared.
+static std::unordered_map<std::string, unsigned> type_ids;
+static std::unordered_map<const char*, unsigned> type_addresses;
+
+static unsigned chunk_type_id(const char *type) {
+	auto address = type_addresses.find(type);
+	if (address != type_addresses.end())
+		return address->second;
+	auto id = type_ids.emplace(type, chunk_types.size());
+	if (id.second) {
+		chunk_types.push_back(type);
+		non_optional_chunks.resize(chunk_types.size());
+		optional_pools.resize(chunk_types.size());
+		non_optional_pools.resize(chunk_types.size());
+	}
+	type_addresses.emplace(type, id.first->second);
+	return id.first->second;
+}
+
+// Add the chunks found while parsing a file to the chunk corpus, taking
+// over its insertion points and deletable chunks.  Files must be added in
+// the order of their file indices.
+static void add_file_chunks(file_chunks& found) {
+	for (InsertionPoint& ip : found.insertion_points)
+		ip.type_id = chunk_type_id(ip.type);
+	for (Chunk& c : found.deletable_chunks)
+		c.type_id = chunk_type_id(c.type);
+	insertion_points.push_back(std::move(found.insertion_points));
+	deletable_chunks.push_back(std::move(found.deletable_chunks));
+	for (Chunk& c : found.optional_chunks) {
+		c.type_id = chunk_type_id(c.type);
+		optional_pools[c.type_id].add(optional_chunks.size(), c);
+		optional_chunks.push_back(c);
+	}
+	optional_index.push_back(optional_chunks.size());
 	non_optional_index.push_back({});
-	bool success = false;
+	std::vector<NonOptional>& index = non_optional_index.back();
+	size_t i = 0;
+	for (Chunk& c : found.non_optional_chunks) {
+		c.type_id = chunk_type_id(c.type);
+		std::vector<Chunk>& typed = non_optional_chunks[c.type_id];
+		// Chunks of one type often follow each other
+		if (i == index.size() || index[i].type_id != c.type_id) {
+			for (i = 0; i < index.size() && index[i].type_id != c.type_id; ++i)
+				;
+			if (i == index.size())
+				index.emplace_back(c.type, c.type_id, typed.size(), 0);
+		}
+		++index[i].size;
+		non_optional_pools[c.type_id].add(typed.size(), c);
+		typed.push_back(c);
+	}
+}
+
+// A random optional chunk of corpus file `file', of type type_id if the
+// file has one, or -1 if the file has no optional chunks
+static int pick_optional_chunk(int file, unsigned type_id) {
+	int start = optional_index[file];
+	int end = optional_index[file + 1];
+	if (start == end)
+		return -1;
+	int found = -1;
+	unsigned seen = 0;
+	for (int i = start; i < end; ++i) {
+		if (optional_chunks[i].type_id == type_id && mutation_rng() % ++seen == 0)
+			found = i;
+	}
+	return found != -1 ? found : start + mutation_rng() % (end - start);
+}
 
+// Parse file_name on this thread as file number file_index, collecting
+// its chunks in found_chunks.  Returns false if parsing failed.
+static bool parse_chunks(const char *file_name) {
+	bool success = false;
+	found_chunks.clear();
 	get_all_chunks = true;
 	set_parser();
 	setup_input(file_name);
@@ -1257,9 +1668,17 @@ extern "C" int process_file(const char *file_name, const char *rand_name) {
 		delete_globals();
 	}
 	get_all_chunks = false;
+	return success;
+}
+
+extern "C" int process_file(const char *file_name, const char *rand_name) {
+	bool success = parse_chunks(file_name);
 	save_output(rand_name);
+	rand_names.push_back(rand_name);
+	add_file_chunks(found_chunks);
+	rand_data.push_back(get_decisions(rand_name));
+	seed_hashes.push_back(hash_file(file_name));
 	++file_index;
-	optional_index.push_back(optional_chunks.size());
 	if (!success && debug_print)
 	{
 		fprintf(stderr, "%s: Parsing %s failed\n", bin_name, file_name);
@@ -1268,24 +1687,308 @@ extern "C" int process_file(const char *file_name, const char *rand_name) {
 
 }
 
-unsigned read_rand_file(const char* file_name, unsigned char* rand_buffer) {
-	int file_fd = open(file_name, O_RDONLY);
-	if (file_fd == -1) {
-		perror(file_name);
-		exit(1);
+// process_files - add count files to the chunk corpus, as process_file()
+// would one after the other, but parse them on `jobs' threads.  Each
+// worker collects the chunks and decisions of the files it parses; they
+// are added to the corpus in file order once all files are parsed, so
+// the corpus is the same as after importing the files serially.  The
+// decisions of file_names[i] are written to rand_files[i].  Returns the
+// number of files that were parsed completely.
+extern "C" int process_files(const char **file_names, const char **rand_files, unsigned count, unsigned jobs)
+{
+	struct parsed_file {
+		file_chunks chunks;
+		Decisions decisions;
+		uint64_t seed_hash;
+		bool complete;
+	};
+	std::vector<parsed_file> parsed(count);
+	std::atomic<unsigned> next_file(0);
+	int first_index = file_index;
+
+	auto worker = [&]() {
+		while (true) {
+			unsigned i = next_file.fetch_add(1);
+			if (i >= count)
+				break;
+			file_index = first_index + i;
+			bool success = parse_chunks(file_names[i]);
+			save_output(rand_files[i]);
+			parsed[i].chunks = std::move(found_chunks);
+			parsed[i].decisions = get_decisions(rand_files[i]);
+			parsed[i].seed_hash = hash_file(file_names[i]);
+			parsed[i].complete = success && get_validity() == 1.0;
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for (unsigned j = 1; j < std::min(jobs, count); ++j)
+		workers.emplace_back(worker);
+	worker();
+	for (std::thread& w : workers)
+		w.join();
+
+	int complete = 0;
+	for (unsigned i = 0; i < count; ++i) {
+		rand_names.push_back(rand_files[i]);
+		add_file_chunks(parsed[i].chunks);
+		rand_data.push_back(parsed[i].decisions);
+		seed_hashes.push_back(parsed[i].seed_hash);
+		complete += parsed[i].complete;
+	}
+	file_index = first_index + count;
+	return complete;
+}
+
+// process_data - add a file given by its decisions to the chunk corpus,
+// without writing a decision file.  The file is generated from the
+// decisions and parsed again, as in process_file().  Returns the index of the new
+// file, or -1 if no file could be generated from the decisions.
+extern "C" int process_data(const unsigned char *data, size_t size) {
+	std::vector<unsigned char> decisions(data, data + size);
+	unsigned char *file = NULL;
+	set_generator();
+	size_t file_size = ff_generate(decisions.data(), decisions.size(), &file);
+	if (!file)
+		return -1;
+
+	found_chunks.clear();
+	get_all_chunks = true;
+	get_parse_tree = true;
+	debug_print = false;
+	unsigned char *rand = NULL;
+	size_t rand_size = 0;
+	// The file is still in the file buffer, so ff_parse() does not copy it
+	ff_parse(file, file_size, &rand, &rand_size);
+	get_all_chunks = false;
+	rand_names.push_back("");
+	add_file_chunks(found_chunks);
+	rand_data.push_back(get_decisions(NULL));
+	seed_hashes.push_back(fnv1a(data, size));
+	return file_index++;
+}
+
+// save_corpus - write the chunk corpus and the decisions of all its files
+// to the chunk database `path' (see struct ff_corpus_header in
+// formatfuzzer.h).  The database is written to a temporary file first and
+// then renamed, so that a database is never left half written.  Returns
+// 0 on success and -1 on error.
+extern "C" int save_corpus(const char *path) {
+	std::vector<ff_corpus_file> files;
+	std::vector<ff_corpus_chunk> chunks;
+	std::string strings(1, '\0');
+	std::unordered_map<std::string, uint32_t> string_offsets;
+	auto add_string = [&](const char *s) {
+		auto it = string_offsets.emplace(s, strings.size());
+		if (it.second)
+			strings.append(s, strlen(s) + 1);
+		return it.first->second;
+	};
+	auto add_chunk = [&](unsigned start, unsigned end, const char *type, const char *name) {
+		chunks.push_back({start, end, add_string(type), add_string(name)});
+	};
+
+	uint64_t decision_size = 0;
+	for (size_t i = 0; i < rand_data.size(); ++i) {
+		ff_corpus_file f = {};
+		f.seed_hash = seed_hashes[i];
+		f.decisions = decision_size;
+		f.decision_size = rand_data[i].size;
+		f.name = add_string(rand_names[i].c_str());
+		f.chunks = chunks.size();
+		for (InsertionPoint& ip : insertion_points[i])
+			add_chunk(ip.pos, ip.pos, ip.type, ip.name);
+		for (Chunk& c : deletable_chunks[i])
+			add_chunk(c.start, c.end, c.type, c.name);
+		for (int j = optional_index[i]; j < optional_index[i + 1]; ++j)
+			add_chunk(optional_chunks[j].start, optional_chunks[j].end, optional_chunks[j].type, optional_chunks[j].name);
+		for (NonOptional& no : non_optional_index[i]) {
+			std::vector<Chunk>& typed = non_optional_chunks[no.type_id];
+			for (int j = no.start; j < no.start + no.size; ++j)
+				add_chunk(typed[j].start, typed[j].end, typed[j].type, typed[j].name);
+		}
+		f.insertion_points = insertion_points[i].size();
+		f.deletable_chunks = deletable_chunks[i].size();
+		f.optional_chunks = optional_index[i + 1] - optional_index[i];
+		f.non_optional_chunks = chunks.size() - f.chunks - f.insertion_points - f.deletable_chunks - f.optional_chunks;
+		files.push_back(f);
+		decision_size += rand_data[i].size;
+	}
+
+	ff_corpus_header h = {};
+	h.magic = FF_CORPUS_MAGIC;
+	h.version = FF_CORPUS_VERSION;
+	h.template_hash = template_hash;
+	h.file_count = files.size();
+	h.file_offset = sizeof(h);
+	h.chunk_count = chunks.size();
+	h.chunk_offset = h.file_offset + files.size() * sizeof(ff_corpus_file);
+	h.string_size = strings.size();
+	h.string_offset = h.chunk_offset + chunks.size() * sizeof(ff_corpus_chunk);
+	h.decision_size = decision_size;
+	h.decision_offset = h.string_offset + strings.size();
+
+	std::string tmp = std::string(path) + ".tmp";
+	FILE *f = fopen(tmp.c_str(), "wb");
+	if (!f) {
+		perror(tmp.c_str());
+		return -1;
 	}
-	ssize_t size = read(file_fd, rand_buffer, MAX_RAND_SIZE);
-	if (size < 0) {
-		perror("Failed to read seed file");
-		exit(1);
+	bool ok = fwrite(&h, sizeof(h), 1, f) == 1
+		&& fwrite(files.data(), sizeof(ff_corpus_file), files.size(), f) == files.size()
+		&& fwrite(chunks.data(), sizeof(ff_corpus_chunk), chunks.size(), f) == chunks.size()
+		&& fwrite(strings.data(), 1, strings.size(), f) == strings.size();
+	for (size_t i = 0; ok && i < rand_data.size(); ++i)
+		ok = fwrite(rand_data[i].data, 1, rand_data[i].size, f) == rand_data[i].size;
+	ok = fclose(f) == 0 && ok;
+	if (!ok || rename(tmp.c_str(), path) == -1) {
+		perror(path);
+		unlink(tmp.c_str());
+		return -1;
 	}
+	return 0;
+}
+
+// Check that the database at `data' fits in `size' bytes and was made
+// from the same template
+static bool check_corpus(const unsigned char *data, size_t size) {
+	const ff_corpus_header *h = (const ff_corpus_header *) data;
+	if (size < sizeof(*h) || h->magic != FF_CORPUS_MAGIC || h->version != FF_CORPUS_VERSION
+			|| h->template_hash != template_hash)
+		return false;
+	auto fits = [&](uint64_t offset, uint64_t count, uint64_t item) {
+		return offset <= size && count <= (size - offset) / item;
+	};
+	if (!fits(h->file_offset, h->file_count, sizeof(ff_corpus_file))
+			|| !fits(h->chunk_offset, h->chunk_count, sizeof(ff_corpus_chunk))
+			|| !fits(h->string_offset, h->string_size, 1)
+			|| !fits(h->decision_offset, h->decision_size, 1)
+			|| h->file_offset % 8 || h->chunk_offset % 4
+			|| h->string_size == 0 || data[h->string_offset + h->string_size - 1] != '\0')
+		return false;
+	const ff_corpus_file *files = (const ff_corpus_file *) (data + h->file_offset);
+	for (uint64_t i = 0; i < h->file_count; ++i) {
+		const ff_corpus_file& f = files[i];
+		uint64_t count = (uint64_t) f.insertion_points + f.deletable_chunks + f.optional_chunks + f.non_optional_chunks;
+		if (f.name >= h->string_size || f.chunks > h->chunk_count || count > h->chunk_count - f.chunks
+				|| f.decisions > h->decision_size || f.decision_size > h->decision_size - f.decisions)
+			return false;
+	}
+	const ff_corpus_chunk *chunks = (const ff_corpus_chunk *) (data + h->chunk_offset);
+	for (uint64_t i = 0; i < h->chunk_count; ++i) {
+		if (chunks[i].type >= h->string_size || chunks[i].name >= h->string_size)
+			return false;
+	}
+	return true;
+}
+
+// load_corpus - add the files of the chunk database `path' (written by
+// save_corpus()) to the chunk corpus, without parsing them again.  The
+// database is mapped into memory; chunk names and decisions point into
+// the mapping until reset_corpus().  Returns the number of files added,
+// or -1 if the database cannot be read or was made from another version
+// of the template.
+extern "C" int load_corpus(const char *path) {
+	int file_fd = open(path, O_RDONLY);
+	if (file_fd == -1)
+		return -1;
+	struct stat st;
+	void *map = MAP_FAILED;
+	if (fstat(file_fd, &st) == 0 && st.st_size > 0)
+		map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, file_fd, 0);
 	close(file_fd);
-	return size;
+	if (map == MAP_FAILED)
+		return -1;
+	const unsigned char *data = (const unsigned char *) map;
+	if (!check_corpus(data, st.st_size)) {
+		munmap(map, st.st_size);
+		return -1;
+	}
+	corpus_mappings.push_back({map, (size_t) st.st_size});
+
+	const ff_corpus_header *h = (const ff_corpus_header *) data;
+	const ff_corpus_file *files = (const ff_corpus_file *) (data + h->file_offset);
+	const ff_corpus_chunk *chunks = (const ff_corpus_chunk *) (data + h->chunk_offset);
+	const char *strings = (const char *) data + h->string_offset;
+	const unsigned char *decisions = data + h->decision_offset;
+	rand_names.reserve(rand_names.size() + h->file_count);
+	rand_data.reserve(rand_data.size() + h->file_count);
+	seed_hashes.reserve(seed_hashes.size() + h->file_count);
+	insertion_points.reserve(insertion_points.size() + h->file_count);
+	deletable_chunks.reserve(deletable_chunks.size() + h->file_count);
+	non_optional_index.reserve(non_optional_index.size() + h->file_count);
+	optional_index.reserve(optional_index.size() + h->file_count);
+	// Size the chunk tables up front rather than growing them chunk by chunk
+	std::unordered_map<uint32_t, size_t> type_counts;
+	size_t optional_count = 0;
+	for (uint64_t i = 0; i < h->file_count; ++i) {
+		const ff_corpus_file& f = files[i];
+		optional_count += f.optional_chunks;
+		const ff_corpus_chunk *c = chunks + f.chunks + f.insertion_points + f.deletable_chunks + f.optional_chunks;
+		for (unsigned j = 0; j < f.non_optional_chunks; ++j)
+			++type_counts[c[j].type];
+	}
+	optional_chunks.reserve(optional_chunks.size() + optional_count);
+	for (auto& t : type_counts) {
+		std::vector<Chunk>& typed = non_optional_chunks[chunk_type_id(strings + t.first)];
+		typed.reserve(typed.size() + t.second);
+	}
+	file_chunks found;
+	for (uint64_t i = 0; i < h->file_count; ++i) {
+		const ff_corpus_file& f = files[i];
+		const ff_corpus_chunk *c = chunks + f.chunks;
+		found.clear();
+		for (unsigned j = 0; j < f.insertion_points; ++j, ++c)
+			found.insertion_points.emplace_back(c->start, strings + c->type, strings + c->name);
+		for (unsigned j = 0; j < f.deletable_chunks; ++j, ++c)
+			found.deletable_chunks.emplace_back(file_index, c->start, c->end, strings + c->type, strings + c->name);
+		for (unsigned j = 0; j < f.optional_chunks; ++j, ++c)
+			found.optional_chunks.emplace_back(file_index, c->start, c->end, strings + c->type, strings + c->name);
+		for (unsigned j = 0; j < f.non_optional_chunks; ++j, ++c)
+			found.non_optional_chunks.emplace_back(file_index, c->start, c->end, strings + c->type, strings + c->name);
+		rand_names.push_back(strings + f.name);
+		add_file_chunks(found);
+		rand_data.push_back({decisions + f.decisions, f.decision_size, false, true});
+		seed_hashes.push_back(f.seed_hash);
+		++file_index;
+	}
+	return h->file_count;
 }
 
-char mutation_info[1024];
-char* print_pos = mutation_info;
-size_t buf_size = 1024;
+// reset_corpus - remove all files from the chunk corpus, so that long
+// running mutators can bound its memory.  File indices start again at 0.
+extern "C" void reset_corpus() {
+	for (Decisions& d : rand_data) {
+		if (d.in_database)
+			continue;
+		if (d.mapped)
+			munmap((void *) d.data, d.size);
+		else
+			delete[] d.data;
+	}
+	rand_data.clear();
+	seed_hashes.clear();
+	rand_names.clear();
+	insertion_points.clear();
+	deletable_chunks.clear();
+	optional_chunks.clear();
+	optional_index = { 0 };
+	non_optional_chunks.clear();
+	non_optional_index.clear();
+	chunk_types.clear();
+	type_ids.clear();
+	type_addresses.clear();
+	optional_pools.clear();
+	non_optional_pools.clear();
+	for (corpus_mapping& m : corpus_mappings)
+		munmap(m.data, m.size);
+	corpus_mappings.clear();
+	file_index = 0;
+}
+
+thread_local char mutation_info[1024];
+thread_local char* print_pos = mutation_info;
+thread_local size_t buf_size = 1024;
 
 void reset_info() {
 	print_pos = mutation_info;
@@ -1305,68 +2008,62 @@ void log_info(const char * fmt, ...) {
 
 
 extern "C" void generate_random_file(unsigned char** file, unsigned* file_size) {
-	int rand_fd = open("/dev/urandom", O_RDONLY);
-	ssize_t r = read(rand_fd, rand_buffer, MAX_RAND_SIZE);
-	if (r != MAX_RAND_SIZE)
-		printf("Read only %ld bytes from /dev/urandom\n", r);
-	close(rand_fd);
-
 	set_generator();
-	*file_size = ff_generate(rand_buffer, MAX_RAND_SIZE, file);
+	*file_size = ff_generate_seed(((uint64_t) mutation_rng() << 32) | mutation_rng(), file);
 }
 
 
 
-extern "C" int one_smart_mutation(int target_file_index, unsigned char** file, unsigned* file_size) {
-	static unsigned char *original_rand_t = NULL;
-	static unsigned char *rand_t = NULL;
-	static unsigned char *rand_s = NULL;
+// Apply one random smart mutation to corpus file target_file_index.  If
+// source_file_index is not -1, the mutation replaces or inserts a chunk
+// taken from that file.
+static int smart_mutation_from(int target_file_index, int source_file_index, unsigned char** file, unsigned* file_size) {
+	static thread_local unsigned char *rand_t = NULL;
+	static thread_local unsigned char *rand_s = NULL;
+	static thread_local unsigned capacity_t = MAX_RAND_SIZE;
+	static thread_local unsigned capacity_s = MAX_RAND_SIZE;
 	if (!rand_t) {
-		original_rand_t = new unsigned char[MAX_RAND_SIZE];
 		rand_t = new unsigned char[MAX_RAND_SIZE];
 		rand_s = new unsigned char[MAX_RAND_SIZE];
-		int rand_fd = open("/dev/urandom", O_RDONLY);
-		ssize_t r = read(rand_fd, rand_t, MAX_RAND_SIZE);
-		if (r != MAX_RAND_SIZE)
-			printf("Read only %ld bytes from /dev/urandom\n", r);
-		close(rand_fd);
-	}
-	static int previous_file_index = -1;
-	static unsigned len_t = 0;
-	if (target_file_index != previous_file_index) {
-		len_t = read_rand_file(rand_names[target_file_index].c_str(), original_rand_t);
-		previous_file_index = target_file_index;
+		random_fill(rand_t, MAX_RAND_SIZE);
 	}
+	const unsigned char *original_rand_t = rand_data[target_file_index].data;
+	unsigned len_t = rand_data[target_file_index].size;
 
 	reset_info();
 	bool old_debug_print = debug_print;
-	switch (rand() % (deletable_chunks[target_file_index].size() ? 10 : 9)) {
+	int mutations = source_file_index != -1 ? 5 : deletable_chunks[target_file_index].size() ? 10 : 9;
+	switch (mutation_rng() % mutations) {
 	case 0:
 	{
 		if (non_optional_index[target_file_index].size() == 0)
 			goto fail;
-		NonOptional& no = non_optional_index[target_file_index][rand() % non_optional_index[target_file_index].size()];
+		NonOptional& no = non_optional_index[target_file_index][mutation_rng() % non_optional_index[target_file_index].size()];
 		if (no.size == 0)
 			goto fail;
-		int chunk_index = no.start + rand() % no.size;
-		Chunk& t = non_optional_chunks[no.type][chunk_index];
-		if (non_optional_chunks[no.type].size() == 0)
-			goto fail;
-		Chunk& s = non_optional_chunks[no.type][rand() % non_optional_chunks[no.type].size()];
+		int chunk_index = no.start + mutation_rng() % no.size;
+		std::vector<Chunk>& chunks = non_optional_chunks[no.type_id];
+		Chunk& t = chunks[chunk_index];
+		int source_index;
+		if (source_file_index != -1) {
+			auto source = std::find_if(non_optional_index[source_file_index].begin(), non_optional_index[source_file_index].end(),
+				[&](const NonOptional& n) { return n.type_id == no.type_id; });
+			if (source == non_optional_index[source_file_index].end() || source->size == 0)
+				goto fail;
+			source_index = source->start + mutation_rng() % source->size;
+		} else {
+			source_index = non_optional_pools[no.type_id].pick(t);
+		}
+		Chunk& s = chunks[source_index];
 		log_info("Replacing: source non-optional chunk from file %d position %u %u %s %s\ninto target file %d non-optional chunk position %u %u %s %s\n", s.file_index, s.start, s.end, s.type, s.name, t.file_index, t.start, t.end, t.type, t.name);
+		reserve_rand(rand_t, capacity_t, len_t);
 		memcpy(rand_t, original_rand_t, len_t);
-		read_rand_file(rand_names[s.file_index].c_str(), rand_s);
+		const unsigned char *source = rand_data[s.file_index].data;
 
 		unsigned rand_size = len_t + (s.end - s.start) - (t.end - t.start);
-		if (rand_size > MAX_RAND_SIZE) {
-			*file = NULL;
-			*file_size = 0;
-			if (debug_print)
-				printf("rand_size insufficient for smart mutation\n");
-			return -2;
-		}
+		reserve_rand(rand_t, capacity_t, rand_size);
 		memmove(rand_t + t.start + s.end + 1 - s.start, rand_t + t.end + 1, len_t - (t.end + 1));
-		memcpy(rand_t + t.start, rand_s + s.start, s.end + 1 - s.start);
+		memcpy(rand_t + t.start, source + s.start, s.end + 1 - s.start);
 
 		smart_mutation = true;
 		get_parse_tree = true;
@@ -1378,7 +2075,7 @@ extern "C" int one_smart_mutation(int target_file_index, unsigned char** file, u
 
 		*file = NULL;
 		debug_print = false;
-		*file_size = ff_generate(rand_t, MAX_RAND_SIZE, file);
+		*file_size = ff_generate(rand_t, capacity_t, file);
 		smart_mutation = false;
 		get_parse_tree = false;
 		debug_print = old_debug_print;
@@ -1401,25 +2098,25 @@ extern "C" int one_smart_mutation(int target_file_index, unsigned char** file, u
 	{
 		if ((optional_index[target_file_index+1] - optional_index[target_file_index]) == 0)
 			goto fail;
-		int chunk_index = optional_index[target_file_index] + rand() % (optional_index[target_file_index+1] - optional_index[target_file_index]);
+		int chunk_index = optional_index[target_file_index] + mutation_rng() % (optional_index[target_file_index+1] - optional_index[target_file_index]);
 		Chunk& t = optional_chunks[chunk_index];
-		if (optional_chunks.size() == 0)
+		int source_index;
+		if (source_file_index != -1)
+			source_index = pick_optional_chunk(source_file_index, t.type_id);
+		else
+			source_index = optional_pools[t.type_id].pick(t);
+		if (source_index == -1)
 			goto fail;
-		Chunk& s = optional_chunks[rand() % optional_chunks.size()];
+		Chunk& s = optional_chunks[source_index];
 		log_info("Replacing: source optional chunk from file %d position %u %u %s %s\ninto target file %d optional chunk position %u %u %s %s\n", s.file_index, s.start, s.end, s.type, s.name, t.file_index, t.start, t.end, t.type, t.name);
+		reserve_rand(rand_t, capacity_t, len_t);
 		memcpy(rand_t, original_rand_t, len_t);
-		read_rand_file(rand_names[s.file_index].c_str(), rand_s);
+		const unsigned char *source = rand_data[s.file_index].data;
 
 		unsigned rand_size = len_t + (s.end - s.start) - (t.end - t.start);
-		if (rand_size > MAX_RAND_SIZE) {
-			*file = NULL;
-			*file_size = 0;
-			if (debug_print)
-				printf("rand_size insufficient for smart mutation\n");
-			return -2;
-		}
+		reserve_rand(rand_t, capacity_t, rand_size);
 		memmove(rand_t + t.start + s.end + 1 - s.start, rand_t + t.end + 1, len_t - (t.end + 1));
-		memcpy(rand_t + t.start, rand_s + s.start, s.end + 1 - s.start);
+		memcpy(rand_t + t.start, source + s.start, s.end + 1 - s.start);
 
 		smart_mutation = true;
 		get_parse_tree = true;
@@ -1431,7 +2128,7 @@ extern "C" int one_smart_mutation(int target_file_index, unsigned char** file, u
 
 		*file = NULL;
 		debug_print = false;
-		*file_size = ff_generate(rand_t, MAX_RAND_SIZE, file);
+		*file_size = ff_generate(rand_t, capacity_t, file);
 		smart_mutation = false;
 		get_parse_tree = false;
 		debug_print = old_debug_print;
@@ -1455,24 +2152,27 @@ extern "C" int one_smart_mutation(int target_file_index, unsigned char** file, u
 	{
 		if (insertion_points[target_file_index].size() == 0)
 			goto fail;
-		InsertionPoint& ip = insertion_points[target_file_index][rand() % insertion_points[target_file_index].size()];
-		if (optional_chunks.size() == 0)
+		InsertionPoint& ip = insertion_points[target_file_index][mutation_rng() % insertion_points[target_file_index].size()];
+		// Insert a chunk of the type found at the insertion point, if any
+		int source_index = -1;
+		if (source_file_index != -1)
+			source_index = pick_optional_chunk(source_file_index, ip.type_id);
+		else if (!optional_pools[ip.type_id].chunks.empty())
+			source_index = optional_pools[ip.type_id].chunks[mutation_rng() % optional_pools[ip.type_id].chunks.size()];
+		else if (!optional_chunks.empty())
+			source_index = mutation_rng() % optional_chunks.size();
+		if (source_index == -1)
 			goto fail;
-		Chunk& s = optional_chunks[rand() % optional_chunks.size()];
+		Chunk& s = optional_chunks[source_index];
 		log_info("Inserting: source chunk from file %d position %u %u %s %s\ninto target file %d position %u %s %s\n", s.file_index, s.start, s.end, s.type, s.name, target_file_index, ip.pos, ip.type, ip.name);
+		reserve_rand(rand_t, capacity_t, len_t);
 		memcpy(rand_t, original_rand_t, len_t);
-		read_rand_file(rand_names[s.file_index].c_str(), rand_s);
+		const unsigned char *source = rand_data[s.file_index].data;
 
 		unsigned rand_size = len_t + (s.end + 1 - s.start);
-		if (rand_size > MAX_RAND_SIZE) {
-			*file = NULL;
-			*file_size = 0;
-			if (debug_print)
-				printf("rand_size insufficient for smart mutation\n");
-			return -2;
-		}
+		reserve_rand(rand_t, capacity_t, rand_size);
 		memmove(rand_t + ip.pos + s.end + 1 - s.start, rand_t + ip.pos, len_t - ip.pos);
-		memcpy(rand_t + ip.pos, rand_s + s.start, s.end + 1 - s.start);
+		memcpy(rand_t + ip.pos, source + s.start, s.end + 1 - s.start);
 
 		smart_mutation = true;
 		get_parse_tree = true;
@@ -1484,7 +2184,7 @@ extern "C" int one_smart_mutation(int target_file_index, unsigned char** file, u
 
 		*file = NULL;
 		debug_print = false;
-		*file_size = ff_generate(rand_t, MAX_RAND_SIZE, file);
+		*file_size = ff_generate(rand_t, capacity_t, file);
 		smart_mutation = false;
 		get_parse_tree = false;
 		debug_print = old_debug_print;
@@ -1510,14 +2210,14 @@ extern "C" int one_smart_mutation(int target_file_index, unsigned char** file, u
 	{
 		int start_t = -1;
 		int end_t = -1;
-		if (rand() % 2) {
+		if (mutation_rng() % 2) {
 			if (non_optional_index[target_file_index].size() == 0)
 				goto fail;
-			NonOptional& no = non_optional_index[target_file_index][rand() % non_optional_index[target_file_index].size()];
+			NonOptional& no = non_optional_index[target_file_index][mutation_rng() % non_optional_index[target_file_index].size()];
 			if (no.size == 0)
 				goto fail;
-			int chunk_index = no.start + rand() % no.size;
-			Chunk& t = non_optional_chunks[no.type][chunk_index];
+			int chunk_index = no.start + mutation_rng() % no.size;
+			Chunk& t = non_optional_chunks[no.type_id][chunk_index];
 			log_info("Abstracting from file %d non-optional chunk %u %u %s %s\n", t.file_index, t.start, t.end, t.type, t.name);
 			start_t = t.start;
 			end_t = t.end;
@@ -1526,7 +2226,7 @@ extern "C" int one_smart_mutation(int target_file_index, unsigned char** file, u
 		} else {
 			if ((optional_index[target_file_index+1] - optional_index[target_file_index]) == 0)
 				goto fail;
-			int chunk_index = optional_index[target_file_index] + rand() % (optional_index[target_file_index+1] - optional_index[target_file_index]);
+			int chunk_index = optional_index[target_file_index] + mutation_rng() % (optional_index[target_file_index+1] - optional_index[target_file_index]);
 			Chunk& t = optional_chunks[chunk_index];
 			log_info("Abstracting from file %d optional chunk %u %u %s %s\n", t.file_index, t.start, t.end, t.type, t.name);
 			start_t = t.start;
@@ -1534,17 +2234,15 @@ extern "C" int one_smart_mutation(int target_file_index, unsigned char** file, u
 			is_optional = true;
 			chunk_name = t.name;
 		}
+		reserve_rand(rand_t, capacity_t, len_t);
 		memcpy(rand_t, original_rand_t, len_t);
 
 		following_rand_size = len_t - (end_t + 1);
+		reserve_rand(rand_s, capacity_s, following_rand_size);
 		following_rand_buffer = rand_s;
 		memcpy(following_rand_buffer, rand_t + end_t + 1, following_rand_size);
 
-		int rand_fd = open("/dev/urandom", O_RDONLY);
-		ssize_t r = read(rand_fd, rand_t + start_t, len_t - start_t);
-		if (r != len_t - start_t)
-			printf("Read only %ld bytes from /dev/urandom\n", r);
-		close(rand_fd);
+		random_fill(rand_t + start_t, len_t - start_t);
 
 		smart_abstraction = true;
 		get_parse_tree = true;
@@ -1553,7 +2251,7 @@ extern "C" int one_smart_mutation(int target_file_index, unsigned char** file, u
 
 		*file = NULL;
 		debug_print = false;
-		*file_size = ff_generate(rand_t, MAX_RAND_SIZE, file);
+		*file_size = ff_generate(rand_t, capacity_t, file);
 		get_parse_tree = false;
 		debug_print = old_debug_print;
 		if (smart_abstraction) {
@@ -1578,9 +2276,10 @@ extern "C" int one_smart_mutation(int target_file_index, unsigned char** file, u
 	{
 		if (deletable_chunks[target_file_index].size() == 0)
 			goto fail;
-		int index = rand() % deletable_chunks[target_file_index].size();
+		int index = mutation_rng() % deletable_chunks[target_file_index].size();
 		Chunk& t = deletable_chunks[target_file_index][index];
 		log_info("Deleting from file %d chunk %u %u %s %s\n", t.file_index, t.start, t.end, t.type, t.name);
+		reserve_rand(rand_t, capacity_t, len_t);
 		memcpy(rand_t, original_rand_t, len_t);
 
 		memmove(rand_t + t.start, rand_t + t.end + 1, len_t - (t.end + 1));
@@ -1591,7 +2290,7 @@ extern "C" int one_smart_mutation(int target_file_index, unsigned char** file, u
 
 		*file = NULL;
 		debug_print = false;
-		*file_size = ff_generate(rand_t, MAX_RAND_SIZE, file);
+		*file_size = ff_generate(rand_t, capacity_t, file);
 		debug_print = old_debug_print;
 		if (!(*file) || !(*file_size)) {
 			log_info("Failed to generate mutated file!\n");
@@ -1614,35 +2313,216 @@ fail:
 	return -2;
 }
 
+extern "C" int one_smart_mutation(int target_file_index, unsigned char** file, unsigned* file_size) {
+	return smart_mutation_from(target_file_index, -1, file, file_size);
+}
+
+// Like one_smart_mutation(), but the new chunk comes from corpus file
+// source_file_index
+extern "C" int smart_crossover(int target_file_index, int source_file_index, unsigned char** file, unsigned* file_size) {
+	return smart_mutation_from(target_file_index, source_file_index, file, file_size);
+}
+
+// Add FILES to the chunk corpus on `jobs' threads, writing the decisions
+// of each FILE to FILE-decisions.  With a chunk database `db', the files
+// in the database are loaded first, seeds found in it are not parsed
+// again, and the database is updated with the new ones.  Returns the
+// number of seeds that were parsed completely or found in the database.
+static int import_files(const char *db, char **files, unsigned count, unsigned jobs)
+{
+	int loaded = 0;
+	std::set<uint64_t> known;
+	if (db) {
+		uint64_t start = get_cur_time_us();
+		loaded = load_corpus(db);
+		uint64_t end = get_cur_time_us();
+		if (loaded >= 0) {
+			fprintf(stderr, "%s: loaded %d files from %s in %f s\n", bin_name, loaded, db, (end - start) / 1.0e6);
+			known.insert(seed_hashes.end() - loaded, seed_hashes.end());
+		} else if (access(db, F_OK) == 0) {
+			fprintf(stderr, "%s: %s is not a chunk database of this template; rebuilding it\n", bin_name, db);
+		}
+	}
+
+	std::vector<std::string> rand_files;
+	std::vector<const char*> file_names, rand_file_names;
+	for (unsigned i = 0; i < count; ++i) {
+		if (!known.empty() && known.count(hash_file(files[i])))
+			continue;
+		rand_files.push_back(std::string(files[i]) + "-decisions");
+		file_names.push_back(files[i]);
+	}
+	for (std::string& rand_file : rand_files)
+		rand_file_names.push_back(rand_file.c_str());
+	int complete = count - file_names.size();
+	if (!file_names.empty()) {
+		complete += process_files(file_names.data(), rand_file_names.data(), file_names.size(), jobs);
+		if (db && save_corpus(db) == 0)
+			fprintf(stderr, "%s: saved %zu files to %s\n", bin_name, rand_data.size(), db);
+	}
+	return complete;
+}
+
+// mutations - apply smart mutations to a seed corpus and report how many
+// of them are wasted, i.e. generate no file or a file that cannot be
+// parsed back completely
 int mutations(int argc, char **argv)
 {
-	srand(time(NULL));
-	for (int i = 1; i < argc; ++i) {
-		char *file_name = argv[i];
-		std::string rand_name = std::string(file_name) + "-decisions";
-		process_file(file_name, rand_name.c_str());
+	const char *db = NULL;
+	int count = 10000;
+
+	// Process options
+	while (1)
+	{
+		static struct option long_options[] =
+			{
+				{"help", no_argument, 0, 'h'},
+				{"db", required_argument, 0, 'b'},
+				{"count", required_argument, 0, 'n'},
+				{0, 0, 0, 0}};
+		int option_index = 0;
+		int c = getopt_long(argc, argv, "b:n:",
+							long_options, &option_index);
+
+		// Detect the end of the options.
+		if (c == -1)
+			break;
+
+		switch (c)
+		{
+		case 'h':
+		case '?':
+			fprintf(stderr, "mutations: usage: mutations [--db DB] [--count N] FILES...\n");
+			fprintf(stderr, "Imports FILES into the chunk corpus, applies smart mutations to them\n");
+			fprintf(stderr, "in turn and reports how many generate no valid file and how many\n");
+			fprintf(stderr, "consume more or fewer decisions than expected.\n");
+			fprintf(stderr, "Options:\n");
+			fprintf(stderr, "--db DB: Use the chunk database DB (see `import')\n");
+			fprintf(stderr, "--count N: Apply N mutations (default: 10000)\n");
+			return 0;
+
+		case 'b':
+			db = optarg;
+			break;
+		case 'n':
+			count = atoi(optarg);
+			if (count <= 0) {
+				fprintf(stderr, "%s: --count must be positive\n", bin_name);
+				return 1;
+			}
+			break;
+		}
+	}
+
+	import_files(db, argv + optind, argc - optind, std::max(std::thread::hardware_concurrency(), 1U));
+	if (rand_names.empty()) {
+		fprintf(stderr, "%s: no files to mutate\n", bin_name);
+		return 1;
 	}
 	unsigned char* file;
 	unsigned size;
+	unsigned char* rand;
+	size_t rand_size;
 	debug_print = false; // disabled for testing
 	print_errors = true;
-	for (int i = 0; i < 10000; ++i) {
+	// Wasted mutations generated no file, or a file that does not parse
+	// back completely.  Counted apart from them are the generated files
+	// whose new chunk consumed more or fewer decisions than expected.
+	int failed = 0, invalid = 0, resized = 0;
+	for (int i = 0; i < count; ++i) {
 		int result = one_smart_mutation(i % rand_names.size(), &file, &size);
-		if (debug_print)
-			printf("%d\n", result);
-	}
+		if (!file || !size) {
+			++failed;
+			continue;
+		}
+		if (result != 0)
+			++resized;
+		if (!ff_parse(file, size, &rand, &rand_size) || get_validity() != 1.0)
+			++invalid;
+	}
+	int wasted = failed + invalid;
+	fprintf(stderr, "%s: %d of %d mutations wasted (%.1f%%): %d failed, %d invalid\n",
+		bin_name, wasted, count, 100.0 * wasted / count, failed, invalid);
+	fprintf(stderr, "%s: %d of %d mutations consumed more or fewer decisions than expected (%.1f%%)\n",
+		bin_name, resized, count, 100.0 * resized / count);
 	return 0;
 }
 
+// import - add a seed corpus to the chunk corpus
+int import(int argc, char **argv)
+{
+	unsigned jobs = std::max(std::thread::hardware_concurrency(), 1U);
+	const char *db = NULL;
+
+	// Process options
+	while (1)
+	{
+		static struct option long_options[] =
+			{
+				{"help", no_argument, 0, 'h'},
+				{"jobs", required_argument, 0, 'j'},
+				{"db", required_argument, 0, 'b'},
+				{0, 0, 0, 0}};
+		int option_index = 0;
+		int c = getopt_long(argc, argv, "j:b:",
+							long_options, &option_index);
+
+		// Detect the end of the options.
+		if (c == -1)
+			break;
+
+		switch (c)
+		{
+		case 'h':
+		case '?':
+			fprintf(stderr, "import: usage: import [--jobs N] [--db DB] FILES...\n");
+			fprintf(stderr, "Parses FILES into the chunk corpus used by smart mutations,\n");
+			fprintf(stderr, "writing the decisions of each FILE to FILE-decisions.\n");
+			fprintf(stderr, "Options:\n");
+			fprintf(stderr, "--jobs N: Parse on N threads (default: all cores)\n");
+			fprintf(stderr, "--db DB: Load the chunk database DB first, only parse FILES\n");
+			fprintf(stderr, "         not in it, and save the corpus to DB\n");
+			return 0;
+
+		case 'j':
+			jobs = strtoul(optarg, NULL, 10);
+			if (jobs == 0) {
+				fprintf(stderr, "%s: --jobs must be positive\n", bin_name);
+				return 1;
+			}
+			break;
+		case 'b':
+			db = optarg;
+			break;
+		}
+	}
+
+	if (optind >= argc && !db) {
+		fprintf(stderr, "%s: missing files to import\n", bin_name);
+		return 1;
+	}
+
+	unsigned count = argc - optind;
+	uint64_t start = get_cur_time_us();
+	int complete = import_files(db, argv + optind, count, jobs);
+	uint64_t end = get_cur_time_us();
+	double time = (end - start) / 1.0e6;
+	size_t non_optional = 0;
+	for (auto& chunks : non_optional_chunks)
+		non_optional += chunks.size();
+	fprintf(stderr, "%s: imported %u files (%d parsed completely) with %u jobs in %f s (%f / s)\n",
+		bin_name, count, complete, jobs, time, count / time);
+	fprintf(stderr, "%s: %zu files, %zu optional chunks, %zu non-optional chunks of %zu types\n",
+		bin_name, rand_data.size(), optional_chunks.size(), non_optional, chunk_types.size());
+	return complete != (int) count;
+}
+
 
 int test(int argc, char *argv[])
 {
 	print_errors = true;
-	int rand_fd = open("/dev/urandom", O_RDONLY);
-	unsigned char *data = new unsigned char[MAX_RAND_SIZE];
-	ssize_t r = read(rand_fd, data, MAX_RAND_SIZE);
-	if (r != MAX_RAND_SIZE)
-		printf("Read only %ld bytes from /dev/urandom\n", r);
+	std::random_device rd;
+	uint64_t seed = ((uint64_t) rd() << 32) | rd();
 	unsigned char *contents = new unsigned char[MAX_FILE_SIZE];
 	unsigned char* file = NULL;
 	size_t file_size;
@@ -1656,9 +2536,7 @@ int test(int argc, char *argv[])
 	uint64_t parse_time = 0;
 	for (i = 0; i < iterations; ++i)
 	{
-		ssize_t r = read(rand_fd, data, 4096);
-		assert(r == 4096);
-		file_size = ff_generate(data, MAX_RAND_SIZE, &file);
+		file_size = ff_generate_seed(seed + i, &file);
 		if (file_size && file) {
 			generated += 1;
 			uint64_t before = get_cur_time_us();
@@ -1685,28 +2563,29 @@ int test(int argc, char *argv[])
 		}
 	}
 	if (i != iterations) {
-		write_file("r0", data, MAX_RAND_SIZE);
 		write_file("f0", contents, file_size);
 		write_file("r1", rand, rand_size);
 		if (file)
 			write_file("f1", file, new_file_size);
+		// Take the original decisions again
+		printf("Seed %llu\n", (unsigned long long) (seed + i));
+		ff_generate_seed(seed + i, &file);
+		std::vector<unsigned char> data(consumedRand());
+		copy_rand(data.data());
+		write_file("r0", data.data(), data.size());
 	}
 	uint64_t end = get_cur_time_us();
 	double time = (end - start) / 1.0e6;
 	double ptime = parse_time / 1.0e6;
 	printf("Tested %d files from %d attempts in %f s (parsing speed %f / s).\n", generated, i, time, generated / ptime);
-	delete[] data;
 	delete[] contents;
 	return 0;
 }
 
 int benchmark(int argc, char *argv[])
 {
-	int rand_fd = open("/dev/urandom", O_RDONLY);
-	unsigned char *data =  new unsigned char[MAX_RAND_SIZE];
-	ssize_t r = read(rand_fd, data, MAX_RAND_SIZE);
-	if (r != MAX_RAND_SIZE)
-		printf("Read only %ld bytes from /dev/urandom\n", r);
+	std::random_device rd;
+	uint64_t seed = ((uint64_t) rd() << 32) | rd();
 	unsigned char* new_data = NULL;
 	int generated = 0;
 	int valid = 0;
@@ -1720,9 +2599,7 @@ int benchmark(int argc, char *argv[])
 	uint64_t start = get_cur_time_us();
 	for (i = 0; i < iterations; ++i)
 	{
-		ssize_t r = read(rand_fd, data, 4096);
-		assert(r == 4096);
-		size_t new_size = ff_generate(data, MAX_RAND_SIZE, &new_data);
+		size_t new_size = ff_generate_seed(seed + i, &new_data);
 		if (new_size && new_data) {
 			generated += 1;
 			total_bytes += new_size;
@@ -1750,7 +2627,175 @@ int benchmark(int argc, char *argv[])
 	if (generated)
 		printf("Average file size %lu bytes.\n", total_bytes / generated);
 	printf("Speed %f / s.\n", generated / time);
-	delete[] data;
+	return 0;
+}
+
+// checksums - compare and time the reference and fast checksum kernels
+int checksum_benchmark(int argc, char *argv[])
+{
+	static const char* names[CHECKSUM_TYPES] = {
+		"BYTE", "SHORT_LE", "SHORT_BE", "INT_LE", "INT_BE", "INT64_LE", "INT64_BE",
+		"SUM8", "SUM16", "SUM32", "SUM64", "CRC16", "CRCCCITT", "CRC32", "ADLER32"
+	};
+	size_t size = argc > 1 ? strtoul(argv[1], NULL, 0) : 1 << 20;
+	std::vector<unsigned char> data(size + 64);
+	std::mt19937_64 rng(size);
+	for (auto& b : data)
+		b = rng();
+	// Check all lengths and alignments near the kernel block sizes
+	int errors = 0;
+	for (int type = 0; type < CHECKSUM_TYPES; ++type)
+		for (size_t off = 0; off < 16; ++off)
+			for (size_t len = 0; len < 300 && off + len <= data.size(); ++len)
+				if (ff_checksum(type, &data[off], len, true) != ff_checksum(type, &data[off], len, false)) {
+					fprintf(stderr, "%s: mismatch at offset %zu, length %zu\n", names[type], off, len);
+					++errors;
+					break;
+				}
+	// Known answers for "123456789" (CRC16 is CRC-16/ARC, CRCCCITT is
+	// CRC-16/CCITT-FALSE)
+	static const struct { int type; uint64_t check; } answers[] = {
+		{ CHECKSUM_CRC16, 0xBB3D }, { CHECKSUM_CRCCCITT, 0x29B1 },
+		{ CHECKSUM_CRC32, 0xCBF43926 }, { CHECKSUM_ADLER32, 0x091E01DE },
+		{ CHECKSUM_SUM8, 0xDD }, { CHECKSUM_SUM16, 0x01DD }
+	};
+	for (auto& a : answers)
+		for (int simd = 0; simd < 2; ++simd)
+			if (ff_checksum(a.type, (const unsigned char *) "123456789", 9, simd) != a.check) {
+				fprintf(stderr, "%s: wrong checksum of \"123456789\"\n", names[a.type]);
+				++errors;
+			}
+	int rounds = std::max<size_t>(1, (256 << 20) / std::max<size_t>(size, 1));
+	printf("%-10s %15s %12s  %s\n", "checksum", "reference MB/s", "fast MB/s", "fast kernel");
+	for (int type = 0; type < CHECKSUM_TYPES; ++type) {
+		double speed[2];
+		uint64_t result[2];
+		for (int simd = 0; simd < 2; ++simd) {
+			result[simd] = 0;
+			uint64_t start = get_cur_time_us();
+			for (int i = 0; i < rounds; ++i)
+				result[simd] += ff_checksum(type, data.data(), size, simd);
+			uint64_t end = get_cur_time_us();
+			speed[simd] = (double) size * rounds / std::max<uint64_t>(end - start, 1);
+		}
+		if (result[0] != result[1]) {
+			fprintf(stderr, "%s: mismatch on %zu bytes\n", names[type], size);
+			++errors;
+		}
+		printf("%-10s %15.0f %12.0f  %s\n", names[type], speed[0], speed[1], ff_checksum_kernel(type));
+	}
+	return errors != 0;
+}
+
+extern "C" void ff_use_buffers(unsigned char* file, size_t file_limit, unsigned char* rand, size_t rand_limit);
+
+// serve - answer generate/parse requests through shared memory
+int serve(int argc, char **argv)
+{
+	const char *shm_path = NULL;
+	unsigned file_limit = MAX_FILE_SIZE_LIMIT;
+	unsigned rand_limit = MAX_RAND_SIZE_LIMIT;
+
+	// Process options
+	while (1)
+	{
+		static struct option long_options[] =
+			{
+				{"help", no_argument, 0, 'h'},
+				{"shm", required_argument, 0, 's'},
+				{"file-size", required_argument, 0, 'f'},
+				{"decision-size", required_argument, 0, 'r'},
+				{0, 0, 0, 0}};
+		int option_index = 0;
+		int c = getopt_long(argc, argv, "",
+							long_options, &option_index);
+
+		// Detect the end of the options.
+		if (c == -1)
+			break;
+
+		switch (c)
+		{
+		case 'h':
+		case '?':
+			fprintf(stderr, "serve: usage: serve --shm PATH [--file-size N] [--decision-size N]\n");
+			fprintf(stderr, "Creates the shared memory file PATH (e.g. /dev/shm/ff0) holding the\n");
+			fprintf(stderr, "decision and file buffers, then serves requests from standard input.\n");
+			fprintf(stderr, "See struct ff_shm_header in formatfuzzer.h for the protocol.\n");
+			fprintf(stderr, "Options:\n");
+			fprintf(stderr, "--file-size N: Size of the file buffer (default %u)\n", file_limit);
+			fprintf(stderr, "--decision-size N: Size of the decision buffer (default %u)\n", rand_limit);
+			return 0;
+
+		case 's':
+			shm_path = optarg;
+			break;
+		case 'f':
+			file_limit = std::max(strtoul(optarg, NULL, 0), (unsigned long) MAX_FILE_SIZE);
+			break;
+		case 'r':
+			rand_limit = std::max(strtoul(optarg, NULL, 0), (unsigned long) MAX_RAND_SIZE);
+			break;
+		}
+	}
+
+	if (!shm_path) {
+		fprintf(stderr, "%s: missing --shm PATH\n", bin_name);
+		return 1;
+	}
+
+	size_t page = sysconf(_SC_PAGESIZE);
+	ff_shm_header header;
+	header.magic = FF_SHM_MAGIC;
+	header.rand_offset = page;
+	header.rand_limit = rand_limit;
+	header.file_offset = (page + rand_limit + page - 1) / page * page;
+	header.file_limit = file_limit;
+	size_t shm_size = header.file_offset + (size_t) file_limit;
+
+	int shm_fd = open(shm_path, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+	if (shm_fd == -1 || ftruncate(shm_fd, shm_size) == -1) {
+		perror(shm_path);
+		return 1;
+	}
+	unsigned char *shm = (unsigned char *) mmap(NULL, shm_size, PROT_READ | PROT_WRITE, MAP_SHARED, shm_fd, 0);
+	close(shm_fd);
+	if (shm == MAP_FAILED) {
+		perror(shm_path);
+		return 1;
+	}
+	memcpy(shm, &header, sizeof(header));
+	unsigned char *rand = shm + header.rand_offset;
+	unsigned char *file = shm + header.file_offset;
+	ff_use_buffers(file, file_limit, rand, rand_limit);
+
+	// Keep stray output of the templates off the reply channel
+	int reply_fd = dup(STDOUT_FILENO);
+	dup2(STDERR_FILENO, STDOUT_FILENO);
+
+	ff_reply reply = { 1, (uint32_t) shm_size };
+	if (write(reply_fd, &reply, sizeof(reply)) != sizeof(reply))
+		return 1;
+
+	ff_request request;
+	while (read(STDIN_FILENO, &request, sizeof(request)) == sizeof(request)) {
+		reply.status = -1;
+		reply.size = 0;
+		if (request.command == FF_SERVE_GENERATE && request.size <= rand_limit) {
+			unsigned char *new_data = NULL;
+			reply.size = ff_generate(rand, request.size, &new_data);
+			reply.status = new_data != NULL;
+		} else if (request.command == FF_SERVE_PARSE && request.size <= file_limit) {
+			unsigned char *new_data = NULL;
+			size_t new_size = 0;
+			reply.status = ff_parse(file, request.size, &new_data, &new_size);
+			reply.size = new_size;
+		}
+		if (write(reply_fd, &reply, sizeof(reply)) != sizeof(reply))
+			return 1;
+	}
+
+	munmap(shm, shm_size);
 	return 0;
 }
 
@@ -1761,8 +2806,8 @@ int version(int argc, char *argv[])
 }
 
 
-extern std::vector<std::vector<int>> found_paths;
-unsigned currentPos = 0;
+extern thread_local std::vector<std::vector<int>> found_paths;
+thread_local unsigned currentPos = 0;
 
 extern std::map<int, std::vector<int>> get_reachabilities();
 extern std::map<int, std::vector<std::pair<int, int>>> get_paths();
@@ -1843,23 +2888,23 @@ std::vector<int> get_Path(std::map<int, std::vector<std::pair<int,int>>> paths,
 	return path;
 }
 
-unsigned int position;
-int path_pos;
-bool found_path;
-std::vector<int> to_cover;
-std::vector<int> chosen;
-extern bool is_k_paths;
-std::vector<int> k_path_stack;
-unsigned int previous_gen_pos;
-int tries = 0;
-std::vector<std::pair<std::vector<int>, bool>> k_paths = {};
+thread_local unsigned int position;
+thread_local int path_pos;
+thread_local bool found_path;
+thread_local std::vector<int> to_cover;
+thread_local std::vector<int> chosen;
+extern thread_local bool is_k_paths;
+thread_local std::vector<int> k_path_stack;
+thread_local unsigned int previous_gen_pos;
+thread_local int tries = 0;
+thread_local std::vector<std::pair<std::vector<int>, bool>> k_paths = {};
 // variables for testing
 bool k_path_test = false;
-bool FF_test = false;
-std::set<std::vector<int>> cov_IDs;
+thread_local bool FF_test = false;
+thread_local std::set<std::vector<int>> cov_IDs;
 int k_paths_amount;
 int inputs;
-long unsigned int test_k = 0;
+thread_local long unsigned int test_k = 0;
 
 int k_path_gen(int argc, char **argv){
 	get_parse_tree = false;
@@ -1923,11 +2968,7 @@ int k_path_gen(int argc, char **argv){
 		while (tries_per_path < 5){
 			// initialize randomness source
 			buffer = new unsigned char [MAX_RAND_SIZE];
-			int rand_fd = open("/dev/urandom", O_RDONLY);
-			ssize_t r = read(rand_fd, buffer, MAX_RAND_SIZE);
-			if (r != MAX_RAND_SIZE)
-				printf("Read only %ld bytes from /dev/urandom\n", r);
-			close(rand_fd);
+			random_fill(buffer, MAX_RAND_SIZE);
 			generated_input = NULL;
 
 			// variables for iteration
@@ -2206,9 +3247,12 @@ COMMAND commands[] = {
 	{"insert", smart_insert, "Apply a smart insertion"},
 	{"abstract", smart_abstract, "Apply a smart abstraction"},
 	{"swap", smart_swap, "Apply a smart swap"},
+	{"import", import, "Parse a seed corpus into the chunk corpus"},
 	{"mutations", mutations, "Smart mutations"},
 	{"test", test, "Test if fuzzer is working properly (sanity checks)"},
 	{"benchmark", benchmark, "Benchmark fuzzing"},
+	{"checksums", checksum_benchmark, "Test and benchmark Checksum() implementations"},
+	{"serve", serve, "Serve generate/parse requests through shared memory"},
 	{"version", version, "Show version"},
 	{"test_k_paths_ids", test_k_paths_ids, "Test coverage of the k-path generation and compare against FormatFuzzer"},
 	{"test_k_paths_cov", test_k_paths_cov, "Generate k-path and regular format fuzzer inputs for code coverage testing"},
@@ -2226,6 +3270,9 @@ int help(int argc, char *argv[])
 	return 0;
 }
 
+// Define FF_NO_MAIN when linking into a program with its own main(),
+// such as a libFuzzer target
+#ifndef FF_NO_MAIN
 int main(int argc, char **argv)
 {
 	bin_name = get_bin_name(argv[0]);
@@ -2243,3 +3290,4 @@ int main(int argc, char **argv)
 	help(argc, argv);
 	return -1;
 }
+#endif
@@ -10,26 +10,29 @@
 class char_class {
 	int small;
 	std::vector<char> known_values;
+	known_index<char> known_lookup;
 	char value;
 public:
 	int64 _startof = 0;
 	std::size_t _sizeof = sizeof(char);
 	char operator () () { return value; }
-	char_class(int small, std::vector<char> known_values = {}) : small(small), known_values(known_values) {}
+	char_class(int small, std::vector<char> known_values = {}) : small(small), known_values(known_values), known_lookup(known_values) {}
 
+	template<bool Generate>
 	char generate() {
 		_startof = FTell();
 		if (known_values.empty()) {
-			value = file_acc.file_integer(sizeof(char), 0, small);
+			value = file_acc.file_integer<Generate>(sizeof(char), 0, small);
 		} else {
-			value = file_acc.file_integer(sizeof(char), 0, known_values);
+			value = file_acc.file_integer<Generate>(sizeof(char), 0, known_values, known_lookup);
 		}
 		return value;
 	}
 
-	char generate(std::vector<char> possible_values) {
+	template<bool Generate>
+	char generate(value_span<char> possible_values) {
 		_startof = FTell();
-		value = file_acc.file_integer(sizeof(char), 0, possible_values);
+		value = file_acc.file_integer<Generate>(sizeof(char), 0, possible_values);
 		return value;
 	}
 };
@@ -39,12 +42,13 @@ public:
 class char_array_class {
 	char_class& element;
 	std::vector<std::string> known_values;
+	known_index<std::string> known_lookup;
 	std::unordered_map<int, std::vector<char>> element_known_values;
 	std::string value;
 public:
 	int64 _startof = 0;
 	std::size_t _sizeof = 0;
-	std::string operator () () { return value; }
+	const std::string& operator () () { return value; }
 	char operator [] (int index) {
 		assert_cond((unsigned)index < value.size(), "array index out of bounds");
 		return value[index];
@@ -52,38 +56,39 @@ public:
 	char_array_class(char_class& element, std::unordered_map<int, std::vector<char>> element_known_values = {})
 		: element(element), element_known_values(element_known_values) {}
 	char_array_class(char_class& element, std::vector<std::string> known_values)
-		: element(element), known_values(known_values) {}
+		: element(element), known_values(known_values), known_lookup(known_values) {}
 
-	std::string generate(unsigned size, std::vector<std::string> possible_values = {}) {
-		check_array_length(size);
+	template<bool Generate>
+	const std::string& generate(unsigned size, value_span<std::string> possible_values = {}) {
+		check_array_length<Generate>(size);
 		_startof = FTell();
 		value = "";
 		if (possible_values.size()) {
-			value = file_acc.file_string(possible_values);
+			value = file_acc.file_string<Generate>(possible_values);
 			assert(value.length() == size);
 			_sizeof = size;
 			return value;
 		}
 		if (known_values.size()) {
-			value = file_acc.file_string(known_values);
+			value = file_acc.file_string<Generate>(known_values, known_lookup);
 			assert(value.length() == size);
 			_sizeof = size;
 			return value;
 		}
 		if (!element_known_values.size()) {
 			if (size == 0)
-				 return "";
-			value = file_acc.file_string(size);
+				return value;
+			value = file_acc.file_string<Generate>(size);
 			_sizeof = size;
 			return value;
 		}
 		for (unsigned i = 0; i < size; ++i) {
 			auto known = element_known_values.find(i);
 			if (known == element_known_values.end()) {
-				value.push_back(element.generate());
+				value.push_back(element.generate<Generate>());
 				_sizeof += element._sizeof;
 			} else {
-				value.push_back(file_acc.file_integer(sizeof(char), 0, known->second));
+				value.push_back(file_acc.file_integer<Generate>(sizeof(char), 0, known->second));
 				_sizeof += sizeof(char);
 			}
 		}
@@ -103,11 +108,11 @@ public:
 	bool Signature_exists = false;
 	bool Version_exists = false;
 
-	std::string Signature() {
+	const std::string& Signature() {
 		assert_cond(Signature_exists, "struct field Signature does not exist");
 		return Signature_var;
 	}
-	std::string Version() {
+	const std::string& Version() {
 		assert_cond(Version_exists, "struct field Version does not exist");
 		return Version_var;
 	}
@@ -131,9 +136,10 @@ public:
 			GIFHEADER* instance = instances.back();
 			instances.pop_back();
 			if (instance->generated == 2)
-				delete instance;
+				arena_delete(instance);
 		}
 	}
+	template<bool Generate>
 	GIFHEADER* generate();
 };
 
@@ -142,26 +148,29 @@ public:
 class ushort_class {
 	int small;
 	std::vector<ushort> known_values;
+	known_index<ushort> known_lookup;
 	ushort value;
 public:
 	int64 _startof = 0;
 	std::size_t _sizeof = sizeof(ushort);
 	ushort operator () () { return value; }
-	ushort_class(int small, std::vector<ushort> known_values = {}) : small(small), known_values(known_values) {}
+	ushort_class(int small, std::vector<ushort> known_values = {}) : small(small), known_values(known_values), known_lookup(known_values) {}
 
+	template<bool Generate>
 	ushort generate() {
 		_startof = FTell();
 		if (known_values.empty()) {
-			value = file_acc.file_integer(sizeof(ushort), 0, small);
+			value = file_acc.file_integer<Generate>(sizeof(ushort), 0, small);
 		} else {
-			value = file_acc.file_integer(sizeof(ushort), 0, known_values);
+			value = file_acc.file_integer<Generate>(sizeof(ushort), 0, known_values, known_lookup);
 		}
 		return value;
 	}
 
-	ushort generate(std::vector<ushort> possible_values) {
+	template<bool Generate>
+	ushort generate(value_span<ushort> possible_values) {
 		_startof = FTell();
-		value = file_acc.file_integer(sizeof(ushort), 0, possible_values);
+		value = file_acc.file_integer<Generate>(sizeof(ushort), 0, possible_values);
 		return value;
 	}
 };
@@ -171,26 +180,29 @@ public:
 class UBYTE_bitfield {
 	int small;
 	std::vector<UBYTE> known_values;
+	known_index<UBYTE> known_lookup;
 	UBYTE value;
 public:
 	UBYTE operator () () { return value; }
-	UBYTE_bitfield(int small, std::vector<UBYTE> known_values = {}) : small(small), known_values(known_values) {}
+	UBYTE_bitfield(int small, std::vector<UBYTE> known_values = {}) : small(small), known_values(known_values), known_lookup(known_values) {}
 
+	template<bool Generate>
 	UBYTE generate(unsigned bits) {
 		if (!bits)
 			return 0;
 		if (known_values.empty()) {
-			value = file_acc.file_integer(sizeof(UBYTE), bits, small);
+			value = file_acc.file_integer<Generate>(sizeof(UBYTE), bits, small);
 		} else {
-			value = file_acc.file_integer(sizeof(UBYTE), bits, known_values);
+			value = file_acc.file_integer<Generate>(sizeof(UBYTE), bits, known_values, known_lookup);
 		}
 		return value;
 	}
 
-	UBYTE generate(unsigned bits, std::vector<UBYTE> possible_values) {
+	template<bool Generate>
+	UBYTE generate(unsigned bits, value_span<UBYTE> possible_values) {
 		if (!bits)
 			return 0;
-		value = file_acc.file_integer(sizeof(UBYTE), bits, possible_values);
+		value = file_acc.file_integer<Generate>(sizeof(UBYTE), bits, possible_values);
 		return value;
 	}
 };
@@ -244,9 +256,10 @@ public:
 			LOGICALSCREENDESCRIPTOR_PACKEDFIELDS* instance = instances.back();
 			instances.pop_back();
 			if (instance->generated == 2)
-				delete instance;
+				arena_delete(instance);
 		}
 	}
+	template<bool Generate>
 	LOGICALSCREENDESCRIPTOR_PACKEDFIELDS* generate();
 };
 
@@ -255,26 +268,29 @@ public:
 class UBYTE_class {
 	int small;
 	std::vector<UBYTE> known_values;
+	known_index<UBYTE> known_lookup;
 	UBYTE value;
 public:
 	int64 _startof = 0;
 	std::size_t _sizeof = sizeof(UBYTE);
 	UBYTE operator () () { return value; }
-	UBYTE_class(int small, std::vector<UBYTE> known_values = {}) : small(small), known_values(known_values) {}
+	UBYTE_class(int small, std::vector<UBYTE> known_values = {}) : small(small), known_values(known_values), known_lookup(known_values) {}
 
+	template<bool Generate>
 	UBYTE generate() {
 		_startof = FTell();
 		if (known_values.empty()) {
-			value = file_acc.file_integer(sizeof(UBYTE), 0, small);
+			value = file_acc.file_integer<Generate>(sizeof(UBYTE), 0, small);
 		} else {
-			value = file_acc.file_integer(sizeof(UBYTE), 0, known_values);
+			value = file_acc.file_integer<Generate>(sizeof(UBYTE), 0, known_values, known_lookup);
 		}
 		return value;
 	}
 
-	UBYTE generate(std::vector<UBYTE> possible_values) {
+	template<bool Generate>
+	UBYTE generate(value_span<UBYTE> possible_values) {
 		_startof = FTell();
-		value = file_acc.file_integer(sizeof(UBYTE), 0, possible_values);
+		value = file_acc.file_integer<Generate>(sizeof(UBYTE), 0, possible_values);
 		return value;
 	}
 };
@@ -334,9 +350,10 @@ public:
 			LOGICALSCREENDESCRIPTOR* instance = instances.back();
 			instances.pop_back();
 			if (instance->generated == 2)
-				delete instance;
+				arena_delete(instance);
 		}
 	}
+	template<bool Generate>
 	LOGICALSCREENDESCRIPTOR* generate();
 };
 
@@ -383,9 +400,10 @@ public:
 			RGB* instance = instances.back();
 			instances.pop_back();
 			if (instance->generated == 2)
-				delete instance;
+				arena_delete(instance);
 		}
 	}
+	template<bool Generate>
 	RGB* generate();
 };
 
@@ -397,19 +415,20 @@ class RGB_array_class {
 public:
 	int64 _startof = 0;
 	std::size_t _sizeof = 0;
-	std::vector<RGB*> operator () () { return value; }
-	RGB operator [] (int index) {
+	const std::vector<RGB*>& operator () () { return value; }
+	RGB& operator [] (int index) {
 		assert_cond((unsigned)index < value.size(), "array index out of bounds");
 		return *value[index];
 	}
 	RGB_array_class(RGB& element) : element(element) {}
 
-	std::vector<RGB*> generate(unsigned size) {
-		check_array_length(size);
+	template<bool Generate>
+	const std::vector<RGB*>& generate(unsigned size) {
+		check_array_length<Generate>(size);
 		_startof = FTell();
 		value = {};
 		for (unsigned i = 0; i < size; ++i) {
-			value.push_back(element.generate());
+			value.push_back(element.generate<Generate>());
 			_sizeof += element._sizeof;
 		}
 		return value;
@@ -426,7 +445,7 @@ class GLOBALCOLORTABLE {
 public:
 	bool rgb_exists = false;
 
-	std::vector<RGB*> rgb() {
+	const std::vector<RGB*>& rgb() {
 		assert_cond(rgb_exists, "struct field rgb does not exist");
 		return rgb_var;
 	}
@@ -451,9 +470,10 @@ public:
 			GLOBALCOLORTABLE* instance = instances.back();
 			instances.pop_back();
 			if (instance->generated == 2)
-				delete instance;
+				arena_delete(instance);
 		}
 	}
+	template<bool Generate>
 	GLOBALCOLORTABLE* generate();
 };
 
@@ -515,9 +535,10 @@ public:
 			IMAGEDESCRIPTOR_PACKEDFIELDS* instance = instances.back();
 			instances.pop_back();
 			if (instance->generated == 2)
-				delete instance;
+				arena_delete(instance);
 		}
 	}
+	template<bool Generate>
 	IMAGEDESCRIPTOR_PACKEDFIELDS* generate();
 };
 
@@ -582,9 +603,10 @@ public:
 			IMAGEDESCRIPTOR* instance = instances.back();
 			instances.pop_back();
 			if (instance->generated == 2)
-				delete instance;
+				arena_delete(instance);
 		}
 	}
+	template<bool Generate>
 	IMAGEDESCRIPTOR* generate();
 };
 
@@ -598,7 +620,7 @@ class LOCALCOLORTABLE {
 public:
 	bool rgb_exists = false;
 
-	std::vector<RGB*> rgb() {
+	const std::vector<RGB*>& rgb() {
 		assert_cond(rgb_exists, "struct field rgb does not exist");
 		return rgb_var;
 	}
@@ -623,9 +645,10 @@ public:
 			LOCALCOLORTABLE* instance = instances.back();
 			instances.pop_back();
 			if (instance->generated == 2)
-				delete instance;
+				arena_delete(instance);
 		}
 	}
+	template<bool Generate>
 	LOCALCOLORTABLE* generate();
 };
 
@@ -645,7 +668,7 @@ public:
 		assert_cond(Size_exists, "struct field Size does not exist");
 		return Size_var;
 	}
-	std::string Data() {
+	const std::string& Data() {
 		assert_cond(Data_exists, "struct field Data does not exist");
 		return Data_var;
 	}
@@ -666,9 +689,10 @@ public:
 			DATASUBBLOCK* instance = instances.back();
 			instances.pop_back();
 			if (instance->generated == 2)
-				delete instance;
+				arena_delete(instance);
 		}
 	}
+	template<bool Generate>
 	DATASUBBLOCK* generate(UBYTE& size);
 };
 
@@ -714,9 +738,10 @@ public:
 			DATASUBBLOCKS* instance = instances.back();
 			instances.pop_back();
 			if (instance->generated == 2)
-				delete instance;
+				arena_delete(instance);
 		}
 	}
+	template<bool Generate>
 	DATASUBBLOCKS* generate();
 };
 
@@ -757,9 +782,10 @@ public:
 			IMAGEDATA* instance = instances.back();
 			instances.pop_back();
 			if (instance->generated == 2)
-				delete instance;
+				arena_delete(instance);
 		}
 	}
+	template<bool Generate>
 	IMAGEDATA* generate();
 };
 
@@ -812,9 +838,10 @@ public:
 			GRAPHICCONTROLEXTENSION_DATASUBBLOCK_PACKEDFIELDS* instance = instances.back();
 			instances.pop_back();
 			if (instance->generated == 2)
-				delete instance;
+				arena_delete(instance);
 		}
 	}
+	template<bool Generate>
 	GRAPHICCONTROLEXTENSION_DATASUBBLOCK_PACKEDFIELDS* generate();
 };
 
@@ -867,9 +894,10 @@ public:
 			GRAPHICCONTROLSUBBLOCK* instance = instances.back();
 			instances.pop_back();
 			if (instance->generated == 2)
-				delete instance;
+				arena_delete(instance);
 		}
 	}
+	template<bool Generate>
 	GRAPHICCONTROLSUBBLOCK* generate();
 };
 
@@ -922,9 +950,10 @@ public:
 			GRAPHICCONTROLEXTENSION* instance = instances.back();
 			instances.pop_back();
 			if (instance->generated == 2)
-				delete instance;
+				arena_delete(instance);
 		}
 	}
+	template<bool Generate>
 	GRAPHICCONTROLEXTENSION* generate();
 };
 
@@ -971,9 +1000,10 @@ public:
 			COMMENTEXTENSION* instance = instances.back();
 			instances.pop_back();
 			if (instance->generated == 2)
-				delete instance;
+				arena_delete(instance);
 		}
 	}
+	template<bool Generate>
 	COMMENTEXTENSION* generate();
 };
 
@@ -1056,9 +1086,10 @@ public:
 			PLAINTEXTSUBBLOCK* instance = instances.back();
 			instances.pop_back();
 			if (instance->generated == 2)
-				delete instance;
+				arena_delete(instance);
 		}
 	}
+	template<bool Generate>
 	PLAINTEXTSUBBLOCK* generate();
 };
 
@@ -1111,9 +1142,10 @@ public:
 			PLAINTEXTEXTENTION* instance = instances.back();
 			instances.pop_back();
 			if (instance->generated == 2)
-				delete instance;
+				arena_delete(instance);
 		}
 	}
+	template<bool Generate>
 	PLAINTEXTEXTENTION* generate();
 };
 
@@ -1135,11 +1167,11 @@ public:
 		assert_cond(BlockSize_exists, "struct field BlockSize does not exist");
 		return BlockSize_var;
 	}
-	std::string ApplicationIdentifier() {
+	const std::string& ApplicationIdentifier() {
 		assert_cond(ApplicationIdentifier_exists, "struct field ApplicationIdentifier does not exist");
 		return ApplicationIdentifier_var;
 	}
-	std::string ApplicationAuthenticationCode() {
+	const std::string& ApplicationAuthenticationCode() {
 		assert_cond(ApplicationAuthenticationCode_exists, "struct field ApplicationAuthenticationCode does not exist");
 		return ApplicationAuthenticationCode_var;
 	}
@@ -1160,9 +1192,10 @@ public:
 			APPLICATIONSUBBLOCK* instance = instances.back();
 			instances.pop_back();
 			if (instance->generated == 2)
-				delete instance;
+				arena_delete(instance);
 		}
 	}
+	template<bool Generate>
 	APPLICATIONSUBBLOCK* generate();
 };
 
@@ -1215,9 +1248,10 @@ public:
 			APPLICATIONEXTENTION* instance = instances.back();
 			instances.pop_back();
 			if (instance->generated == 2)
-				delete instance;
+				arena_delete(instance);
 		}
 	}
+	template<bool Generate>
 	APPLICATIONEXTENTION* generate();
 };
 
@@ -1264,9 +1298,10 @@ public:
 			UNDEFINEDDATA* instance = instances.back();
 			instances.pop_back();
 			if (instance->generated == 2)
-				delete instance;
+				arena_delete(instance);
 		}
 	}
+	template<bool Generate>
 	UNDEFINEDDATA* generate();
 };
 
@@ -1347,9 +1382,10 @@ public:
 			DATA* instance = instances.back();
 			instances.pop_back();
 			if (instance->generated == 2)
-				delete instance;
+				arena_delete(instance);
 		}
 	}
+	template<bool Generate>
 	DATA* generate();
 };
 
@@ -1384,57 +1420,76 @@ public:
 			TRAILER* instance = instances.back();
 			instances.pop_back();
 			if (instance->generated == 2)
-				delete instance;
+				arena_delete(instance);
 		}
 	}
+	template<bool Generate>
 	TRAILER* generate();
 };
 
 std::vector<byte> ReadByteInitValues;
+known_index<byte> ReadByteInitIndex(ReadByteInitValues);
 std::vector<ubyte> ReadUByteInitValues = {  };
+known_index<ubyte> ReadUByteInitIndex(ReadUByteInitValues);
 std::vector<short> ReadShortInitValues;
+known_index<short> ReadShortInitIndex(ReadShortInitValues);
 std::vector<ushort> ReadUShortInitValues = { 0xF921, 0xFE21, 0x0121, 0xFF21 };
+known_index<ushort> ReadUShortInitIndex(ReadUShortInitValues);
 std::vector<int> ReadIntInitValues;
+known_index<int> ReadIntInitIndex(ReadIntInitValues);
 std::vector<uint> ReadUIntInitValues;
+known_index<uint> ReadUIntInitIndex(ReadUIntInitValues);
 std::vector<int64> ReadQuadInitValues;
+known_index<int64> ReadQuadInitIndex(ReadQuadInitValues);
 std::vector<uint64> ReadUQuadInitValues;
+known_index<uint64> ReadUQuadInitIndex(ReadUQuadInitValues);
 std::vector<int64> ReadInt64InitValues;
+known_index<int64> ReadInt64InitIndex(ReadInt64InitValues);
 std::vector<uint64> ReadUInt64InitValues;
+known_index<uint64> ReadUInt64InitIndex(ReadUInt64InitValues);
 std::vector<hfloat> ReadHFloatInitValues;
+known_index<hfloat> ReadHFloatInitIndex(ReadHFloatInitValues);
 std::vector<float> ReadFloatInitValues;
+known_index<float> ReadFloatInitIndex(ReadFloatInitValues);
 std::vector<double> ReadDoubleInitValues;
+known_index<double> ReadDoubleInitIndex(ReadDoubleInitValues);
 std::vector<std::string> ReadBytesInitValues;
-
-
-std::vector<GIFHEADER*> GIFHEADER_GifHeader_instances;
-std::vector<LOGICALSCREENDESCRIPTOR_PACKEDFIELDS*> LOGICALSCREENDESCRIPTOR_PACKEDFIELDS_PackedFields_instances;
-std::vector<LOGICALSCREENDESCRIPTOR*> LOGICALSCREENDESCRIPTOR_LogicalScreenDescriptor_instances;
-std::vector<RGB*> RGB_rgb_element_instances;
-std::vector<GLOBALCOLORTABLE*> GLOBALCOLORTABLE_GlobalColorTable_instances;
-std::vector<IMAGEDESCRIPTOR_PACKEDFIELDS*> IMAGEDESCRIPTOR_PACKEDFIELDS_PackedFields__instances;
-std::vector<IMAGEDESCRIPTOR*> IMAGEDESCRIPTOR_ImageDescriptor_instances;
-std::vector<LOCALCOLORTABLE*> LOCALCOLORTABLE_LocalColorTable_instances;
-std::vector<DATASUBBLOCK*> DATASUBBLOCK_DataSubBlock_instances;
-std::vector<DATASUBBLOCKS*> DATASUBBLOCKS_DataSubBlocks_instances;
-std::vector<IMAGEDATA*> IMAGEDATA_ImageData_instances;
-std::vector<GRAPHICCONTROLEXTENSION_DATASUBBLOCK_PACKEDFIELDS*> GRAPHICCONTROLEXTENSION_DATASUBBLOCK_PACKEDFIELDS_PackedFields___instances;
-std::vector<GRAPHICCONTROLSUBBLOCK*> GRAPHICCONTROLSUBBLOCK_GraphicControlSubBlock_instances;
-std::vector<GRAPHICCONTROLEXTENSION*> GRAPHICCONTROLEXTENSION_GraphicControlExtension_instances;
-std::vector<DATASUBBLOCKS*> DATASUBBLOCKS_CommentData_instances;
-std::vector<COMMENTEXTENSION*> COMMENTEXTENSION_CommentExtension_instances;
-std::vector<PLAINTEXTSUBBLOCK*> PLAINTEXTSUBBLOCK_PlainTextSubBlock_instances;
-std::vector<DATASUBBLOCKS*> DATASUBBLOCKS_PlainTextData_instances;
-std::vector<PLAINTEXTEXTENTION*> PLAINTEXTEXTENTION_PlainTextExtension_instances;
-std::vector<APPLICATIONSUBBLOCK*> APPLICATIONSUBBLOCK_ApplicationSubBlock_instances;
-std::vector<DATASUBBLOCKS*> DATASUBBLOCKS_ApplicationData_instances;
-std::vector<APPLICATIONEXTENTION*> APPLICATIONEXTENTION_ApplicationExtension_instances;
-std::vector<UNDEFINEDDATA*> UNDEFINEDDATA_UndefinedData_instances;
-std::vector<DATA*> DATA_Data__instances;
-std::vector<TRAILER*> TRAILER_Trailer_instances;
+known_index<std::string> ReadBytesInitIndex(ReadBytesInitValues);
+
+
+thread_local std::vector<GIFHEADER*> GIFHEADER_GifHeader_instances;
+thread_local std::vector<LOGICALSCREENDESCRIPTOR_PACKEDFIELDS*> LOGICALSCREENDESCRIPTOR_PACKEDFIELDS_PackedFields_instances;
+thread_local std::vector<LOGICALSCREENDESCRIPTOR*> LOGICALSCREENDESCRIPTOR_LogicalScreenDescriptor_instances;
+thread_local std::vector<RGB*> RGB_rgb_element_instances;
+thread_local std::vector<GLOBALCOLORTABLE*> GLOBALCOLORTABLE_GlobalColorTable_instances;
+thread_local std::vector<IMAGEDESCRIPTOR_PACKEDFIELDS*> IMAGEDESCRIPTOR_PACKEDFIELDS_PackedFields__instances;
+thread_local std::vector<IMAGEDESCRIPTOR*> IMAGEDESCRIPTOR_ImageDescriptor_instances;
+thread_local std::vector<LOCALCOLORTABLE*> LOCALCOLORTABLE_LocalColorTable_instances;
+thread_local std::vector<DATASUBBLOCK*> DATASUBBLOCK_DataSubBlock_instances;
+thread_local std::vector<DATASUBBLOCKS*> DATASUBBLOCKS_DataSubBlocks_instances;
+thread_local std::vector<IMAGEDATA*> IMAGEDATA_ImageData_instances;
+thread_local std::vector<GRAPHICCONTROLEXTENSION_DATASUBBLOCK_PACKEDFIELDS*> GRAPHICCONTROLEXTENSION_DATASUBBLOCK_PACKEDFIELDS_PackedFields___instances;
+thread_local std::vector<GRAPHICCONTROLSUBBLOCK*> GRAPHICCONTROLSUBBLOCK_GraphicControlSubBlock_instances;
+thread_local std::vector<GRAPHICCONTROLEXTENSION*> GRAPHICCONTROLEXTENSION_GraphicControlExtension_instances;
+thread_local std::vector<DATASUBBLOCKS*> DATASUBBLOCKS_CommentData_instances;
+thread_local std::vector<COMMENTEXTENSION*> COMMENTEXTENSION_CommentExtension_instances;
+thread_local std::vector<PLAINTEXTSUBBLOCK*> PLAINTEXTSUBBLOCK_PlainTextSubBlock_instances;
+thread_local std::vector<DATASUBBLOCKS*> DATASUBBLOCKS_PlainTextData_instances;
+thread_local std::vector<PLAINTEXTEXTENTION*> PLAINTEXTEXTENTION_PlainTextExtension_instances;
+thread_local std::vector<APPLICATIONSUBBLOCK*> APPLICATIONSUBBLOCK_ApplicationSubBlock_instances;
+thread_local std::vector<DATASUBBLOCKS*> DATASUBBLOCKS_ApplicationData_instances;
+thread_local std::vector<APPLICATIONEXTENTION*> APPLICATIONEXTENTION_ApplicationExtension_instances;
+thread_local std::vector<UNDEFINEDDATA*> UNDEFINEDDATA_UndefinedData_instances;
+thread_local std::vector<DATA*> DATA_Data__instances;
+thread_local std::vector<TRAILER*> TRAILER_Trailer_instances;
 
 
 std::unordered_map<std::string, std::string> variable_types = { { "Signature", "char_array_class" }, { "Version", "char_array_class" }, { "GifHeader", "GIFHEADER" }, { "Width", "ushort_class" }, { "Height", "ushort_class" }, { "GlobalColorTableFlag", "UBYTE_bitfield1" }, { "ColorResolution", "UBYTE_bitfield3" }, { "SortFlag", "UBYTE_bitfield1" }, { "SizeOfGlobalColorTable", "UBYTE_bitfield3" }, { "PackedFields", "LOGICALSCREENDESCRIPTOR_PACKEDFIELDS" }, { "BackgroundColorIndex", "UBYTE_class" }, { "PixelAspectRatio", "UBYTE_class" }, { "LogicalScreenDescriptor", "LOGICALSCREENDESCRIPTOR" }, { "R", "UBYTE_class" }, { "G", "UBYTE_class" }, { "B", "UBYTE_class" }, { "rgb", "RGB_array_class" }, { "GlobalColorTable", "GLOBALCOLORTABLE" }, { "ImageSeperator", "UBYTE_class" }, { "ImageLeftPosition", "ushort_class" }, { "ImageTopPosition", "ushort_class" }, { "ImageWidth", "ushort_class" }, { "ImageHeight", "ushort_class" }, { "LocalColorTableFlag", "UBYTE_bitfield1" }, { "InterlaceFlag", "UBYTE_bitfield1" }, { "Reserved", "UBYTE_bitfield2" }, { "SizeOfLocalColorTable", "UBYTE_bitfield3" }, { "PackedFields_", "IMAGEDESCRIPTOR_PACKEDFIELDS" }, { "ImageDescriptor", "IMAGEDESCRIPTOR" }, { "LocalColorTable", "LOCALCOLORTABLE" }, { "LZWMinimumCodeSize", "UBYTE_class" }, { "Size", "UBYTE_class" }, { "Data", "char_array_class" }, { "DataSubBlock", "DATASUBBLOCK" }, { "BlockTerminator", "UBYTE_class" }, { "DataSubBlocks", "DATASUBBLOCKS" }, { "ImageData", "IMAGEDATA" }, { "ExtensionIntroducer", "UBYTE_class" }, { "GraphicControlLabel", "UBYTE_class" }, { "BlockSize", "UBYTE_class" }, { "Reserved_", "UBYTE_bitfield3" }, { "DisposalMethod", "UBYTE_bitfield3" }, { "UserInputFlag", "UBYTE_bitfield1" }, { "TransparentColorFlag", "UBYTE_bitfield1" }, { "PackedFields__", "GRAPHICCONTROLEXTENSION_DATASUBBLOCK_PACKEDFIELDS" }, { "DelayTime", "ushort_class" }, { "TransparentColorIndex", "UBYTE_class" }, { "GraphicControlSubBlock", "GRAPHICCONTROLSUBBLOCK" }, { "GraphicControlExtension", "GRAPHICCONTROLEXTENSION" }, { "CommentLabel", "UBYTE_class" }, { "CommentData", "DATASUBBLOCKS" }, { "CommentExtension", "COMMENTEXTENSION" }, { "PlainTextLabel", "UBYTE_class" }, { "TextGridLeftPosition", "ushort_class" }, { "TextGridTopPosition", "ushort_class" }, { "TextGridWidth", "ushort_class" }, { "TextGridHeight", "ushort_class" }, { "CharacterCellWidth", "UBYTE_class" }, { "CharacterCellHeight", "UBYTE_class" }, { "TextForegroundColorIndex", "UBYTE_class" }, { "TextBackgroundColorIndex", "UBYTE_class" }, { "PlainTextSubBlock", "PLAINTEXTSUBBLOCK" }, { "PlainTextData", "DATASUBBLOCKS" }, { "PlainTextExtension", "PLAINTEXTEXTENTION" }, { "ApplicationLabel", "UBYTE_class" }, { "ApplicationIdentifier", "char_array_class" }, { "ApplicationAuthenticationCode", "char_array_class" }, { "ApplicationSubBlock", "APPLICATIONSUBBLOCK" }, { "ApplicationData", "DATASUBBLOCKS" }, { "ApplicationExtension", "APPLICATIONEXTENTION" }, { "Label", "UBYTE_class" }, { "UndefinedData", "UNDEFINEDDATA" }, { "Data_", "DATA" }, { "GIFTrailer", "UBYTE_class" }, { "Trailer", "TRAILER" } };
 
+enum field_id : unsigned { field_id_GIFHEADER_Signature, field_id_GIFHEADER_Version, field_id_LOGICALSCREENDESCRIPTOR_PACKEDFIELDS_GlobalColorTableFlag, field_id_LOGICALSCREENDESCRIPTOR_PACKEDFIELDS_ColorResolution, field_id_LOGICALSCREENDESCRIPTOR_PACKEDFIELDS_SortFlag, field_id_LOGICALSCREENDESCRIPTOR_PACKEDFIELDS_SizeOfGlobalColorTable, field_id_LOGICALSCREENDESCRIPTOR_Width, field_id_LOGICALSCREENDESCRIPTOR_Height, field_id_LOGICALSCREENDESCRIPTOR_PackedFields, field_id_LOGICALSCREENDESCRIPTOR_BackgroundColorIndex, field_id_LOGICALSCREENDESCRIPTOR_PixelAspectRatio, field_id_RGB_R, field_id_RGB_G, field_id_RGB_B, field_id_GLOBALCOLORTABLE_rgb, field_id_IMAGEDESCRIPTOR_PACKEDFIELDS_LocalColorTableFlag, field_id_IMAGEDESCRIPTOR_PACKEDFIELDS_InterlaceFlag, field_id_IMAGEDESCRIPTOR_PACKEDFIELDS_SortFlag, field_id_IMAGEDESCRIPTOR_PACKEDFIELDS_Reserved, field_id_IMAGEDESCRIPTOR_PACKEDFIELDS_SizeOfLocalColorTable, field_id_IMAGEDESCRIPTOR_ImageSeperator, field_id_IMAGEDESCRIPTOR_ImageLeftPosition, field_id_IMAGEDESCRIPTOR_ImageTopPosition, field_id_IMAGEDESCRIPTOR_ImageWidth, field_id_IMAGEDESCRIPTOR_ImageHeight, field_id_IMAGEDESCRIPTOR_PackedFields, field_id_LOCALCOLORTABLE_rgb, field_id_DATASUBBLOCK_Size, field_id_DATASUBBLOCK_Data, field_id_DATASUBBLOCKS_DataSubBlock, field_id_DATASUBBLOCKS_BlockTerminator, field_id_IMAGEDATA_LZWMinimumCodeSize, field_id_IMAGEDATA_DataSubBlocks, field_id_GRAPHICCONTROLEXTENSION_DATASUBBLOCK_PACKEDFIELDS_Reserved, field_id_GRAPHICCONTROLEXTENSION_DATASUBBLOCK_PACKEDFIELDS_DisposalMethod, field_id_GRAPHICCONTROLEXTENSION_DATASUBBLOCK_PACKEDFIELDS_UserInputFlag, field_id_GRAPHICCONTROLEXTENSION_DATASUBBLOCK_PACKEDFIELDS_TransparentColorFlag, field_id_GRAPHICCONTROLSUBBLOCK_BlockSize, field_id_GRAPHICCONTROLSUBBLOCK_PackedFields, field_id_GRAPHICCONTROLSUBBLOCK_DelayTime, field_id_GRAPHICCONTROLSUBBLOCK_TransparentColorIndex, field_id_GRAPHICCONTROLEXTENSION_ExtensionIntroducer, field_id_GRAPHICCONTROLEXTENSION_GraphicControlLabel, field_id_GRAPHICCONTROLEXTENSION_GraphicControlSubBlock, field_id_GRAPHICCONTROLEXTENSION_BlockTerminator, field_id_COMMENTEXTENSION_ExtensionIntroducer, field_id_COMMENTEXTENSION_CommentLabel, field_id_COMMENTEXTENSION_CommentData, field_id_PLAINTEXTSUBBLOCK_BlockSize, field_id_PLAINTEXTSUBBLOCK_TextGridLeftPosition, field_id_PLAINTEXTSUBBLOCK_TextGridTopPosition, field_id_PLAINTEXTSUBBLOCK_TextGridWidth, field_id_PLAINTEXTSUBBLOCK_TextGridHeight, field_id_PLAINTEXTSUBBLOCK_CharacterCellWidth, field_id_PLAINTEXTSUBBLOCK_CharacterCellHeight, field_id_PLAINTEXTSUBBLOCK_TextForegroundColorIndex, field_id_PLAINTEXTSUBBLOCK_TextBackgroundColorIndex, field_id_PLAINTEXTEXTENTION_ExtensionIntroducer, field_id_PLAINTEXTEXTENTION_PlainTextLabel, field_id_PLAINTEXTEXTENTION_PlainTextSubBlock, field_id_PLAINTEXTEXTENTION_PlainTextData, field_id_APPLICATIONSUBBLOCK_BlockSize, field_id_APPLICATIONSUBBLOCK_ApplicationIdentifier, field_id_APPLICATIONSUBBLOCK_ApplicationAuthenticationCode, field_id_APPLICATIONEXTENTION_ExtensionIntroducer, field_id_APPLICATIONEXTENTION_ApplicationLabel, field_id_APPLICATIONEXTENTION_ApplicationSubBlock, field_id_APPLICATIONEXTENTION_ApplicationData, field_id_UNDEFINEDDATA_ExtensionIntroducer, field_id_UNDEFINEDDATA_Label, field_id_UNDEFINEDDATA_DataSubBlocks, field_id_DATA_ImageDescriptor, field_id_DATA_LocalColorTable, field_id_DATA_ImageData, field_id_DATA_GraphicControlExtension, field_id_DATA_CommentExtension, field_id_DATA_PlainTextExtension, field_id_DATA_ApplicationExtension, field_id_DATA_UndefinedData, field_id_TRAILER_GIFTrailer, field_id_GifHeader, field_id_LogicalScreenDescriptor, field_id_GlobalColorTable, field_id_Data, field_id_Trailer };
+const unsigned field_count = 85;
+const char* const field_types[] = { "char_array_class", "char_array_class", "UBYTE_bitfield1", "UBYTE_bitfield3", "UBYTE_bitfield1", "UBYTE_bitfield3", "ushort_class", "ushort_class", "LOGICALSCREENDESCRIPTOR_PACKEDFIELDS", "UBYTE_class", "UBYTE_class", "UBYTE_class", "UBYTE_class", "UBYTE_class", "RGB_array_class", "UBYTE_bitfield1", "UBYTE_bitfield1", "UBYTE_bitfield1", "UBYTE_bitfield2", "UBYTE_bitfield3", "UBYTE_class", "ushort_class", "ushort_class", "ushort_class", "ushort_class", "IMAGEDESCRIPTOR_PACKEDFIELDS", "RGB_array_class", "UBYTE_class", "char_array_class", "DATASUBBLOCK", "UBYTE_class", "UBYTE_class", "DATASUBBLOCKS", "UBYTE_bitfield3", "UBYTE_bitfield3", "UBYTE_bitfield1", "UBYTE_bitfield1", "UBYTE_class", "GRAPHICCONTROLEXTENSION_DATASUBBLOCK_PACKEDFIELDS", "ushort_class", "UBYTE_class", "UBYTE_class", "UBYTE_class", "GRAPHICCONTROLSUBBLOCK", "UBYTE_class", "UBYTE_class", "UBYTE_class", "DATASUBBLOCKS", "UBYTE_class", "ushort_class", "ushort_class", "ushort_class", "ushort_class", "UBYTE_class", "UBYTE_class", "UBYTE_class", "UBYTE_class", "UBYTE_class", "UBYTE_class", "PLAINTEXTSUBBLOCK", "DATASUBBLOCKS", "UBYTE_class", "char_array_class", "char_array_class", "UBYTE_class", "UBYTE_class", "APPLICATIONSUBBLOCK", "DATASUBBLOCKS", "UBYTE_class", "UBYTE_class", "DATASUBBLOCKS", "IMAGEDESCRIPTOR", "LOCALCOLORTABLE", "IMAGEDATA", "GRAPHICCONTROLEXTENSION", "COMMENTEXTENSION", "PLAINTEXTEXTENTION", "APPLICATIONEXTENTION", "UNDEFINEDDATA", "UBYTE_class", "GIFHEADER", "LOGICALSCREENDESCRIPTOR", "GLOBALCOLORTABLE", "DATA", "TRAILER" };
+
 std::vector<std::vector<int>> integer_ranges = { { 1, 16 } };
 
 class globals_class {
@@ -1607,68 +1662,71 @@ public:
 	{}
 };
 
-globals_class* g;
+thread_local globals_class* g;
 
 
+template<bool Generate>
 GIFHEADER* GIFHEADER::generate() {
 	if (generated == 1) {
-		GIFHEADER* new_instance = new GIFHEADER(instances);
+		GIFHEADER* new_instance = arena_new<GIFHEADER>(instances);
 		new_instance->generated = 2;
-		return new_instance->generate();
+		return new_instance->generate<Generate>();
 	}
 	if (!generated)
 		generated = 1;
 	_startof = FTell();
 
 	evil = SetEvilBit(false);
-	GENERATE_VAR(Signature, 0, ::g->Signature.generate(3));
+	GENERATE_VAR(Signature, 0, field_id_GIFHEADER_Signature, ::g->Signature.generate<Generate>(3));
 	SetEvilBit(evil);
-	GENERATE_VAR(Version, 1, ::g->Version.generate(3, { {"87a"}, {"89a"} }));
+	GENERATE_VAR(Version, 1, field_id_GIFHEADER_Version, ::g->Version.generate<Generate>(3, { {"87a"}, {"89a"} }));
 
 	_sizeof = FTell() - _startof;
 	return this;
 }
 
 
+template<bool Generate>
 LOGICALSCREENDESCRIPTOR_PACKEDFIELDS* LOGICALSCREENDESCRIPTOR_PACKEDFIELDS::generate() {
 	if (generated == 1) {
-		LOGICALSCREENDESCRIPTOR_PACKEDFIELDS* new_instance = new LOGICALSCREENDESCRIPTOR_PACKEDFIELDS(instances);
+		LOGICALSCREENDESCRIPTOR_PACKEDFIELDS* new_instance = arena_new<LOGICALSCREENDESCRIPTOR_PACKEDFIELDS>(instances);
 		new_instance->generated = 2;
-		return new_instance->generate();
+		return new_instance->generate<Generate>();
 	}
 	if (!generated)
 		generated = 1;
 	_startof = FTell();
 
-	GENERATE_VAR(GlobalColorTableFlag, 5, ::g->GlobalColorTableFlag.generate(1));
-	GENERATE_VAR(ColorResolution, 6, ::g->ColorResolution.generate(3));
-	GENERATE_VAR(SortFlag, 7, ::g->SortFlag.generate(1));
-	GENERATE_VAR(SizeOfGlobalColorTable, 8, ::g->SizeOfGlobalColorTable.generate(3));
+	GENERATE_VAR(GlobalColorTableFlag, 5, field_id_LOGICALSCREENDESCRIPTOR_PACKEDFIELDS_GlobalColorTableFlag, ::g->GlobalColorTableFlag.generate<Generate>(1));
+	GENERATE_VAR(ColorResolution, 6, field_id_LOGICALSCREENDESCRIPTOR_PACKEDFIELDS_ColorResolution, ::g->ColorResolution.generate<Generate>(3));
+	GENERATE_VAR(SortFlag, 7, field_id_LOGICALSCREENDESCRIPTOR_PACKEDFIELDS_SortFlag, ::g->SortFlag.generate<Generate>(1));
+	GENERATE_VAR(SizeOfGlobalColorTable, 8, field_id_LOGICALSCREENDESCRIPTOR_PACKEDFIELDS_SizeOfGlobalColorTable, ::g->SizeOfGlobalColorTable.generate<Generate>(3));
 
 	_sizeof = FTell() - _startof;
 	return this;
 }
 
 
+template<bool Generate>
 LOGICALSCREENDESCRIPTOR* LOGICALSCREENDESCRIPTOR::generate() {
 	if (generated == 1) {
-		LOGICALSCREENDESCRIPTOR* new_instance = new LOGICALSCREENDESCRIPTOR(instances);
+		LOGICALSCREENDESCRIPTOR* new_instance = arena_new<LOGICALSCREENDESCRIPTOR>(instances);
 		new_instance->generated = 2;
-		return new_instance->generate();
+		return new_instance->generate<Generate>();
 	}
 	if (!generated)
 		generated = 1;
 	_startof = FTell();
 
-	GENERATE_VAR(Width, 3, ::g->Width.generate());
-	GENERATE_VAR(Height, 4, ::g->Height.generate());
+	GENERATE_VAR(Width, 3, field_id_LOGICALSCREENDESCRIPTOR_Width, ::g->Width.generate<Generate>());
+	GENERATE_VAR(Height, 4, field_id_LOGICALSCREENDESCRIPTOR_Height, ::g->Height.generate<Generate>());
 	BitfieldLeftToRight();
-	GENERATE_VAR(PackedFields, 9, ::g->PackedFields.generate());
-	GENERATE_VAR(BackgroundColorIndex, 10, ::g->BackgroundColorIndex.generate());
+	GENERATE_VAR(PackedFields, 9, field_id_LOGICALSCREENDESCRIPTOR_PackedFields, ::g->PackedFields.generate<Generate>());
+	GENERATE_VAR(BackgroundColorIndex, 10, field_id_LOGICALSCREENDESCRIPTOR_BackgroundColorIndex, ::g->BackgroundColorIndex.generate<Generate>());
 	if ((::g->GifHeader().Version() == "89a")) {
-		GENERATE_VAR(PixelAspectRatio, 11, ::g->PixelAspectRatio.generate());
+		GENERATE_VAR(PixelAspectRatio, 11, field_id_LOGICALSCREENDESCRIPTOR_PixelAspectRatio, ::g->PixelAspectRatio.generate<Generate>());
 	} else {
-		GENERATE_VAR(PixelAspectRatio, 12, ::g->PixelAspectRatio.generate({ 0 }));
+		GENERATE_VAR(PixelAspectRatio, 12, field_id_LOGICALSCREENDESCRIPTOR_PixelAspectRatio, ::g->PixelAspectRatio.generate<Generate>({ 0 }));
 	};
 
 	_sizeof = FTell() - _startof;
@@ -1676,30 +1734,32 @@ LOGICALSCREENDESCRIPTOR* LOGICALSCREENDESCRIPTOR::generate() {
 }
 
 
+template<bool Generate>
 RGB* RGB::generate() {
 	if (generated == 1) {
-		RGB* new_instance = new RGB(instances);
+		RGB* new_instance = arena_new<RGB>(instances);
 		new_instance->generated = 2;
-		return new_instance->generate();
+		return new_instance->generate<Generate>();
 	}
 	if (!generated)
 		generated = 1;
 	_startof = FTell();
 
-	GENERATE_VAR(R, 14, ::g->R.generate());
-	GENERATE_VAR(G, 15, ::g->G.generate());
-	GENERATE_VAR(B, 16, ::g->B.generate());
+	GENERATE_VAR(R, 14, field_id_RGB_R, ::g->R.generate<Generate>());
+	GENERATE_VAR(G, 15, field_id_RGB_G, ::g->G.generate<Generate>());
+	GENERATE_VAR(B, 16, field_id_RGB_B, ::g->B.generate<Generate>());
 
 	_sizeof = FTell() - _startof;
 	return this;
 }
 
 
+template<bool Generate>
 GLOBALCOLORTABLE* GLOBALCOLORTABLE::generate() {
 	if (generated == 1) {
-		GLOBALCOLORTABLE* new_instance = new GLOBALCOLORTABLE(instances);
+		GLOBALCOLORTABLE* new_instance = arena_new<GLOBALCOLORTABLE>(instances);
 		new_instance->generated = 2;
-		return new_instance->generate();
+		return new_instance->generate<Generate>();
 	}
 	if (!generated)
 		generated = 1;
@@ -1710,18 +1770,19 @@ GLOBALCOLORTABLE* GLOBALCOLORTABLE::generate() {
 			size *= 2;
 	;
 	};
-	GENERATE_VAR(rgb, 17, ::g->rgb.generate(size));
+	GENERATE_VAR(rgb, 17, field_id_GLOBALCOLORTABLE_rgb, ::g->rgb.generate<Generate>(size));
 
 	_sizeof = FTell() - _startof;
 	return this;
 }
 
 
+template<bool Generate>
 IMAGEDESCRIPTOR_PACKEDFIELDS* IMAGEDESCRIPTOR_PACKEDFIELDS::generate() {
 	if (generated == 1) {
-		IMAGEDESCRIPTOR_PACKEDFIELDS* new_instance = new IMAGEDESCRIPTOR_PACKEDFIELDS(instances);
+		IMAGEDESCRIPTOR_PACKEDFIELDS* new_instance = arena_new<IMAGEDESCRIPTOR_PACKEDFIELDS>(instances);
 		new_instance->generated = 2;
-		return new_instance->generate();
+		return new_instance->generate<Generate>();
 	}
 	if (!generated)
 		generated = 1;
@@ -1732,44 +1793,46 @@ IMAGEDESCRIPTOR_PACKEDFIELDS* IMAGEDESCRIPTOR_PACKEDFIELDS::generate() {
 	} else {
 		possible_values = { 1 };
 	};
-	GENERATE_VAR(LocalColorTableFlag, 24, ::g->LocalColorTableFlag.generate(1, possible_values));
-	GENERATE_VAR(InterlaceFlag, 25, ::g->InterlaceFlag.generate(1));
-	GENERATE_VAR(SortFlag, 26, ::g->SortFlag.generate(1));
-	GENERATE_VAR(Reserved, 27, ::g->Reserved.generate(2));
-	GENERATE_VAR(SizeOfLocalColorTable, 28, ::g->SizeOfLocalColorTable.generate(3));
+	GENERATE_VAR(LocalColorTableFlag, 24, field_id_IMAGEDESCRIPTOR_PACKEDFIELDS_LocalColorTableFlag, ::g->LocalColorTableFlag.generate<Generate>(1, possible_values));
+	GENERATE_VAR(InterlaceFlag, 25, field_id_IMAGEDESCRIPTOR_PACKEDFIELDS_InterlaceFlag, ::g->InterlaceFlag.generate<Generate>(1));
+	GENERATE_VAR(SortFlag, 26, field_id_IMAGEDESCRIPTOR_PACKEDFIELDS_SortFlag, ::g->SortFlag.generate<Generate>(1));
+	GENERATE_VAR(Reserved, 27, field_id_IMAGEDESCRIPTOR_PACKEDFIELDS_Reserved, ::g->Reserved.generate<Generate>(2));
+	GENERATE_VAR(SizeOfLocalColorTable, 28, field_id_IMAGEDESCRIPTOR_PACKEDFIELDS_SizeOfLocalColorTable, ::g->SizeOfLocalColorTable.generate<Generate>(3));
 
 	_sizeof = FTell() - _startof;
 	return this;
 }
 
 
+template<bool Generate>
 IMAGEDESCRIPTOR* IMAGEDESCRIPTOR::generate() {
 	if (generated == 1) {
-		IMAGEDESCRIPTOR* new_instance = new IMAGEDESCRIPTOR(instances);
+		IMAGEDESCRIPTOR* new_instance = arena_new<IMAGEDESCRIPTOR>(instances);
 		new_instance->generated = 2;
-		return new_instance->generate();
+		return new_instance->generate<Generate>();
 	}
 	if (!generated)
 		generated = 1;
 	_startof = FTell();
 
-	GENERATE_VAR(ImageSeperator, 19, ::g->ImageSeperator.generate());
-	GENERATE_VAR(ImageLeftPosition, 20, ::g->ImageLeftPosition.generate());
-	GENERATE_VAR(ImageTopPosition, 21, ::g->ImageTopPosition.generate());
-	GENERATE_VAR(ImageWidth, 22, ::g->ImageWidth.generate());
-	GENERATE_VAR(ImageHeight, 23, ::g->ImageHeight.generate());
-	GENERATE_VAR(PackedFields, 29, ::g->PackedFields_.generate());
+	GENERATE_VAR(ImageSeperator, 19, field_id_IMAGEDESCRIPTOR_ImageSeperator, ::g->ImageSeperator.generate<Generate>());
+	GENERATE_VAR(ImageLeftPosition, 20, field_id_IMAGEDESCRIPTOR_ImageLeftPosition, ::g->ImageLeftPosition.generate<Generate>());
+	GENERATE_VAR(ImageTopPosition, 21, field_id_IMAGEDESCRIPTOR_ImageTopPosition, ::g->ImageTopPosition.generate<Generate>());
+	GENERATE_VAR(ImageWidth, 22, field_id_IMAGEDESCRIPTOR_ImageWidth, ::g->ImageWidth.generate<Generate>());
+	GENERATE_VAR(ImageHeight, 23, field_id_IMAGEDESCRIPTOR_ImageHeight, ::g->ImageHeight.generate<Generate>());
+	GENERATE_VAR(PackedFields, 29, field_id_IMAGEDESCRIPTOR_PackedFields, ::g->PackedFields_.generate<Generate>());
 
 	_sizeof = FTell() - _startof;
 	return this;
 }
 
 
+template<bool Generate>
 LOCALCOLORTABLE* LOCALCOLORTABLE::generate() {
 	if (generated == 1) {
-		LOCALCOLORTABLE* new_instance = new LOCALCOLORTABLE(instances);
+		LOCALCOLORTABLE* new_instance = arena_new<LOCALCOLORTABLE>(instances);
 		new_instance->generated = 2;
-		return new_instance->generate();
+		return new_instance->generate<Generate>();
 	}
 	if (!generated)
 		generated = 1;
@@ -1780,36 +1843,38 @@ LOCALCOLORTABLE* LOCALCOLORTABLE::generate() {
 			size *= 2;
 	;
 	};
-	GENERATE_VAR(rgb, 31, ::g->rgb.generate(size));
+	GENERATE_VAR(rgb, 31, field_id_LOCALCOLORTABLE_rgb, ::g->rgb.generate<Generate>(size));
 
 	_sizeof = FTell() - _startof;
 	return this;
 }
 
 
+template<bool Generate>
 DATASUBBLOCK* DATASUBBLOCK::generate(UBYTE& size) {
 	if (generated == 1) {
-		DATASUBBLOCK* new_instance = new DATASUBBLOCK(instances);
+		DATASUBBLOCK* new_instance = arena_new<DATASUBBLOCK>(instances);
 		new_instance->generated = 2;
-		return new_instance->generate(size);
+		return new_instance->generate<Generate>(size);
 	}
 	if (!generated)
 		generated = 1;
 	_startof = FTell();
 
-	GENERATE_VAR(Size, 34, ::g->Size.generate());
-	GENERATE_VAR(Data, 35, ::g->Data.generate(size));
+	GENERATE_VAR(Size, 34, field_id_DATASUBBLOCK_Size, ::g->Size.generate<Generate>());
+	GENERATE_VAR(Data, 35, field_id_DATASUBBLOCK_Data, ::g->Data.generate<Generate>(size));
 
 	_sizeof = FTell() - _startof;
 	return this;
 }
 
 
+template<bool Generate>
 DATASUBBLOCKS* DATASUBBLOCKS::generate() {
 	if (generated == 1) {
-		DATASUBBLOCKS* new_instance = new DATASUBBLOCKS(instances);
+		DATASUBBLOCKS* new_instance = arena_new<DATASUBBLOCKS>(instances);
 		new_instance->generated = 2;
-		return new_instance->generate();
+		return new_instance->generate<Generate>();
 	}
 	if (!generated)
 		generated = 1;
@@ -1820,227 +1885,238 @@ DATASUBBLOCKS* DATASUBBLOCKS::generate() {
 		values.insert(values.end(), { (UBYTE)count });
 	};
 	count = 0;
-	size = ReadUByte(FTell(), values);
+	size = ReadUByte<Generate>(FTell(), values);
 	while ((size != 0)) {
-		GENERATE_VAR(DataSubBlock, 36, ::g->DataSubBlock.generate(size));
+		GENERATE_VAR(DataSubBlock, 36, field_id_DATASUBBLOCKS_DataSubBlock, ::g->DataSubBlock.generate<Generate>(size));
 		count += size;
-		size = ReadUByte(FTell(), values);
+		size = ReadUByte<Generate>(FTell(), values);
 		if ((count > 1500)) {
 			values = { 0, 255 };
 		};
 	};
-	GENERATE_VAR(BlockTerminator, 37, ::g->BlockTerminator.generate());
+	GENERATE_VAR(BlockTerminator, 37, field_id_DATASUBBLOCKS_BlockTerminator, ::g->BlockTerminator.generate<Generate>());
 
 	_sizeof = FTell() - _startof;
 	return this;
 }
 
 
+template<bool Generate>
 IMAGEDATA* IMAGEDATA::generate() {
 	if (generated == 1) {
-		IMAGEDATA* new_instance = new IMAGEDATA(instances);
+		IMAGEDATA* new_instance = arena_new<IMAGEDATA>(instances);
 		new_instance->generated = 2;
-		return new_instance->generate();
+		return new_instance->generate<Generate>();
 	}
 	if (!generated)
 		generated = 1;
 	_startof = FTell();
 
-	GENERATE_VAR(LZWMinimumCodeSize, 33, ::g->LZWMinimumCodeSize.generate({ 8 }));
-	GENERATE_VAR(DataSubBlocks, 38, ::g->DataSubBlocks.generate());
+	GENERATE_VAR(LZWMinimumCodeSize, 33, field_id_IMAGEDATA_LZWMinimumCodeSize, ::g->LZWMinimumCodeSize.generate<Generate>({ 8 }));
+	GENERATE_VAR(DataSubBlocks, 38, field_id_IMAGEDATA_DataSubBlocks, ::g->DataSubBlocks.generate<Generate>());
 
 	_sizeof = FTell() - _startof;
 	return this;
 }
 
 
+template<bool Generate>
 GRAPHICCONTROLEXTENSION_DATASUBBLOCK_PACKEDFIELDS* GRAPHICCONTROLEXTENSION_DATASUBBLOCK_PACKEDFIELDS::generate() {
 	if (generated == 1) {
-		GRAPHICCONTROLEXTENSION_DATASUBBLOCK_PACKEDFIELDS* new_instance = new GRAPHICCONTROLEXTENSION_DATASUBBLOCK_PACKEDFIELDS(instances);
+		GRAPHICCONTROLEXTENSION_DATASUBBLOCK_PACKEDFIELDS* new_instance = arena_new<GRAPHICCONTROLEXTENSION_DATASUBBLOCK_PACKEDFIELDS>(instances);
 		new_instance->generated = 2;
-		return new_instance->generate();
+		return new_instance->generate<Generate>();
 	}
 	if (!generated)
 		generated = 1;
 	_startof = FTell();
 
-	GENERATE_VAR(Reserved, 43, ::g->Reserved_.generate(3));
-	GENERATE_VAR(DisposalMethod, 44, ::g->DisposalMethod.generate(3));
-	GENERATE_VAR(UserInputFlag, 45, ::g->UserInputFlag.generate(1));
-	GENERATE_VAR(TransparentColorFlag, 46, ::g->TransparentColorFlag.generate(1));
+	GENERATE_VAR(Reserved, 43, field_id_GRAPHICCONTROLEXTENSION_DATASUBBLOCK_PACKEDFIELDS_Reserved, ::g->Reserved_.generate<Generate>(3));
+	GENERATE_VAR(DisposalMethod, 44, field_id_GRAPHICCONTROLEXTENSION_DATASUBBLOCK_PACKEDFIELDS_DisposalMethod, ::g->DisposalMethod.generate<Generate>(3));
+	GENERATE_VAR(UserInputFlag, 45, field_id_GRAPHICCONTROLEXTENSION_DATASUBBLOCK_PACKEDFIELDS_UserInputFlag, ::g->UserInputFlag.generate<Generate>(1));
+	GENERATE_VAR(TransparentColorFlag, 46, field_id_GRAPHICCONTROLEXTENSION_DATASUBBLOCK_PACKEDFIELDS_TransparentColorFlag, ::g->TransparentColorFlag.generate<Generate>(1));
 
 	_sizeof = FTell() - _startof;
 	return this;
 }
 
 
+template<bool Generate>
 GRAPHICCONTROLSUBBLOCK* GRAPHICCONTROLSUBBLOCK::generate() {
 	if (generated == 1) {
-		GRAPHICCONTROLSUBBLOCK* new_instance = new GRAPHICCONTROLSUBBLOCK(instances);
+		GRAPHICCONTROLSUBBLOCK* new_instance = arena_new<GRAPHICCONTROLSUBBLOCK>(instances);
 		new_instance->generated = 2;
-		return new_instance->generate();
+		return new_instance->generate<Generate>();
 	}
 	if (!generated)
 		generated = 1;
 	_startof = FTell();
 
-	GENERATE_VAR(BlockSize, 42, ::g->BlockSize.generate());
-	GENERATE_VAR(PackedFields, 47, ::g->PackedFields__.generate());
-	GENERATE_VAR(DelayTime, 48, ::g->DelayTime.generate());
-	GENERATE_VAR(TransparentColorIndex, 49, ::g->TransparentColorIndex.generate());
+	GENERATE_VAR(BlockSize, 42, field_id_GRAPHICCONTROLSUBBLOCK_BlockSize, ::g->BlockSize.generate<Generate>());
+	GENERATE_VAR(PackedFields, 47, field_id_GRAPHICCONTROLSUBBLOCK_PackedFields, ::g->PackedFields__.generate<Generate>());
+	GENERATE_VAR(DelayTime, 48, field_id_GRAPHICCONTROLSUBBLOCK_DelayTime, ::g->DelayTime.generate<Generate>());
+	GENERATE_VAR(TransparentColorIndex, 49, field_id_GRAPHICCONTROLSUBBLOCK_TransparentColorIndex, ::g->TransparentColorIndex.generate<Generate>());
 
 	_sizeof = FTell() - _startof;
 	return this;
 }
 
 
+template<bool Generate>
 GRAPHICCONTROLEXTENSION* GRAPHICCONTROLEXTENSION::generate() {
 	if (generated == 1) {
-		GRAPHICCONTROLEXTENSION* new_instance = new GRAPHICCONTROLEXTENSION(instances);
+		GRAPHICCONTROLEXTENSION* new_instance = arena_new<GRAPHICCONTROLEXTENSION>(instances);
 		new_instance->generated = 2;
-		return new_instance->generate();
+		return new_instance->generate<Generate>();
 	}
 	if (!generated)
 		generated = 1;
 	_startof = FTell();
 
-	GENERATE_VAR(ExtensionIntroducer, 40, ::g->ExtensionIntroducer.generate());
-	GENERATE_VAR(GraphicControlLabel, 41, ::g->GraphicControlLabel.generate());
-	GENERATE_VAR(GraphicControlSubBlock, 50, ::g->GraphicControlSubBlock.generate());
-	GENERATE_VAR(BlockTerminator, 51, ::g->BlockTerminator.generate());
+	GENERATE_VAR(ExtensionIntroducer, 40, field_id_GRAPHICCONTROLEXTENSION_ExtensionIntroducer, ::g->ExtensionIntroducer.generate<Generate>());
+	GENERATE_VAR(GraphicControlLabel, 41, field_id_GRAPHICCONTROLEXTENSION_GraphicControlLabel, ::g->GraphicControlLabel.generate<Generate>());
+	GENERATE_VAR(GraphicControlSubBlock, 50, field_id_GRAPHICCONTROLEXTENSION_GraphicControlSubBlock, ::g->GraphicControlSubBlock.generate<Generate>());
+	GENERATE_VAR(BlockTerminator, 51, field_id_GRAPHICCONTROLEXTENSION_BlockTerminator, ::g->BlockTerminator.generate<Generate>());
 
 	_sizeof = FTell() - _startof;
 	return this;
 }
 
 
+template<bool Generate>
 COMMENTEXTENSION* COMMENTEXTENSION::generate() {
 	if (generated == 1) {
-		COMMENTEXTENSION* new_instance = new COMMENTEXTENSION(instances);
+		COMMENTEXTENSION* new_instance = arena_new<COMMENTEXTENSION>(instances);
 		new_instance->generated = 2;
-		return new_instance->generate();
+		return new_instance->generate<Generate>();
 	}
 	if (!generated)
 		generated = 1;
 	_startof = FTell();
 
-	GENERATE_VAR(ExtensionIntroducer, 53, ::g->ExtensionIntroducer.generate());
-	GENERATE_VAR(CommentLabel, 54, ::g->CommentLabel.generate());
-	GENERATE_VAR(CommentData, 55, ::g->CommentData.generate());
+	GENERATE_VAR(ExtensionIntroducer, 53, field_id_COMMENTEXTENSION_ExtensionIntroducer, ::g->ExtensionIntroducer.generate<Generate>());
+	GENERATE_VAR(CommentLabel, 54, field_id_COMMENTEXTENSION_CommentLabel, ::g->CommentLabel.generate<Generate>());
+	GENERATE_VAR(CommentData, 55, field_id_COMMENTEXTENSION_CommentData, ::g->CommentData.generate<Generate>());
 
 	_sizeof = FTell() - _startof;
 	return this;
 }
 
 
+template<bool Generate>
 PLAINTEXTSUBBLOCK* PLAINTEXTSUBBLOCK::generate() {
 	if (generated == 1) {
-		PLAINTEXTSUBBLOCK* new_instance = new PLAINTEXTSUBBLOCK(instances);
+		PLAINTEXTSUBBLOCK* new_instance = arena_new<PLAINTEXTSUBBLOCK>(instances);
 		new_instance->generated = 2;
-		return new_instance->generate();
+		return new_instance->generate<Generate>();
 	}
 	if (!generated)
 		generated = 1;
 	_startof = FTell();
 
-	GENERATE_VAR(BlockSize, 59, ::g->BlockSize.generate());
-	GENERATE_VAR(TextGridLeftPosition, 60, ::g->TextGridLeftPosition.generate());
-	GENERATE_VAR(TextGridTopPosition, 61, ::g->TextGridTopPosition.generate());
-	GENERATE_VAR(TextGridWidth, 62, ::g->TextGridWidth.generate());
-	GENERATE_VAR(TextGridHeight, 63, ::g->TextGridHeight.generate());
-	GENERATE_VAR(CharacterCellWidth, 64, ::g->CharacterCellWidth.generate());
-	GENERATE_VAR(CharacterCellHeight, 65, ::g->CharacterCellHeight.generate());
-	GENERATE_VAR(TextForegroundColorIndex, 66, ::g->TextForegroundColorIndex.generate());
-	GENERATE_VAR(TextBackgroundColorIndex, 67, ::g->TextBackgroundColorIndex.generate());
+	GENERATE_VAR(BlockSize, 59, field_id_PLAINTEXTSUBBLOCK_BlockSize, ::g->BlockSize.generate<Generate>());
+	GENERATE_VAR(TextGridLeftPosition, 60, field_id_PLAINTEXTSUBBLOCK_TextGridLeftPosition, ::g->TextGridLeftPosition.generate<Generate>());
+	GENERATE_VAR(TextGridTopPosition, 61, field_id_PLAINTEXTSUBBLOCK_TextGridTopPosition, ::g->TextGridTopPosition.generate<Generate>());
+	GENERATE_VAR(TextGridWidth, 62, field_id_PLAINTEXTSUBBLOCK_TextGridWidth, ::g->TextGridWidth.generate<Generate>());
+	GENERATE_VAR(TextGridHeight, 63, field_id_PLAINTEXTSUBBLOCK_TextGridHeight, ::g->TextGridHeight.generate<Generate>());
+	GENERATE_VAR(CharacterCellWidth, 64, field_id_PLAINTEXTSUBBLOCK_CharacterCellWidth, ::g->CharacterCellWidth.generate<Generate>());
+	GENERATE_VAR(CharacterCellHeight, 65, field_id_PLAINTEXTSUBBLOCK_CharacterCellHeight, ::g->CharacterCellHeight.generate<Generate>());
+	GENERATE_VAR(TextForegroundColorIndex, 66, field_id_PLAINTEXTSUBBLOCK_TextForegroundColorIndex, ::g->TextForegroundColorIndex.generate<Generate>());
+	GENERATE_VAR(TextBackgroundColorIndex, 67, field_id_PLAINTEXTSUBBLOCK_TextBackgroundColorIndex, ::g->TextBackgroundColorIndex.generate<Generate>());
 
 	_sizeof = FTell() - _startof;
 	return this;
 }
 
 
+template<bool Generate>
 PLAINTEXTEXTENTION* PLAINTEXTEXTENTION::generate() {
 	if (generated == 1) {
-		PLAINTEXTEXTENTION* new_instance = new PLAINTEXTEXTENTION(instances);
+		PLAINTEXTEXTENTION* new_instance = arena_new<PLAINTEXTEXTENTION>(instances);
 		new_instance->generated = 2;
-		return new_instance->generate();
+		return new_instance->generate<Generate>();
 	}
 	if (!generated)
 		generated = 1;
 	_startof = FTell();
 
-	GENERATE_VAR(ExtensionIntroducer, 57, ::g->ExtensionIntroducer.generate());
-	GENERATE_VAR(PlainTextLabel, 58, ::g->PlainTextLabel.generate());
-	GENERATE_VAR(PlainTextSubBlock, 68, ::g->PlainTextSubBlock.generate());
-	GENERATE_VAR(PlainTextData, 69, ::g->PlainTextData.generate());
+	GENERATE_VAR(ExtensionIntroducer, 57, field_id_PLAINTEXTEXTENTION_ExtensionIntroducer, ::g->ExtensionIntroducer.generate<Generate>());
+	GENERATE_VAR(PlainTextLabel, 58, field_id_PLAINTEXTEXTENTION_PlainTextLabel, ::g->PlainTextLabel.generate<Generate>());
+	GENERATE_VAR(PlainTextSubBlock, 68, field_id_PLAINTEXTEXTENTION_PlainTextSubBlock, ::g->PlainTextSubBlock.generate<Generate>());
+	GENERATE_VAR(PlainTextData, 69, field_id_PLAINTEXTEXTENTION_PlainTextData, ::g->PlainTextData.generate<Generate>());
 
 	_sizeof = FTell() - _startof;
 	return this;
 }
 
 
+template<bool Generate>
 APPLICATIONSUBBLOCK* APPLICATIONSUBBLOCK::generate() {
 	if (generated == 1) {
-		APPLICATIONSUBBLOCK* new_instance = new APPLICATIONSUBBLOCK(instances);
+		APPLICATIONSUBBLOCK* new_instance = arena_new<APPLICATIONSUBBLOCK>(instances);
 		new_instance->generated = 2;
-		return new_instance->generate();
+		return new_instance->generate<Generate>();
 	}
 	if (!generated)
 		generated = 1;
 	_startof = FTell();
 
-	GENERATE_VAR(BlockSize, 73, ::g->BlockSize.generate());
-	GENERATE_VAR(ApplicationIdentifier, 74, ::g->ApplicationIdentifier.generate(8));
-	GENERATE_VAR(ApplicationAuthenticationCode, 75, ::g->ApplicationAuthenticationCode.generate(3));
+	GENERATE_VAR(BlockSize, 73, field_id_APPLICATIONSUBBLOCK_BlockSize, ::g->BlockSize.generate<Generate>());
+	GENERATE_VAR(ApplicationIdentifier, 74, field_id_APPLICATIONSUBBLOCK_ApplicationIdentifier, ::g->ApplicationIdentifier.generate<Generate>(8));
+	GENERATE_VAR(ApplicationAuthenticationCode, 75, field_id_APPLICATIONSUBBLOCK_ApplicationAuthenticationCode, ::g->ApplicationAuthenticationCode.generate<Generate>(3));
 
 	_sizeof = FTell() - _startof;
 	return this;
 }
 
 
+template<bool Generate>
 APPLICATIONEXTENTION* APPLICATIONEXTENTION::generate() {
 	if (generated == 1) {
-		APPLICATIONEXTENTION* new_instance = new APPLICATIONEXTENTION(instances);
+		APPLICATIONEXTENTION* new_instance = arena_new<APPLICATIONEXTENTION>(instances);
 		new_instance->generated = 2;
-		return new_instance->generate();
+		return new_instance->generate<Generate>();
 	}
 	if (!generated)
 		generated = 1;
 	_startof = FTell();
 
-	GENERATE_VAR(ExtensionIntroducer, 71, ::g->ExtensionIntroducer.generate());
-	GENERATE_VAR(ApplicationLabel, 72, ::g->ApplicationLabel.generate());
-	GENERATE_VAR(ApplicationSubBlock, 76, ::g->ApplicationSubBlock.generate());
-	GENERATE_VAR(ApplicationData, 77, ::g->ApplicationData.generate());
+	GENERATE_VAR(ExtensionIntroducer, 71, field_id_APPLICATIONEXTENTION_ExtensionIntroducer, ::g->ExtensionIntroducer.generate<Generate>());
+	GENERATE_VAR(ApplicationLabel, 72, field_id_APPLICATIONEXTENTION_ApplicationLabel, ::g->ApplicationLabel.generate<Generate>());
+	GENERATE_VAR(ApplicationSubBlock, 76, field_id_APPLICATIONEXTENTION_ApplicationSubBlock, ::g->ApplicationSubBlock.generate<Generate>());
+	GENERATE_VAR(ApplicationData, 77, field_id_APPLICATIONEXTENTION_ApplicationData, ::g->ApplicationData.generate<Generate>());
 
 	_sizeof = FTell() - _startof;
 	return this;
 }
 
 
+template<bool Generate>
 UNDEFINEDDATA* UNDEFINEDDATA::generate() {
 	if (generated == 1) {
-		UNDEFINEDDATA* new_instance = new UNDEFINEDDATA(instances);
+		UNDEFINEDDATA* new_instance = arena_new<UNDEFINEDDATA>(instances);
 		new_instance->generated = 2;
-		return new_instance->generate();
+		return new_instance->generate<Generate>();
 	}
 	if (!generated)
 		generated = 1;
 	_startof = FTell();
 
-	GENERATE_VAR(ExtensionIntroducer, 79, ::g->ExtensionIntroducer.generate());
-	GENERATE_VAR(Label, 80, ::g->Label.generate());
-	GENERATE_VAR(DataSubBlocks, 81, ::g->DataSubBlocks.generate());
+	GENERATE_VAR(ExtensionIntroducer, 79, field_id_UNDEFINEDDATA_ExtensionIntroducer, ::g->ExtensionIntroducer.generate<Generate>());
+	GENERATE_VAR(Label, 80, field_id_UNDEFINEDDATA_Label, ::g->Label.generate<Generate>());
+	GENERATE_VAR(DataSubBlocks, 81, field_id_UNDEFINEDDATA_DataSubBlocks, ::g->DataSubBlocks.generate<Generate>());
 
 	_sizeof = FTell() - _startof;
 	return this;
 }
 
 
+template<bool Generate>
 DATA* DATA::generate() {
 	if (generated == 1) {
-		DATA* new_instance = new DATA(instances);
+		DATA* new_instance = arena_new<DATA>(instances);
 		new_instance->generated = 2;
-		return new_instance->generate();
+		return new_instance->generate<Generate>();
 	}
 	if (!generated)
 		generated = 1;
@@ -2052,39 +2128,39 @@ DATA* DATA::generate() {
 		possible = { 0x2C };
 	};
 	has_data = false;
-	while ((ReadUByte(FTell(), possible) != 0x3B)) {
-		if ((ReadUByte(FTell()) == 0x2C)) {
+	while ((ReadUByte<Generate>(FTell(), possible) != 0x3B)) {
+		if ((ReadUByte<Generate>(FTell()) == 0x2C)) {
 			if (!has_data) {
 				has_data = true;
 				possible.insert(possible.end(), { 0x3B });
 			};
 			SetBackColor(0xE0FFE0);
-			GENERATE_VAR(ImageDescriptor, 30, ::g->ImageDescriptor.generate());
+			GENERATE_VAR(ImageDescriptor, 30, field_id_DATA_ImageDescriptor, ::g->ImageDescriptor.generate<Generate>());
 			if ((ImageDescriptor().PackedFields().LocalColorTableFlag() == 1)) {
 				SetBackColor(0xC0FFC0);
-				GENERATE_VAR(LocalColorTable, 32, ::g->LocalColorTable.generate());
+				GENERATE_VAR(LocalColorTable, 32, field_id_DATA_LocalColorTable, ::g->LocalColorTable.generate<Generate>());
 			};
 			SetBackColor(0xA0FFA0);
-			GENERATE_VAR(ImageData, 39, ::g->ImageData.generate());
+			GENERATE_VAR(ImageData, 39, field_id_DATA_ImageData, ::g->ImageData.generate<Generate>());
 		} else {
-		if ((ReadUShort(FTell()) == 0xF921)) {
+		if ((ReadUShort<Generate>(FTell()) == 0xF921)) {
 			SetBackColor(0xC0FFFF);
-			GENERATE_VAR(GraphicControlExtension, 52, ::g->GraphicControlExtension.generate());
+			GENERATE_VAR(GraphicControlExtension, 52, field_id_DATA_GraphicControlExtension, ::g->GraphicControlExtension.generate<Generate>());
 		} else {
-		if ((ReadUShort(FTell()) == 0xFE21)) {
+		if ((ReadUShort<Generate>(FTell()) == 0xFE21)) {
 			SetBackColor(0xFFFFC0);
-			GENERATE_VAR(CommentExtension, 56, ::g->CommentExtension.generate());
+			GENERATE_VAR(CommentExtension, 56, field_id_DATA_CommentExtension, ::g->CommentExtension.generate<Generate>());
 		} else {
-		if ((ReadUShort(FTell()) == 0x0121)) {
+		if ((ReadUShort<Generate>(FTell()) == 0x0121)) {
 			SetBackColor(0xC0C0C0);
-			GENERATE_VAR(PlainTextExtension, 70, ::g->PlainTextExtension.generate());
+			GENERATE_VAR(PlainTextExtension, 70, field_id_DATA_PlainTextExtension, ::g->PlainTextExtension.generate<Generate>());
 		} else {
-		if ((ReadUShort(FTell()) == 0xFF21)) {
+		if ((ReadUShort<Generate>(FTell()) == 0xFF21)) {
 			SetBackColor(0xC0C0FF);
-			GENERATE_VAR(ApplicationExtension, 78, ::g->ApplicationExtension.generate());
+			GENERATE_VAR(ApplicationExtension, 78, field_id_DATA_ApplicationExtension, ::g->ApplicationExtension.generate<Generate>());
 		} else {
 			SetBackColor(0xFF8080);
-			GENERATE_VAR(UndefinedData, 82, ::g->UndefinedData.generate());
+			GENERATE_VAR(UndefinedData, 82, field_id_DATA_UndefinedData, ::g->UndefinedData.generate<Generate>());
 		};
 		};
 		};
@@ -2097,17 +2173,18 @@ DATA* DATA::generate() {
 }
 
 
+template<bool Generate>
 TRAILER* TRAILER::generate() {
 	if (generated == 1) {
-		TRAILER* new_instance = new TRAILER(instances);
+		TRAILER* new_instance = arena_new<TRAILER>(instances);
 		new_instance->generated = 2;
-		return new_instance->generate();
+		return new_instance->generate<Generate>();
 	}
 	if (!generated)
 		generated = 1;
 	_startof = FTell();
 
-	GENERATE_VAR(GIFTrailer, 84, ::g->GIFTrailer.generate({ 0x3B }));
+	GENERATE_VAR(GIFTrailer, 84, field_id_TRAILER_GIFTrailer, ::g->GIFTrailer.generate<Generate>({ 0x3B }));
 
 	_sizeof = FTell() - _startof;
 	return this;
@@ -2115,31 +2192,37 @@ TRAILER* TRAILER::generate() {
 
 
 
+template<bool Generate>
 void generate_file() {
-	::g = new globals_class();
+	::g = arena_new<globals_class>();
 
 	LittleEndian();
 	SetBackColor(0xFFFFFF);
-	GENERATE(GifHeader, 2, ::g->GifHeader.generate());
+	GENERATE(GifHeader, 2, field_id_GifHeader, ::g->GifHeader.generate<Generate>());
 	if ((::g->GifHeader().Signature() != "GIF")) {
 		Warning("File is not a valid GIF. Template stopped.");
 		exit_template(-1);
 	};
 	SetBackColor(0xE0E0E0);
-	GENERATE(LogicalScreenDescriptor, 13, ::g->LogicalScreenDescriptor.generate());
+	GENERATE(LogicalScreenDescriptor, 13, field_id_LogicalScreenDescriptor, ::g->LogicalScreenDescriptor.generate<Generate>());
 	if ((::g->LogicalScreenDescriptor().PackedFields().GlobalColorTableFlag() == 1)) {
 		SetBackColor(0xC0C0C0);
-		GENERATE(GlobalColorTable, 18, ::g->GlobalColorTable.generate());
+		GENERATE(GlobalColorTable, 18, field_id_GlobalColorTable, ::g->GlobalColorTable.generate<Generate>());
 	};
 	SetBackColor(0xFFFFFF);
-	GENERATE(Data, 83, ::g->Data_.generate());
+	GENERATE(Data, 83, field_id_Data, ::g->Data_.generate<Generate>());
 	SetBackColor(0xFFFFFF);
 	SetEvilBit(false);
-	GENERATE(Trailer, 85, ::g->Trailer.generate());
+	GENERATE(Trailer, 85, field_id_Trailer, ::g->Trailer.generate<Generate>());
 
-	file_acc.finish();
+	file_acc.finish<Generate>();
 	delete_globals();
 }
 
-void delete_globals() { delete ::g; }
+void delete_globals() {
+	arena_delete(::g);
+	instance_arena.reset();
+}
+
+const uint64_t template_hash = 0xa26e0ad543b87852ULL;
 
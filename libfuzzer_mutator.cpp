@@ -0,0 +1,132 @@
+// libfuzzer_mutator.cpp
+// libFuzzer custom mutator for FormatFuzzer
+//
+// Fuzzer inputs are decision files.  LLVMFuzzerTestOneInput() generates
+// the file from the decisions and passes it to ff_test_one_input(), which
+// the fuzz target defines instead of LLVMFuzzerTestOneInput().
+// LLVMFuzzerCustomMutator() and LLVMFuzzerCustomCrossOver() apply smart
+// mutations to the decisions; if no smart crossover applies, the two
+// inputs are spliced at random points.  Mutations depend only on the seed
+// given by libFuzzer, so that runs can be reproduced; no files are
+// accessed.
+//
+// Build with `make gif-libfuzzer.o' and link the object into the target:
+//   clang++ -fsanitize=fuzzer target.cpp gif-libfuzzer.o -lz -lpthread
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <random>
+#include <stdint.h>
+
+#include "formatfuzzer.h"
+
+extern "C" size_t ff_generate(unsigned char* data, size_t size, unsigned char** new_data);
+extern "C" int process_data(const unsigned char *data, size_t size);
+extern "C" void reset_corpus();
+extern "C" int one_smart_mutation(int target_file_index, unsigned char** file, unsigned* file_size);
+extern "C" int smart_crossover(int target_file_index, int source_file_index, unsigned char** file, unsigned* file_size);
+extern "C" void seed_mutations(unsigned seed);
+extern "C" void ff_set_decision_tail(int mode);
+extern thread_local bool get_parse_tree;
+extern thread_local std::mt19937 mutation_rng;
+uint64_t hash_data(const unsigned char *data, size_t size);
+unsigned copy_rand(unsigned char *dest);
+unsigned int consumedRand();
+void set_generator();
+
+extern "C" int ff_test_one_input(const uint8_t *data, size_t size);
+extern "C" size_t LLVMFuzzerMutate(uint8_t *data, size_t size, size_t max_size);
+
+// Smart mutations to try before giving up on an input
+#define MUTATION_TRIES 8
+// Inputs kept in the chunk corpus before it is rebuilt
+#define CORPUS_LIMIT 4096
+
+// Corpus index of every input seen since the last reset, by hash of its
+// contents
+static std::unordered_map<uint64_t, int> file_indices;
+static std::vector<unsigned char> decisions;
+
+// Make room for n more inputs in the chunk corpus
+static void reserve_inputs(size_t n) {
+	if (file_indices.size() + n > CORPUS_LIMIT) {
+		reset_corpus();
+		file_indices.clear();
+	}
+}
+
+static int add_input(const uint8_t *data, size_t size) {
+	uint64_t hash = hash_data(data, size);
+	auto it = file_indices.find(hash);
+	if (it != file_indices.end())
+		return it->second;
+	int index = process_data(data, size);
+	file_indices.emplace(hash, index);
+	return index;
+}
+
+// Copy the decisions of the last mutation to out
+static size_t copy_decisions(uint8_t *out, size_t max_size) {
+	decisions.resize(consumedRand());
+	copy_rand(decisions.data());
+	size_t size = std::min(decisions.size(), max_size);
+	memcpy(out, decisions.data(), size);
+	return size;
+}
+
+// Write a prefix of data1 followed by a suffix of data2 to out
+static size_t splice(const uint8_t *data1, size_t size1, const uint8_t *data2, size_t size2, uint8_t *out, size_t max_out_size) {
+	size_t head = std::min((size_t) (mutation_rng() % (size1 + 1)), max_out_size);
+	size_t tail = std::min((size_t) (mutation_rng() % (size2 + 1)), max_out_size - head);
+	memcpy(out, data1, head);
+	memcpy(out + head, data2 + size2 - tail, tail);
+	return head + tail;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+	unsigned char *file = NULL;
+	set_generator();
+	get_parse_tree = false;
+	// Inputs cut short by -max_len or libFuzzer's own mutations go on with
+	// random decisions.  Generation does not write to the decisions.
+	ff_set_decision_tail(FF_TAIL_RANDOM);
+	size_t file_size = ff_generate((unsigned char *) data, size, &file);
+	if (!file)
+		return 0;
+	return ff_test_one_input(file, file_size);
+}
+
+extern "C" size_t LLVMFuzzerCustomMutator(uint8_t *data, size_t size, size_t max_size, unsigned int seed) {
+	seed_mutations(seed);
+	reserve_inputs(1);
+	int index = add_input(data, size);
+	if (index != -1) {
+		for (int i = 0; i < MUTATION_TRIES; ++i) {
+			unsigned char *file = NULL;
+			unsigned file_size = 0;
+			one_smart_mutation(index, &file, &file_size);
+			if (file && file_size)
+				return copy_decisions(data, max_size);
+		}
+	}
+	return LLVMFuzzerMutate(data, size, max_size);
+}
+
+extern "C" size_t LLVMFuzzerCustomCrossOver(const uint8_t *data1, size_t size1, const uint8_t *data2, size_t size2, uint8_t *out, size_t max_out_size, unsigned int seed) {
+	seed_mutations(seed);
+	reserve_inputs(2);
+	int target = add_input(data1, size1);
+	int source = add_input(data2, size2);
+	for (int i = 0; target != -1 && source != -1 && i < MUTATION_TRIES; ++i) {
+		unsigned char *file = NULL;
+		unsigned file_size = 0;
+		smart_crossover(target, source, &file, &file_size);
+		if (file && file_size)
+			return copy_decisions(out, max_out_size);
+	}
+	return splice(data1, size1, data2, size2, out, max_out_size);
+}
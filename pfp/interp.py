@@ -653,6 +653,12 @@ def record(classname, decl, index):
     if index not in elements:
         elements.append(index)
 
+def fnv1a_64(text):
+    h = 0xcbf29ce484222325
+    for b in text.encode("utf-8"):
+        h = ((h ^ b) * 0x100000001b3) & 0xffffffffffffffff
+    return h
+
 def create_path_dict(path_dict, current, status):
     if current == 'file':
         for element in final_reachability_dict[current]:
@@ -837,7 +843,7 @@ class PfpInterp(object):
             if node.name not in self._defined:
                 self._defined[node.name] = classname
                 self._globals.append((node.name, classname + " " + node.name + "(" + classname + "_" + node.name + "_instances);\n"))
-                self._instances += "std::vector<" + classname + "*> " + classname + "_" + node.name + "_instances;\n"
+                self._instances += "thread_local std::vector<" + classname + "*> " + classname + "_" + node.name + "_instances;\n"
             name = node.name
             if hasattr(node, "originalname"):
                 name = node.originalname
@@ -848,7 +854,8 @@ class PfpInterp(object):
                 self._indexes[node.type] = self._ID
                 self._ID += 1
             self._variable_types[node.name] = classname
-            node.cpp += "(" + name + ", " + str(self._indexes[node.type]) + ", ::g->" + node.name + ".generate("
+            self._field_types[self._indexes[node.type]] = classname
+            node.cpp += "(" + name + ", " + str(self._indexes[node.type]) + ", ::g->" + node.name + ".generate<Generate>("
             arg_num = 0
             if hasattr(node.type, "args") and node.type.args:
                 for arg in node.type.args.exprs:
@@ -882,23 +889,33 @@ class PfpInterp(object):
                 self._declared.add(classname)
                 self._cpp.append((classname, "\nclass " + classname + ";\n\n"))
 
+    def _return_type(self, cpptype):
+        """Type returned by the accessor of a struct field of type cpptype:
+        strings and arrays are returned by const reference, so that reading
+        a field does not copy its whole payload.
+        """
+        if cpptype.startswith("std::string") or cpptype.startswith("std::vector<"):
+            return "const " + cpptype + "&"
+        return cpptype
+
     def add_string_class(self, classname):
         if classname not in self._defined:
             self._defined[classname] = None
             cpp = "\n\nclass " + classname + " {\n"
             cpp += "\tstd::vector<std::string> known_values;\n"
+            cpp += "\tknown_index<std::string> known_lookup;\n"
             cpp += "\tstd::string value;\n"
             cpp += "public:\n"
             cpp += "\tint64 _startof = 0;\n"
             cpp += "\tstd::size_t _sizeof = 0;\n"
-            cpp += "\tstd::string operator () () { return value; }\n"
-            cpp += "\t" + classname + "(std::vector<std::string> known_values = {}) : known_values(known_values) {}\n"
-            cpp += "\n\tstd::string generate() {\n"
+            cpp += "\tconst std::string& operator () () { return value; }\n"
+            cpp += "\t" + classname + "(std::vector<std::string> known_values = {}) : known_values(known_values), known_lookup(known_values) {}\n"
+            cpp += "\n\ttemplate<bool Generate>\n\tconst std::string& generate() {\n"
             cpp += "\t\t_startof = FTell();\n"
             cpp += "\t\tif (known_values.empty()) {\n"
-            cpp += "\t\t\tvalue = file_acc.file_string();\n"
+            cpp += "\t\t\tvalue = file_acc.file_string<Generate>();\n"
             cpp += "\t\t} else {\n"
-            cpp += "\t\t\tvalue = file_acc.file_string(known_values);\n"
+            cpp += "\t\t\tvalue = file_acc.file_string<Generate>(known_values, known_lookup);\n"
             cpp += "\t\t}\n"
             cpp += "\t\t_sizeof = value.length() + 1;\n"
             cpp += "\t\treturn value;\n"
@@ -911,46 +928,47 @@ class PfpInterp(object):
             cpp = "\n\nclass " + classname + " {\n"
             cpp += "\tint small;\n"
             cpp += "\tstd::vector<" + classtype + "> known_values;\n"
+            cpp += "\tknown_index<" + classtype + "> known_lookup;\n"
             cpp += "\t" + classtype + " value;\n"
             cpp += "public:\n"
             if not is_bitfield:
                 cpp += "\tint64 _startof = 0;\n"
                 cpp += "\tstd::size_t _sizeof = sizeof(" + classtype + ");\n"
             cpp += "\t" + classtype + " operator () () { return value; }\n"
-            cpp += "\t" + classname + "(int small, std::vector<" + classtype + "> known_values = {}) : small(small), known_values(known_values) {}\n"
+            cpp += "\t" + classname + "(int small, std::vector<" + classtype + "> known_values = {}) : small(small), known_values(known_values), known_lookup(known_values) {}\n"
             if is_bitfield:
-                cpp += "\n\t" + classtype + " generate(unsigned bits) {\n"
+                cpp += "\n\ttemplate<bool Generate>\n\t" + classtype + " generate(unsigned bits) {\n"
                 cpp += "\t\tif (!bits)\n"
                 cpp += "\t\t\treturn 0;\n"
             else:
-                cpp += "\n\t" + classtype + " generate() {\n"
+                cpp += "\n\ttemplate<bool Generate>\n\t" + classtype + " generate() {\n"
             if not is_bitfield:
                 cpp += "\t\t_startof = FTell();\n"
             cpp += "\t\tif (known_values.empty()) {\n"
             if is_bitfield:
-                cpp += "\t\t\tvalue = file_acc.file_integer(sizeof(" + classtype + "), bits, small);\n"
+                cpp += "\t\t\tvalue = file_acc.file_integer<Generate>(sizeof(" + classtype + "), bits, small);\n"
             else:
-                cpp += "\t\t\tvalue = file_acc.file_integer(sizeof(" + classtype + "), 0, small);\n"
+                cpp += "\t\t\tvalue = file_acc.file_integer<Generate>(sizeof(" + classtype + "), 0, small);\n"
             cpp += "\t\t} else {\n"
             if is_bitfield:
-                cpp += "\t\t\tvalue = file_acc.file_integer(sizeof(" + classtype + "), bits, known_values);\n"
+                cpp += "\t\t\tvalue = file_acc.file_integer<Generate>(sizeof(" + classtype + "), bits, known_values, known_lookup);\n"
             else:
-                cpp += "\t\t\tvalue = file_acc.file_integer(sizeof(" + classtype + "), 0, known_values);\n"
+                cpp += "\t\t\tvalue = file_acc.file_integer<Generate>(sizeof(" + classtype + "), 0, known_values, known_lookup);\n"
             cpp += "\t\t}\n"
             cpp += "\t\treturn value;\n"
             cpp += "\t}\n"
             if is_bitfield:
-                cpp += "\n\t" + classtype + " generate(unsigned bits, std::vector<" + classtype + "> possible_values) {\n"
+                cpp += "\n\ttemplate<bool Generate>\n\t" + classtype + " generate(unsigned bits, value_span<" + classtype + "> possible_values) {\n"
                 cpp += "\t\tif (!bits)\n"
                 cpp += "\t\t\treturn 0;\n"
             else:
-                cpp += "\n\t" + classtype + " generate(std::vector<" + classtype + "> possible_values) {\n"
+                cpp += "\n\ttemplate<bool Generate>\n\t" + classtype + " generate(value_span<" + classtype + "> possible_values) {\n"
             if not is_bitfield:
                 cpp += "\t\t_startof = FTell();\n"
             if is_bitfield:
-                cpp += "\t\tvalue = file_acc.file_integer(sizeof(" + classtype + "), bits, possible_values);\n"
+                cpp += "\t\tvalue = file_acc.file_integer<Generate>(sizeof(" + classtype + "), bits, possible_values);\n"
             else:
-                cpp += "\t\tvalue = file_acc.file_integer(sizeof(" + classtype + "), 0, possible_values);\n"
+                cpp += "\t\tvalue = file_acc.file_integer<Generate>(sizeof(" + classtype + "), 0, possible_values);\n"
             cpp += "\t\treturn value;\n"
             cpp += "\t}\n"
             cpp += "};\n\n"
@@ -1072,7 +1090,7 @@ class PfpInterp(object):
             elif False and is_union and decl.type.cpp == "std::string" and decl.type.__class__ == AST.ArrayDecl:
                 cpp += "\tstd::string " + name + "() {\n\t\tassert_cond(" + name + "_exists, \"struct field " + name + " does not exist\");\n\t\treturn std::string(" + name + "_var, " + decl.type.dim.cpp + ");\n\t}\n"
             else:
-                cpp += "\t" + decl.type.cpp + " " + name + "() {\n\t\tassert_cond(" + name + "_exists, \"struct field " + name + " does not exist\");\n\t\treturn " + name + "_var;\n\t}\n"
+                cpp += "\t" + self._return_type(decl.type.cpp) + " " + name + "() {\n\t\tassert_cond(" + name + "_exists, \"struct field " + name + " does not exist\");\n\t\treturn " + name + "_var;\n\t}\n"
 
         locals_cpp = ""
         for decl in decls:
@@ -1122,10 +1140,10 @@ class PfpInterp(object):
         cpp += "\t\t\t" + classname + "* instance = instances.back();\n"
         cpp += "\t\t\tinstances.pop_back();\n"
         cpp += "\t\t\tif (instance->generated == 2)\n"
-        cpp += "\t\t\t\tdelete instance;\n"
+        cpp += "\t\t\t\tarena_delete(instance);\n"
         cpp += "\t\t}\n"
         cpp += "\t}\n"
-        cpp += "\t" + classname + "* generate("
+        cpp += "\ttemplate<bool Generate>\n\t" + classname + "* generate("
         if hasattr(classnode, "args") and classnode.args is not None:
             for param in classnode.args.params:
                 if hasattr(param.type.type, "names"):
@@ -1147,7 +1165,7 @@ class PfpInterp(object):
                 if field_name not in self._defined:
                     self._defined[field_name] = classname
                     self._globals.append((field_name, classname + " " + node.name + "(" + classname + "_" + node.name + "_instances);\n"))
-                    self._instances += "std::vector<" + classname + "*> " + classname + "_" + node.name + "_instances;\n"
+                    self._instances += "thread_local std::vector<" + classname + "*> " + classname + "_" + node.name + "_instances;\n"
                 name = field_name
                 if hasattr(node, "originalname"):
                     name = node.originalname
@@ -1160,7 +1178,8 @@ class PfpInterp(object):
                 else:
                     record('file', node, self._indexes[node.type])
                 self._variable_types[field_name] = classname
-                node.cpp += "(" + name + ", " + str(self._indexes[node.type]) + ", ::g->" + field_name + ".generate("
+                self._field_types[self._indexes[node.type]] = classname
+                node.cpp += "(" + name + ", " + str(self._indexes[node.type]) + ", ::g->" + field_name + ".generate<Generate>("
                 arg_num = 0
                 todofield = "/*TODO field " + field_name + ", ID: "+ str(self._indexes[node.type])+"("
                 if hasattr(node.type, "args") and node.type.args:
@@ -1186,7 +1205,7 @@ class PfpInterp(object):
             return
         self._defined[classname + "::generate"] = None
         cpp = ""
-        cpp += "\n" + classname + "* " + classname + "::generate("
+        cpp += "\ntemplate<bool Generate>\n" + classname + "* " + classname + "::generate("
         params = []
         if hasattr(classnode, "args") and classnode.args is not None:
             for param in classnode.args.params:
@@ -1202,9 +1221,9 @@ class PfpInterp(object):
             cpp = cpp[:-2]
         cpp += ") {\n"
         body = "\tif (generated == 1) {\n"
-        body += "\t\t" + classname + "* new_instance = new " + classname + "(instances);\n"
+        body += "\t\t" + classname + "* new_instance = arena_new<" + classname + ">(instances);\n"
         body += "\t\tnew_instance->generated = 2;\n"
-        body += "\t\treturn new_instance->generate("
+        body += "\t\treturn new_instance->generate<Generate>("
         if hasattr(classnode, "args") and classnode.args is not None:
             for param in classnode.args.params:
                 body += param.name + ", "
@@ -1229,12 +1248,31 @@ class PfpInterp(object):
             first = False
         if "break;" in body and (classname[-7:] == "_struct" or not ("switch (" in body or "do {" in body or "while (" in body or "for (" in body)):
             body = "do {\n" + body + "} while (false);\n"
-        cpp += body
+        cpp += self.add_field_ids(classname, body)
         cpp += "\n\t_sizeof = FTell() - _startof;\n"
         cpp += "\treturn this;\n"
         cpp += "}\n\n"
         self._generates_cpp += cpp
 
+    def add_field_ids(self, owner, cpp):
+        """Pass every field generated in ``cpp`` the id of its (struct, field)
+        pair.  ``owner`` is the class generating the fields, or "" for the
+        top level.  Fields of structs that are not defined yet are still
+        placeholders; remember their owner for when they are replaced.
+        """
+        for match in re.finditer(r"/\*TODO field (\w+), ID: (\d+)\(", cpp):
+            self._field_owners[match.group(0)] = owner
+
+        def field_id(match):
+            key = (owner, match.group(2))
+            if key not in self._field_ids:
+                name = "field_id_" + (owner + "_" if owner else "") + match.group(2)
+                while name in [n for n, _ in self._field_ids.values()]:
+                    name += "_"
+                self._field_ids[key] = (name, self._field_types[int(match.group(3))])
+            return match.group(1) + "(" + match.group(2) + ", " + match.group(3) + ", " + self._field_ids[key][0] + ", "
+        return re.sub(r"\b(GENERATE(?:_VAR|_EXISTS)?)\((\w+), (\d+), (?!field_id_)", field_id, cpp)
+
     @classmethod
     def add_native(cls, name, func, ret, interp=None, send_interp=False):
         """Add the native python function ``func`` into the pfp interpreter with the
@@ -1327,6 +1365,9 @@ class PfpInterp(object):
         self._global_consts = []
         self._globals = []
         self._variable_types = {}
+        self._field_types = {}
+        self._field_ids = {}
+        self._field_owners = {}
         self._integer_ranges = [("1", "16")]
         self._instances = ""
         self._locals_stack = [[]]
@@ -1850,6 +1891,7 @@ class PfpInterp(object):
             elif "Read" + n in self._known_values:
                 node.cpp += " = { " + ", ".join(self._known_values["Read" + n]) + " }"
             node.cpp += ";\n"
+            node.cpp += "known_index<" + t + "> Read" + n + "InitIndex(Read" + n + "InitValues);\n"
             if "Read" + n in self._read_funcs:
                 lookahead.append("Read" + n)
         node.cpp += "\n\n" + self._instances
@@ -1857,6 +1899,19 @@ class PfpInterp(object):
         for var in self._variable_types:
             node.cpp += '{ "' + var + '", "' + self._variable_types[var] + '" }, '
         node.cpp = node.cpp[:-2] + " };"
+        # Fields outside of structs, and fields of late defined structs, get
+        # their ids here; structs gave theirs in add_class_generate
+        self._functions_cpp = [(n, self.add_field_ids("", c)) for n, c in self._functions_cpp]
+        node.cpp1 = self.add_field_ids("", node.cpp1)
+        pending = node.cpp1 + self._generates_cpp + "".join(c for _, c in self._functions_cpp)
+        self._to_replace = [(a, self.add_field_ids(self._field_owners.get(a[:a.find("(") + 1], ""), b) if a in pending else b) for a, b in self._to_replace]
+        node.cpp += "\n\nenum field_id : unsigned { "
+        node.cpp += ", ".join(name for name, _ in self._field_ids.values())
+        node.cpp += " };"
+        node.cpp += "\nconst unsigned field_count = " + str(len(self._field_ids)) + ";"
+        node.cpp += "\nconst char* const field_types[] = { "
+        node.cpp += ", ".join('"' + classname + '"' for _, classname in self._field_ids.values()) or '""'
+        node.cpp += " };"
         node.cpp += "\n\nstd::vector<std::vector<int>> integer_ranges = { "
         for (a, b) in self._integer_ranges:
             node.cpp += '{ ' + a + ', ' + b + ' }, '
@@ -1874,18 +1929,18 @@ class PfpInterp(object):
         node.cpp = node.cpp[:-2] + "\n"
         node.cpp += "\t{}\n"
         node.cpp += "};\n\n"
-        node.cpp += "globals_class* g;\n\n"
+        node.cpp += "thread_local globals_class* g;\n\n"
         for n, c in self._functions_cpp:
             #node.cpp += "/*" + n + "*/\n"
             node.cpp += c
         node.cpp += self._generates_cpp
-        node.cpp += "\n\nvoid generate_file() {\n"
-        node.cpp += "\t::g = new globals_class();\n\n"
+        node.cpp += "\n\ntemplate<bool Generate>\nvoid generate_file() {\n"
+        node.cpp += "\t::g = arena_new<globals_class>();\n\n"
         node.cpp += node.cpp1
-        node.cpp += "\n\tfile_acc.finish();\n"
+        node.cpp += "\n\tfile_acc.finish<Generate>();\n"
         node.cpp += "\tdelete_globals();\n"
         node.cpp += "}\n"
-        node.cpp += "\nvoid delete_globals() { delete ::g; }\n"
+        node.cpp += "\nvoid delete_globals() {\n\tarena_delete(::g);\n\tinstance_arena.reset();\n}\n"
 
         for a, b in self._to_replace:
             node.cpp = node.cpp.replace(a, b)
@@ -1896,6 +1951,9 @@ class PfpInterp(object):
         for local in self._global_consts:
             node.cpp = node.cpp.replace("/**/" + local + "()", local)
         node.cpp = node.cpp.replace("/**/", "")
+        # Fingerprint of the generated code, so that chunk databases made
+        # from another version of the template are not loaded
+        node.cpp += "\nconst uint64_t template_hash = 0x%016xULL;\n" % fnv1a_64(node.cpp)
 
         outfile = open(sys.argv[2], "w")
         print(node.cpp, file=outfile)
@@ -2317,7 +2375,7 @@ class PfpInterp(object):
                         self._globals.append((node.name + "_element", element_classname + " " + node.name + "_element(false);\n"))
                     else:
                         self._globals.append((node.name + "_element", element_classname + " " + node.name + "_element" + "(" + element_classname + "_" + node.name + "_element_instances);\n"))
-                        self._instances += "std::vector<" + element_classname + "*> " + element_classname + "_" + node.name + "_element_instances;\n"
+                        self._instances += "thread_local std::vector<" + element_classname + "*> " + element_classname + "_" + node.name + "_element_instances;\n"
 
                 cpp = ""
                 if classname.replace(" ", "_") + "_array_class" not in self._defined:
@@ -2326,14 +2384,15 @@ class PfpInterp(object):
                     cpp += "\t" + element_classname + "& " + "element;\n"
                     if is_char_array:
                         cpp += "\tstd::vector<std::string> known_values;\n"
+                        cpp += "\tknown_index<std::string> known_lookup;\n"
                     if is_native:
                         cpp += "\tstd::unordered_map<int, std::vector<" + classname + ">> element_known_values;\n"
                     cpp += "\t" + node.type.cpp + " " + "value;\n"
                     cpp += "public:\n"
                     cpp += "\tint64 _startof = 0;\n"
                     cpp += "\tstd::size_t _sizeof = 0;\n"
-                    cpp += "\t" + node.type.cpp + " operator () () { return value; }\n"
-                    cpp += "\t" + classname + " operator [] (int index) {\n"
+                    cpp += "\tconst " + node.type.cpp + "& operator () () { return value; }\n"
+                    cpp += "\t" + classname + ("& " if is_pointer else " ") + "operator [] (int index) {\n"
                     cpp += "\t\tassert_cond((unsigned)index < value.size(), \"array index out of bounds\");\n"
                     cpp += "\t\treturn " + is_pointer + "value[index];\n"
                     cpp += "\t}\n"
@@ -2342,22 +2401,22 @@ class PfpInterp(object):
                     else:
                         cpp += "\t" + classname.replace(" ", "_") + "_array_class(" + element_classname + "& element) : element(element) {}\n"
                     if is_char_array:
-                        cpp += "\t" + classname.replace(" ", "_") + "_array_class(" + element_classname + "& element, std::vector<std::string> known_values)\n\t\t: element(element), known_values(known_values) {}\n"
-                        cpp += "\n\t" + node.type.cpp + " generate(unsigned size, std::vector<std::string> possible_values = {}) {\n"
+                        cpp += "\t" + classname.replace(" ", "_") + "_array_class(" + element_classname + "& element, std::vector<std::string> known_values)\n\t\t: element(element), known_values(known_values), known_lookup(known_values) {}\n"
+                        cpp += "\n\ttemplate<bool Generate>\n\tconst " + node.type.cpp + "& generate(unsigned size, value_span<std::string> possible_values = {}) {\n"
                     else:
-                        cpp += "\n\t" + node.type.cpp + " generate(unsigned size) {\n"
-                    cpp += "\t\tcheck_array_length(size);\n"
+                        cpp += "\n\ttemplate<bool Generate>\n\tconst " + node.type.cpp + "& generate(unsigned size) {\n"
+                    cpp += "\t\tcheck_array_length<Generate>(size);\n"
                     cpp += "\t\t_startof = FTell();\n"
                     if is_char_array:
                         cpp += "\t\tvalue = \"\";\n"
                         cpp += "\t\tif (possible_values.size()) {\n"
-                        cpp += "\t\t\tvalue = file_acc.file_string(possible_values);\n"
+                        cpp += "\t\t\tvalue = file_acc.file_string<Generate>(possible_values);\n"
                         cpp += "\t\t\tassert(value.length() == size);\n"
                         cpp += "\t\t\t_sizeof = size;\n"
                         cpp += "\t\t\treturn value;\n"
                         cpp += "\t\t}\n"
                         cpp += "\t\tif (known_values.size()) {\n"
-                        cpp += "\t\t\tvalue = file_acc.file_string(known_values);\n"
+                        cpp += "\t\t\tvalue = file_acc.file_string<Generate>(known_values, known_lookup);\n"
                         cpp += "\t\t\tassert(value.length() == size);\n"
                         cpp += "\t\t\t_sizeof = size;\n"
                         cpp += "\t\t\treturn value;\n"
@@ -2365,8 +2424,8 @@ class PfpInterp(object):
                         if classname in ["char", "uchar", "unsigned char", "CHAR", "UCHAR"]:
                             cpp += "\t\tif (!element_known_values.size()) {\n"
                             cpp += "\t\t\tif (size == 0)\n"
-                            cpp += "\t\t\t\t return \"\";\n"
-                            cpp += "\t\t\tvalue = file_acc.file_string(size);\n"
+                            cpp += "\t\t\t\treturn value;\n"
+                            cpp += "\t\t\tvalue = file_acc.file_string<Generate>(size);\n"
                             cpp += "\t\t\t_sizeof = size;\n"
                             cpp += "\t\t\treturn value;\n"
                             cpp += "\t\t}\n"
@@ -2376,14 +2435,14 @@ class PfpInterp(object):
                     if is_native:
                         cpp += "\t\t\tauto known = element_known_values.find(i);\n"
                         cpp += "\t\t\tif (known == element_known_values.end()) {\n"
-                        cpp += "\t\t\t\tvalue.push_back(element.generate());\n"
+                        cpp += "\t\t\t\tvalue.push_back(element.generate<Generate>());\n"
                         cpp += "\t\t\t\t_sizeof += element._sizeof;\n"
                         cpp += "\t\t\t} else {\n"
-                        cpp += "\t\t\t\tvalue.push_back(file_acc.file_integer(sizeof(" + classname + "), 0, known->second));\n"
+                        cpp += "\t\t\t\tvalue.push_back(file_acc.file_integer<Generate>(sizeof(" + classname + "), 0, known->second));\n"
                         cpp += "\t\t\t\t_sizeof += sizeof(" + classname + ");\n"
                         cpp += "\t\t\t}\n"
                     else:
-                        cpp += "\t\t\tvalue.push_back(element.generate());\n"
+                        cpp += "\t\t\tvalue.push_back(element.generate<Generate>());\n"
                         cpp += "\t\t\t_sizeof += element._sizeof;\n"
                     cpp += "\t\t}\n"
                     cpp += "\t\treturn value;\n"
@@ -2416,8 +2475,9 @@ class PfpInterp(object):
                 if node.type not in self._indexes.keys():
                     self._indexes[node.type] = self._ID
                     self._ID += 1
+                self._field_types[self._indexes[node.type]] = classname.replace(" ", "_") + "_array_class"
                 record_temp(classname, self._indexes[node.type])
-                node.cpp += "(" + node.originalname + ", "  + str(self._indexes[node.type]) + ", ::g->" + node.name + ".generate("
+                node.cpp += "(" + node.originalname + ", "  + str(self._indexes[node.type]) + ", ::g->" + node.name + ".generate<Generate>("
                 if node.type.dim is not None:
                     node.cpp += node.type.dim.cpp
                 if node.init is not None:
@@ -2441,7 +2501,8 @@ class PfpInterp(object):
                 if node.type not in self._indexes.keys():
                     self._indexes[node.type] = self._ID
                     self._ID += 1
-                node.cpp += "(" + node.name + ", "  + str(self._indexes[node.type]) + ", " + classname + "_generate("
+                self._field_types[self._indexes[node.type]] = classname
+                node.cpp += "(" + node.name + ", "  + str(self._indexes[node.type]) + ", " + classname + "_generate<Generate>("
                 if node.init is not None:
                     self._handle_node(node.init, scope, ctxt, stream)
                     node.cpp += "{ "
@@ -2468,8 +2529,8 @@ class PfpInterp(object):
                     self._cpp.append((classname, cpp))
                 if classname + "_generate" not in self._defined:
                     self._defined[classname + "_generate"] = None
-                    cpp = "\n" + classname + " " + classname + "_generate() {\n\treturn (" + classname + ") file_acc.file_integer(sizeof(" + " ".join(node.type.type.type.names) + "), 0, " + classname + "_values);\n}\n"
-                    cpp += "\n" + classname + " " + classname + "_generate(std::vector<" + " ".join(node.type.type.type.names) + "> known_values) {\n\treturn (" + classname + ") file_acc.file_integer(sizeof(" + " ".join(node.type.type.type.names) + "), 0, known_values);\n}\n"
+                    cpp = "\ntemplate<bool Generate>\n" + classname + " " + classname + "_generate() {\n\treturn (" + classname + ") file_acc.file_integer<Generate>(sizeof(" + " ".join(node.type.type.type.names) + "), 0, " + classname + "_values, " + classname + "_values_index);\n}\n"
+                    cpp += "\ntemplate<bool Generate>\n" + classname + " " + classname + "_generate(value_span<" + " ".join(node.type.type.type.names) + "> known_values) {\n\treturn (" + classname + ") file_acc.file_integer<Generate>(sizeof(" + " ".join(node.type.type.type.names) + "), 0, known_values);\n}\n"
                     self._cpp.append((classname + "_generate", cpp))
             elif isinstance(node.type.type, AST.Union) or isinstance(node.type.type, AST.Struct):
                 if hasattr(node.type.type, "name"):
@@ -2548,7 +2609,8 @@ class PfpInterp(object):
                     if node.type not in self._indexes.keys():
                         self._indexes[node.type] = self._ID
                         self._ID += 1
-                    node.cpp += "(" + node.originalname + ", "  + str(self._indexes[node.type]) + ", ::g->" + node.name + ".generate("
+                    self._field_types[self._indexes[node.type]] = classnamebits
+                    node.cpp += "(" + node.originalname + ", "  + str(self._indexes[node.type]) + ", ::g->" + node.name + ".generate<Generate>("
                     if is_bitfield:
                         node.cpp += node.bitsize.cpp
                     if node.init is not None:
@@ -2573,7 +2635,8 @@ class PfpInterp(object):
                     if node.type not in self._indexes.keys():
                         self._indexes[node.type] = self._ID
                         self._ID += 1
-                    node.cpp += "(" + node.name + ", "  + str(self._indexes[node.type]) + ", " + classname + "_generate("
+                    self._field_types[self._indexes[node.type]] = classname
+                    node.cpp += "(" + node.name + ", "  + str(self._indexes[node.type]) + ", " + classname + "_generate<Generate>("
                     if node.init is not None:
                         self._handle_node(node.init, scope, ctxt, stream)
                         node.cpp += "{ "
@@ -2585,8 +2648,8 @@ class PfpInterp(object):
                     node.type.cpp = nodetype.typename
                     if classname + "_generate" not in self._defined:
                         self._defined[classname + "_generate"] = None
-                        cpp = "\n" + classname + " " + classname + "_generate() {\n\treturn (" + classname + ") file_acc.file_integer(sizeof(" + nodetype.typename + "), 0, " + classname + "_values);\n}\n"
-                        cpp += "\n" + classname + " " + classname + "_generate(std::vector<" + nodetype.typename + "> known_values) {\n\treturn (" + classname + ") file_acc.file_integer(sizeof(" + nodetype.typename + "), 0, known_values);\n}\n"
+                        cpp = "\ntemplate<bool Generate>\n" + classname + " " + classname + "_generate() {\n\treturn (" + classname + ") file_acc.file_integer<Generate>(sizeof(" + nodetype.typename + "), 0, " + classname + "_values, " + classname + "_values_index);\n}\n"
+                        cpp += "\ntemplate<bool Generate>\n" + classname + " " + classname + "_generate(value_span<" + nodetype.typename + "> known_values) {\n\treturn (" + classname + ") file_acc.file_integer<Generate>(sizeof(" + nodetype.typename + "), 0, known_values);\n}\n"
                         self._cpp.append((classname + "_generate", cpp))
                 else:
                     if hasattr(nodetype, "_pfp__node"):
@@ -2996,6 +3059,7 @@ class PfpInterp(object):
                 cpp += enumerator.name + ", "
             cpp = cpp[:-2]
             cpp += " };\n"
+            cpp += "known_index<" + " ".join(node.type.type.type.names) + "> " + node.name + "_values_index(" + node.name + "_values);\n"
             self._cpp.append((node.name, node.cpp + ";\n" + cpp))
             node.cpp = ""
         elif isinstance(node.type, AST.ArrayDecl):
@@ -3605,7 +3669,12 @@ class PfpInterp(object):
         func = self._handle_node(node.name, scope, ctxt, stream)
         if node.name.name.startswith("Read"):
             self._read_funcs.add(node.name.name)
-        node.cpp = "" + node.name.name + "("
+        node.cpp = "" + node.name.name
+        # Functions of the template and those of bt.h that read or
+        # generate the file are instantiated once per mode
+        if hasattr(func, "node") or node.name.name.startswith("Read") or node.name.name in ["FEof", "FSeek", "FSkip", "FileSize", "FindFirst", "IsParsing"]:
+            node.cpp += "<Generate>"
+        node.cpp += "("
         if node.name.name in ["FEof", "FSeek", "FSkip", "FileSize"]:
             self._fstat_funcs.add(node.name.name)
         if node.name.name in ["Printf", "SPrintf", "Warning"]:
@@ -3626,7 +3695,7 @@ class PfpInterp(object):
         if node.args:
             node.cpp += ", ".join([arg.cpp for arg in node.args.exprs])
         node.cpp += ")"
-        if node.name.name in ["SetEvilBit", "ChangeArrayLength", "EndChangeArrayLength", "IsParsing"]:
+        if node.name.name in ["SetEvilBit", "ChangeArrayLength", "EndChangeArrayLength", "IsParsing", "ChecksumStart", "ChecksumEnd"]:
             return
         self._locals_stack.append([])
         self._call_stack.append(None)
@@ -3634,6 +3703,7 @@ class PfpInterp(object):
         self._call_stack.pop()
         self._locals_stack.pop()
         if hasattr(func, "node") and func.node.cpp == "":
+            func.node.cpp = "template<bool Generate>\n"
             for name in func.node.decl.type.type.type.names:
                 if name == "string":
                     name = "std::string"
@@ -3828,6 +3898,7 @@ class PfpInterp(object):
                     cpp += enumerator.name + ", "
                 cpp = cpp[:-2]
                 cpp += " };\n"
+                cpp += "known_index<" + " ".join(node.type.names) + "> " + name + "_values_index(" + name + "_values);\n"
                 self._cpp.append((name, node.cpp + ";\n" + cpp))
             else:
                 self._cpp.append((name, node.cpp + ";\n"))
@@ -3890,6 +3961,106 @@ class PfpInterp(object):
                 return None
         return ary[index]
 
+    def _branch_cpp(self, branch):
+        """Return the C++ body of an if/else branch, without the braces
+
+        :branch: the iftrue or iffalse of an If node, already handled
+        :returns: the body, one statement per line
+
+        """
+        cpp = ""
+        if isinstance(branch, list):
+            for e in branch:
+                cpp += "\t" + e.cpp.replace("\n", "\n\t") + ";\n"
+        else:
+            cpp += branch.cpp
+            if not hasattr(branch, "block_items") or branch.block_items is None:
+                cpp += ";\n"
+        return cpp
+
+    def _string_compare(self, cond):
+        """Match a condition of the form field == "literal"
+
+        Only plain (possibly nested or constant-indexed) field references
+        are accepted, so that evaluating the field once instead of once per
+        comparison cannot change which random decisions are made.
+
+        :cond: the condition of an If node
+        :returns: (field cpp, literal cpp, literal length) or None
+
+        """
+        if cond.__class__ != AST.BinaryOp or cond.op != "==":
+            return None
+        if cond.right.__class__ == AST.Constant:
+            exp, const = cond.left, cond.right
+        elif cond.left.__class__ == AST.Constant:
+            exp, const = cond.right, cond.left
+        else:
+            return None
+        if const.type != "string" or "\\" in const.value:
+            return None
+        length = len(const.value) - 2
+        if length < 1 or length > 8:
+            return None
+        def plain(e):
+            if e.__class__ == AST.ID:
+                return True
+            if e.__class__ == AST.StructRef:
+                return plain(e.name)
+            if e.__class__ == AST.ArrayRef:
+                return e.subscript.__class__ == AST.Constant and plain(e.name)
+            return False
+        if not plain(exp) or not hasattr(exp, "cpp") or not hasattr(const, "cpp"):
+            return None
+        return (exp.cpp, const.cpp, length)
+
+    def _string_switch_cpp(self, node):
+        """Lower an else-if chain of string equality tests on one field
+        into a switch over the packed field value
+
+        if (type.cname == "IHDR") ... else if (type.cname == "tEXt") ...
+        compares a freshly built std::string against every literal in turn;
+        the switch evaluates the field once and dispatches on an integer.
+
+        :node: an If node whose branches have already been handled
+        :returns: the switch statement, or None if the chain does not qualify
+
+        """
+        arms = []
+        seen = set()
+        tail = node
+        while tail.__class__ == AST.If:
+            match = self._string_compare(tail.cond)
+            if match is None or match[1] in seen:
+                break
+            if arms and (match[0] != arms[0][0] or match[2] != arms[0][2]):
+                break
+            seen.add(match[1])
+            arms.append((match[0], match[1], match[2], tail.iftrue))
+            tail = tail.iffalse
+        if len(arms) < 3:
+            return None
+        bodies = [self._branch_cpp(arm[3]) for arm in arms]
+        if tail is not None:
+            bodies.append(self._branch_cpp(tail))
+        # a break in a branch targets an enclosing loop or switch
+        if any(re.search(r"\bbreak\b", body) for body in bodies):
+            return None
+        cpp = "switch (STR2KEY(" + arms[0][0] + ", " + str(arms[0][2]) + ")) {\n"
+        for arm, body in zip(arms, bodies):
+            cpp += "case STR2INT(" + arm[1] + "): {\n"
+            cpp += body
+            cpp += "\tbreak;\n}\n"
+        if tail is not None:
+            cpp += "default: {\n"
+            if tail.__class__ == AST.If:
+                cpp += "\t" + bodies[-1][:-1].replace("\n", "\n\t") + "\n"
+            else:
+                cpp += bodies[-1]
+            cpp += "}\n"
+        cpp += "}"
+        return cpp
+
     def _handle_if(self, node, scope, ctxt, stream):
         """Handle If nodes
 
@@ -3931,25 +4102,15 @@ class PfpInterp(object):
             if node.__class__ == AST.TernaryOp:
                 node.cpp = "(" + node.cond.cpp + " ? " + node.iftrue.cpp + " : " + node.iffalse.cpp + ")"
             if node.__class__ == AST.If:
-                node.cpp = "if (" + node.cond.cpp + ") {\n"
-                if isinstance(node.iftrue, list):
-                    for e in node.iftrue:
-                        node.cpp += "\t" + e.cpp.replace("\n", "\n\t") + ";\n"
-                else:
-                    node.cpp += node.iftrue.cpp
-                    if not hasattr(node.iftrue, "block_items") or node.iftrue.block_items is None:
-                        node.cpp += ";\n"
-                node.cpp += "}"
-                if node.iffalse is not None:
-                    node.cpp += " else {\n"
-                    if isinstance(node.iffalse, list):
-                        for e in node.iffalse:
-                            node.cpp += "\t" + e.cpp.replace("\n", "\n\t") + ";\n"
-                    else:
-                        node.cpp += node.iffalse.cpp
-                        if not hasattr(node.iffalse, "block_items") or node.iffalse.block_items is None:
-                            node.cpp += ";\n"
+                node.cpp = self._string_switch_cpp(node)
+                if node.cpp is None:
+                    node.cpp = "if (" + node.cond.cpp + ") {\n"
+                    node.cpp += self._branch_cpp(node.iftrue)
                     node.cpp += "}"
+                    if node.iffalse is not None:
+                        node.cpp += " else {\n"
+                        node.cpp += self._branch_cpp(node.iffalse)
+                        node.cpp += "}"
             if ret is not None:
                 if self._call_stack:
                     raise ret
@@ -4,6 +4,7 @@
 #include <vector>
 #include <unordered_map>
 #include "bt.h"
+#include "kPathInfo.cpp"
 
 enum pngColorSpaceType : byte {
 	GrayScale = (byte) 0,
@@ -13,34 +14,42 @@ enum pngColorSpaceType : byte {
 	AlphaTrueColor = (byte) 6,
 };
 std::vector<byte> pngColorSpaceType_values = { GrayScale, TrueColor, Indexed, AlphaGrayScale, AlphaTrueColor };
+known_index<byte> pngColorSpaceType_values_index(pngColorSpaceType_values);
 
 typedef enum pngColorSpaceType PNG_COLOR_SPACE_TYPE;
 std::vector<byte> PNG_COLOR_SPACE_TYPE_values = { GrayScale, TrueColor, Indexed, AlphaGrayScale, AlphaTrueColor };
+known_index<byte> PNG_COLOR_SPACE_TYPE_values_index(PNG_COLOR_SPACE_TYPE_values);
 
 enum pngCompressionMethod : byte {
 	Deflate = (byte) 0,
 };
 std::vector<byte> pngCompressionMethod_values = { Deflate };
+known_index<byte> pngCompressionMethod_values_index(pngCompressionMethod_values);
 
 typedef enum pngCompressionMethod PNG_COMPR_METHOD;
 std::vector<byte> PNG_COMPR_METHOD_values = { Deflate };
+known_index<byte> PNG_COMPR_METHOD_values_index(PNG_COMPR_METHOD_values);
 
 enum pngFilterMethod : byte {
 	AdaptiveFiltering = (byte) 0,
 };
 std::vector<byte> pngFilterMethod_values = { AdaptiveFiltering };
+known_index<byte> pngFilterMethod_values_index(pngFilterMethod_values);
 
 typedef enum pngFilterMethod PNG_FILTER_METHOD;
 std::vector<byte> PNG_FILTER_METHOD_values = { AdaptiveFiltering };
+known_index<byte> PNG_FILTER_METHOD_values_index(PNG_FILTER_METHOD_values);
 
 enum pngInterlaceMethod : byte {
 	NoInterlace = (byte) 0,
 	Adam7Interlace = (byte) 1,
 };
 std::vector<byte> pngInterlaceMethod_values = { NoInterlace, Adam7Interlace };
+known_index<byte> pngInterlaceMethod_values_index(pngInterlaceMethod_values);
 
 typedef enum pngInterlaceMethod PNG_INTERLACE_METHOD;
 std::vector<byte> PNG_INTERLACE_METHOD_values = { NoInterlace, Adam7Interlace };
+known_index<byte> PNG_INTERLACE_METHOD_values_index(PNG_INTERLACE_METHOD_values);
 
 enum PNG_SRGB_CHUNK_DATA_enum : byte {
 	Perceptual = (byte) 0,
@@ -49,9 +58,11 @@ enum PNG_SRGB_CHUNK_DATA_enum : byte {
 	AbsoluteColorimetric = (byte) 3,
 };
 std::vector<byte> PNG_SRGB_CHUNK_DATA_enum_values = { Perceptual, RelativeColorimetric, Saturation, AbsoluteColorimetric };
+known_index<byte> PNG_SRGB_CHUNK_DATA_enum_values_index(PNG_SRGB_CHUNK_DATA_enum_values);
 
 typedef enum PNG_SRGB_CHUNK_DATA_enum PNG_SRGB_CHUNK_DATA;
 std::vector<byte> PNG_SRGB_CHUNK_DATA_values = { Perceptual, RelativeColorimetric, Saturation, AbsoluteColorimetric };
+known_index<byte> PNG_SRGB_CHUNK_DATA_values_index(PNG_SRGB_CHUNK_DATA_values);
 
 enum APNG_DISPOSE_OP_enum : byte {
 	APNG_DISPOSE_OP_NONE = (byte) 0,
@@ -59,43 +70,50 @@ enum APNG_DISPOSE_OP_enum : byte {
 	APNG_DISPOSE_OP_PREVIOUS = (byte) 2,
 };
 std::vector<byte> APNG_DISPOSE_OP_enum_values = { APNG_DISPOSE_OP_NONE, APNG_DISPOSE_OP_BACKGROUND, APNG_DISPOSE_OP_PREVIOUS };
+known_index<byte> APNG_DISPOSE_OP_enum_values_index(APNG_DISPOSE_OP_enum_values);
 
 typedef enum APNG_DISPOSE_OP_enum APNG_DISPOSE_OP;
 std::vector<byte> APNG_DISPOSE_OP_values = { APNG_DISPOSE_OP_NONE, APNG_DISPOSE_OP_BACKGROUND, APNG_DISPOSE_OP_PREVIOUS };
+known_index<byte> APNG_DISPOSE_OP_values_index(APNG_DISPOSE_OP_values);
 
 enum APNG_BLEND_OP_enum : byte {
 	APNG_BLEND_OP_SOURCE = (byte) 0,
 	APNG_BLEND_OP_OVER = (byte) 1,
 };
 std::vector<byte> APNG_BLEND_OP_enum_values = { APNG_BLEND_OP_SOURCE, APNG_BLEND_OP_OVER };
+known_index<byte> APNG_BLEND_OP_enum_values_index(APNG_BLEND_OP_enum_values);
 
 typedef enum APNG_BLEND_OP_enum APNG_BLEND_OP;
 std::vector<byte> APNG_BLEND_OP_values = { APNG_BLEND_OP_SOURCE, APNG_BLEND_OP_OVER };
+known_index<byte> APNG_BLEND_OP_values_index(APNG_BLEND_OP_values);
 
 
 class uint16_class {
 	int small;
 	std::vector<uint16> known_values;
+	known_index<uint16> known_lookup;
 	uint16 value;
 public:
 	int64 _startof = 0;
 	std::size_t _sizeof = sizeof(uint16);
 	uint16 operator () () { return value; }
-	uint16_class(int small, std::vector<uint16> known_values = {}) : small(small), known_values(known_values) {}
+	uint16_class(int small, std::vector<uint16> known_values = {}) : small(small), known_values(known_values), known_lookup(known_values) {}
 
+	template<bool Generate>
 	uint16 generate() {
 		_startof = FTell();
 		if (known_values.empty()) {
-			value = file_acc.file_integer(sizeof(uint16), 0, small);
+			value = file_acc.file_integer<Generate>(sizeof(uint16), 0, small);
 		} else {
-			value = file_acc.file_integer(sizeof(uint16), 0, known_values);
+			value = file_acc.file_integer<Generate>(sizeof(uint16), 0, known_values, known_lookup);
 		}
 		return value;
 	}
 
-	uint16 generate(std::vector<uint16> possible_values) {
+	template<bool Generate>
+	uint16 generate(value_span<uint16> possible_values) {
 		_startof = FTell();
-		value = file_acc.file_integer(sizeof(uint16), 0, possible_values);
+		value = file_acc.file_integer<Generate>(sizeof(uint16), 0, possible_values);
 		return value;
 	}
 };
@@ -109,7 +127,7 @@ class uint16_array_class {
 public:
 	int64 _startof = 0;
 	std::size_t _sizeof = 0;
-	std::vector<uint16> operator () () { return value; }
+	const std::vector<uint16>& operator () () { return value; }
 	uint16 operator [] (int index) {
 		assert_cond((unsigned)index < value.size(), "array index out of bounds");
 		return value[index];
@@ -117,17 +135,18 @@ public:
 	uint16_array_class(uint16_class& element, std::unordered_map<int, std::vector<uint16>> element_known_values = {})
 		: element(element), element_known_values(element_known_values) {}
 
-	std::vector<uint16> generate(unsigned size) {
-		check_array_length(size);
+	template<bool Generate>
+	const std::vector<uint16>& generate(unsigned size) {
+		check_array_length<Generate>(size);
 		_startof = FTell();
 		value = {};
 		for (unsigned i = 0; i < size; ++i) {
 			auto known = element_known_values.find(i);
 			if (known == element_known_values.end()) {
-				value.push_back(element.generate());
+				value.push_back(element.generate<Generate>());
 				_sizeof += element._sizeof;
 			} else {
-				value.push_back(file_acc.file_integer(sizeof(uint16), 0, known->second));
+				value.push_back(file_acc.file_integer<Generate>(sizeof(uint16), 0, known->second));
 				_sizeof += sizeof(uint16);
 			}
 		}
@@ -145,7 +164,7 @@ class PNG_SIGNATURE {
 public:
 	bool btPngSignature_exists = false;
 
-	std::vector<uint16> btPngSignature() {
+	const std::vector<uint16>& btPngSignature() {
 		assert_cond(btPngSignature_exists, "struct field btPngSignature does not exist");
 		return btPngSignature_var;
 	}
@@ -166,9 +185,10 @@ public:
 			PNG_SIGNATURE* instance = instances.back();
 			instances.pop_back();
 			if (instance->generated == 2)
-				delete instance;
+				arena_delete(instance);
 		}
 	}
+	template<bool Generate>
 	PNG_SIGNATURE* generate();
 };
 
@@ -177,26 +197,29 @@ public:
 class uint32_class {
 	int small;
 	std::vector<uint32> known_values;
+	known_index<uint32> known_lookup;
 	uint32 value;
 public:
 	int64 _startof = 0;
 	std::size_t _sizeof = sizeof(uint32);
 	uint32 operator () () { return value; }
-	uint32_class(int small, std::vector<uint32> known_values = {}) : small(small), known_values(known_values) {}
+	uint32_class(int small, std::vector<uint32> known_values = {}) : small(small), known_values(known_values), known_lookup(known_values) {}
 
+	template<bool Generate>
 	uint32 generate() {
 		_startof = FTell();
 		if (known_values.empty()) {
-			value = file_acc.file_integer(sizeof(uint32), 0, small);
+			value = file_acc.file_integer<Generate>(sizeof(uint32), 0, small);
 		} else {
-			value = file_acc.file_integer(sizeof(uint32), 0, known_values);
+			value = file_acc.file_integer<Generate>(sizeof(uint32), 0, known_values, known_lookup);
 		}
 		return value;
 	}
 
-	uint32 generate(std::vector<uint32> possible_values) {
+	template<bool Generate>
+	uint32 generate(value_span<uint32> possible_values) {
 		_startof = FTell();
-		value = file_acc.file_integer(sizeof(uint32), 0, possible_values);
+		value = file_acc.file_integer<Generate>(sizeof(uint32), 0, possible_values);
 		return value;
 	}
 };
@@ -206,26 +229,29 @@ public:
 class char_class {
 	int small;
 	std::vector<char> known_values;
+	known_index<char> known_lookup;
 	char value;
 public:
 	int64 _startof = 0;
 	std::size_t _sizeof = sizeof(char);
 	char operator () () { return value; }
-	char_class(int small, std::vector<char> known_values = {}) : small(small), known_values(known_values) {}
+	char_class(int small, std::vector<char> known_values = {}) : small(small), known_values(known_values), known_lookup(known_values) {}
 
+	template<bool Generate>
 	char generate() {
 		_startof = FTell();
 		if (known_values.empty()) {
-			value = file_acc.file_integer(sizeof(char), 0, small);
+			value = file_acc.file_integer<Generate>(sizeof(char), 0, small);
 		} else {
-			value = file_acc.file_integer(sizeof(char), 0, known_values);
+			value = file_acc.file_integer<Generate>(sizeof(char), 0, known_values, known_lookup);
 		}
 		return value;
 	}
 
-	char generate(std::vector<char> possible_values) {
+	template<bool Generate>
+	char generate(value_span<char> possible_values) {
 		_startof = FTell();
-		value = file_acc.file_integer(sizeof(char), 0, possible_values);
+		value = file_acc.file_integer<Generate>(sizeof(char), 0, possible_values);
 		return value;
 	}
 };
@@ -235,12 +261,13 @@ public:
 class char_array_class {
 	char_class& element;
 	std::vector<std::string> known_values;
+	known_index<std::string> known_lookup;
 	std::unordered_map<int, std::vector<char>> element_known_values;
 	std::string value;
 public:
 	int64 _startof = 0;
 	std::size_t _sizeof = 0;
-	std::string operator () () { return value; }
+	const std::string& operator () () { return value; }
 	char operator [] (int index) {
 		assert_cond((unsigned)index < value.size(), "array index out of bounds");
 		return value[index];
@@ -248,38 +275,39 @@ public:
 	char_array_class(char_class& element, std::unordered_map<int, std::vector<char>> element_known_values = {})
 		: element(element), element_known_values(element_known_values) {}
 	char_array_class(char_class& element, std::vector<std::string> known_values)
-		: element(element), known_values(known_values) {}
+		: element(element), known_values(known_values), known_lookup(known_values) {}
 
-	std::string generate(unsigned size, std::vector<std::string> possible_values = {}) {
-		check_array_length(size);
+	template<bool Generate>
+	const std::string& generate(unsigned size, value_span<std::string> possible_values = {}) {
+		check_array_length<Generate>(size);
 		_startof = FTell();
 		value = "";
 		if (possible_values.size()) {
-			value = file_acc.file_string(possible_values);
+			value = file_acc.file_string<Generate>(possible_values);
 			assert(value.length() == size);
 			_sizeof = size;
 			return value;
 		}
 		if (known_values.size()) {
-			value = file_acc.file_string(known_values);
+			value = file_acc.file_string<Generate>(known_values, known_lookup);
 			assert(value.length() == size);
 			_sizeof = size;
 			return value;
 		}
 		if (!element_known_values.size()) {
 			if (size == 0)
-				 return "";
-			value = file_acc.file_string(size);
+				return value;
+			value = file_acc.file_string<Generate>(size);
 			_sizeof = size;
 			return value;
 		}
 		for (unsigned i = 0; i < size; ++i) {
 			auto known = element_known_values.find(i);
 			if (known == element_known_values.end()) {
-				value.push_back(element.generate());
+				value.push_back(element.generate<Generate>());
 				_sizeof += element._sizeof;
 			} else {
-				value.push_back(file_acc.file_integer(sizeof(char), 0, known->second));
+				value.push_back(file_acc.file_integer<Generate>(sizeof(char), 0, known->second));
 				_sizeof += sizeof(char);
 			}
 		}
@@ -301,7 +329,7 @@ public:
 	bool cname_exists = false;
 	bool ctype_exists = false;
 
-	std::string cname() {
+	const std::string& cname() {
 		assert_cond(cname_exists, "struct field cname does not exist");
 		return cname_var;
 	}
@@ -326,9 +354,10 @@ public:
 			CTYPE* instance = instances.back();
 			instances.pop_back();
 			if (instance->generated == 2)
-				delete instance;
+				arena_delete(instance);
 		}
 	}
+	template<bool Generate>
 	CTYPE* generate();
 };
 
@@ -337,61 +366,72 @@ const std::vector<byte> color_types = { GrayScale, TrueColor, Indexed, AlphaGray
 class ubyte_class {
 	int small;
 	std::vector<ubyte> known_values;
+	known_index<ubyte> known_lookup;
 	ubyte value;
 public:
 	int64 _startof = 0;
 	std::size_t _sizeof = sizeof(ubyte);
 	ubyte operator () () { return value; }
-	ubyte_class(int small, std::vector<ubyte> known_values = {}) : small(small), known_values(known_values) {}
+	ubyte_class(int small, std::vector<ubyte> known_values = {}) : small(small), known_values(known_values), known_lookup(known_values) {}
 
+	template<bool Generate>
 	ubyte generate() {
 		_startof = FTell();
 		if (known_values.empty()) {
-			value = file_acc.file_integer(sizeof(ubyte), 0, small);
+			value = file_acc.file_integer<Generate>(sizeof(ubyte), 0, small);
 		} else {
-			value = file_acc.file_integer(sizeof(ubyte), 0, known_values);
+			value = file_acc.file_integer<Generate>(sizeof(ubyte), 0, known_values, known_lookup);
 		}
 		return value;
 	}
 
-	ubyte generate(std::vector<ubyte> possible_values) {
+	template<bool Generate>
+	ubyte generate(value_span<ubyte> possible_values) {
 		_startof = FTell();
-		value = file_acc.file_integer(sizeof(ubyte), 0, possible_values);
+		value = file_acc.file_integer<Generate>(sizeof(ubyte), 0, possible_values);
 		return value;
 	}
 };
 
 
+template<bool Generate>
 PNG_COLOR_SPACE_TYPE PNG_COLOR_SPACE_TYPE_generate() {
-	return (PNG_COLOR_SPACE_TYPE) file_acc.file_integer(sizeof(byte), 0, PNG_COLOR_SPACE_TYPE_values);
+	return (PNG_COLOR_SPACE_TYPE) file_acc.file_integer<Generate>(sizeof(byte), 0, PNG_COLOR_SPACE_TYPE_values, PNG_COLOR_SPACE_TYPE_values_index);
 }
 
-PNG_COLOR_SPACE_TYPE PNG_COLOR_SPACE_TYPE_generate(std::vector<byte> known_values) {
-	return (PNG_COLOR_SPACE_TYPE) file_acc.file_integer(sizeof(byte), 0, known_values);
+template<bool Generate>
+PNG_COLOR_SPACE_TYPE PNG_COLOR_SPACE_TYPE_generate(value_span<byte> known_values) {
+	return (PNG_COLOR_SPACE_TYPE) file_acc.file_integer<Generate>(sizeof(byte), 0, known_values);
 }
 
+template<bool Generate>
 PNG_COMPR_METHOD PNG_COMPR_METHOD_generate() {
-	return (PNG_COMPR_METHOD) file_acc.file_integer(sizeof(byte), 0, PNG_COMPR_METHOD_values);
+	return (PNG_COMPR_METHOD) file_acc.file_integer<Generate>(sizeof(byte), 0, PNG_COMPR_METHOD_values, PNG_COMPR_METHOD_values_index);
 }
 
-PNG_COMPR_METHOD PNG_COMPR_METHOD_generate(std::vector<byte> known_values) {
-	return (PNG_COMPR_METHOD) file_acc.file_integer(sizeof(byte), 0, known_values);
+template<bool Generate>
+PNG_COMPR_METHOD PNG_COMPR_METHOD_generate(value_span<byte> known_values) {
+	return (PNG_COMPR_METHOD) file_acc.file_integer<Generate>(sizeof(byte), 0, known_values);
 }
 
+template<bool Generate>
 PNG_FILTER_METHOD PNG_FILTER_METHOD_generate() {
-	return (PNG_FILTER_METHOD) file_acc.file_integer(sizeof(byte), 0, PNG_FILTER_METHOD_values);
+	return (PNG_FILTER_METHOD) file_acc.file_integer<Generate>(sizeof(byte), 0, PNG_FILTER_METHOD_values, PNG_FILTER_METHOD_values_index);
 }
 
-PNG_FILTER_METHOD PNG_FILTER_METHOD_generate(std::vector<byte> known_values) {
-	return (PNG_FILTER_METHOD) file_acc.file_integer(sizeof(byte), 0, known_values);
+template<bool Generate>
+PNG_FILTER_METHOD PNG_FILTER_METHOD_generate(value_span<byte> known_values) {
+	return (PNG_FILTER_METHOD) file_acc.file_integer<Generate>(sizeof(byte), 0, known_values);
 }
 
+template<bool Generate>
 PNG_INTERLACE_METHOD PNG_INTERLACE_METHOD_generate() {
-	return (PNG_INTERLACE_METHOD) file_acc.file_integer(sizeof(byte), 0, PNG_INTERLACE_METHOD_values);
+	return (PNG_INTERLACE_METHOD) file_acc.file_integer<Generate>(sizeof(byte), 0, PNG_INTERLACE_METHOD_values, PNG_INTERLACE_METHOD_values_index);
 }
 
-PNG_INTERLACE_METHOD PNG_INTERLACE_METHOD_generate(std::vector<byte> known_values) {
-	return (PNG_INTERLACE_METHOD) file_acc.file_integer(sizeof(byte), 0, known_values);
+template<bool Generate>
+PNG_INTERLACE_METHOD PNG_INTERLACE_METHOD_generate(value_span<byte> known_values) {
+	return (PNG_INTERLACE_METHOD) file_acc.file_integer<Generate>(sizeof(byte), 0, known_values);
 }
 
 
@@ -460,9 +500,10 @@ public:
 			PNG_CHUNK_IHDR* instance = instances.back();
 			instances.pop_back();
 			if (instance->generated == 2)
-				delete instance;
+				arena_delete(instance);
 		}
 	}
+	template<bool Generate>
 	PNG_CHUNK_IHDR* generate();
 };
 
@@ -470,19 +511,21 @@ public:
 
 class string_class {
 	std::vector<std::string> known_values;
+	known_index<std::string> known_lookup;
 	std::string value;
 public:
 	int64 _startof = 0;
 	std::size_t _sizeof = 0;
-	std::string operator () () { return value; }
-	string_class(std::vector<std::string> known_values = {}) : known_values(known_values) {}
+	const std::string& operator () () { return value; }
+	string_class(std::vector<std::string> known_values = {}) : known_values(known_values), known_lookup(known_values) {}
 
-	std::string generate() {
+	template<bool Generate>
+	const std::string& generate() {
 		_startof = FTell();
 		if (known_values.empty()) {
-			value = file_acc.file_string();
+			value = file_acc.file_string<Generate>();
 		} else {
-			value = file_acc.file_string(known_values);
+			value = file_acc.file_string<Generate>(known_values, known_lookup);
 		}
 		_sizeof = value.length() + 1;
 		return value;
@@ -501,11 +544,11 @@ public:
 	bool label_exists = false;
 	bool data_exists = false;
 
-	std::string label() {
+	const std::string& label() {
 		assert_cond(label_exists, "struct field label does not exist");
 		return label_var;
 	}
-	std::string data() {
+	const std::string& data() {
 		assert_cond(data_exists, "struct field data does not exist");
 		return data_var;
 	}
@@ -526,9 +569,10 @@ public:
 			PNG_CHUNK_TEXT* instance = instances.back();
 			instances.pop_back();
 			if (instance->generated == 2)
-				delete instance;
+				arena_delete(instance);
 		}
 	}
+	template<bool Generate>
 	PNG_CHUNK_TEXT* generate();
 };
 
@@ -537,26 +581,29 @@ public:
 class byte_class {
 	int small;
 	std::vector<byte> known_values;
+	known_index<byte> known_lookup;
 	byte value;
 public:
 	int64 _startof = 0;
 	std::size_t _sizeof = sizeof(byte);
 	byte operator () () { return value; }
-	byte_class(int small, std::vector<byte> known_values = {}) : small(small), known_values(known_values) {}
+	byte_class(int small, std::vector<byte> known_values = {}) : small(small), known_values(known_values), known_lookup(known_values) {}
 
+	template<bool Generate>
 	byte generate() {
 		_startof = FTell();
 		if (known_values.empty()) {
-			value = file_acc.file_integer(sizeof(byte), 0, small);
+			value = file_acc.file_integer<Generate>(sizeof(byte), 0, small);
 		} else {
-			value = file_acc.file_integer(sizeof(byte), 0, known_values);
+			value = file_acc.file_integer<Generate>(sizeof(byte), 0, known_values, known_lookup);
 		}
 		return value;
 	}
 
-	byte generate(std::vector<byte> possible_values) {
+	template<bool Generate>
+	byte generate(value_span<byte> possible_values) {
 		_startof = FTell();
-		value = file_acc.file_integer(sizeof(byte), 0, possible_values);
+		value = file_acc.file_integer<Generate>(sizeof(byte), 0, possible_values);
 		return value;
 	}
 };
@@ -604,9 +651,10 @@ public:
 			PNG_PALETTE_PIXEL* instance = instances.back();
 			instances.pop_back();
 			if (instance->generated == 2)
-				delete instance;
+				arena_delete(instance);
 		}
 	}
+	template<bool Generate>
 	PNG_PALETTE_PIXEL* generate();
 };
 
@@ -618,19 +666,20 @@ class PNG_PALETTE_PIXEL_array_class {
 public:
 	int64 _startof = 0;
 	std::size_t _sizeof = 0;
-	std::vector<PNG_PALETTE_PIXEL*> operator () () { return value; }
-	PNG_PALETTE_PIXEL operator [] (int index) {
+	const std::vector<PNG_PALETTE_PIXEL*>& operator () () { return value; }
+	PNG_PALETTE_PIXEL& operator [] (int index) {
 		assert_cond((unsigned)index < value.size(), "array index out of bounds");
 		return *value[index];
 	}
 	PNG_PALETTE_PIXEL_array_class(PNG_PALETTE_PIXEL& element) : element(element) {}
 
-	std::vector<PNG_PALETTE_PIXEL*> generate(unsigned size) {
-		check_array_length(size);
+	template<bool Generate>
+	const std::vector<PNG_PALETTE_PIXEL*>& generate(unsigned size) {
+		check_array_length<Generate>(size);
 		_startof = FTell();
 		value = {};
 		for (unsigned i = 0; i < size; ++i) {
-			value.push_back(element.generate());
+			value.push_back(element.generate<Generate>());
 			_sizeof += element._sizeof;
 		}
 		return value;
@@ -647,7 +696,7 @@ class PNG_CHUNK_PLTE {
 public:
 	bool plteChunkData_exists = false;
 
-	std::vector<PNG_PALETTE_PIXEL*> plteChunkData() {
+	const std::vector<PNG_PALETTE_PIXEL*>& plteChunkData() {
 		assert_cond(plteChunkData_exists, "struct field plteChunkData does not exist");
 		return plteChunkData_var;
 	}
@@ -668,9 +717,10 @@ public:
 			PNG_CHUNK_PLTE* instance = instances.back();
 			instances.pop_back();
 			if (instance->generated == 2)
-				delete instance;
+				arena_delete(instance);
 		}
 	}
+	template<bool Generate>
 	PNG_CHUNK_PLTE* generate(int32 chunkLen);
 };
 
@@ -711,9 +761,10 @@ public:
 			PNG_POINT* instance = instances.back();
 			instances.pop_back();
 			if (instance->generated == 2)
-				delete instance;
+				arena_delete(instance);
 		}
 	}
+	template<bool Generate>
 	PNG_POINT* generate();
 };
 
@@ -766,19 +817,22 @@ public:
 			PNG_CHUNK_CHRM* instance = instances.back();
 			instances.pop_back();
 			if (instance->generated == 2)
-				delete instance;
+				arena_delete(instance);
 		}
 	}
+	template<bool Generate>
 	PNG_CHUNK_CHRM* generate();
 };
 
 
+template<bool Generate>
 PNG_SRGB_CHUNK_DATA PNG_SRGB_CHUNK_DATA_generate() {
-	return (PNG_SRGB_CHUNK_DATA) file_acc.file_integer(sizeof(byte), 0, PNG_SRGB_CHUNK_DATA_values);
+	return (PNG_SRGB_CHUNK_DATA) file_acc.file_integer<Generate>(sizeof(byte), 0, PNG_SRGB_CHUNK_DATA_values, PNG_SRGB_CHUNK_DATA_values_index);
 }
 
-PNG_SRGB_CHUNK_DATA PNG_SRGB_CHUNK_DATA_generate(std::vector<byte> known_values) {
-	return (PNG_SRGB_CHUNK_DATA) file_acc.file_integer(sizeof(byte), 0, known_values);
+template<bool Generate>
+PNG_SRGB_CHUNK_DATA PNG_SRGB_CHUNK_DATA_generate(value_span<byte> known_values) {
+	return (PNG_SRGB_CHUNK_DATA) file_acc.file_integer<Generate>(sizeof(byte), 0, known_values);
 }
 
 
@@ -811,9 +865,10 @@ public:
 			PNG_CHUNK_SRGB* instance = instances.back();
 			instances.pop_back();
 			if (instance->generated == 2)
-				delete instance;
+				arena_delete(instance);
 		}
 	}
+	template<bool Generate>
 	PNG_CHUNK_SRGB* generate();
 };
 
@@ -837,7 +892,7 @@ public:
 	bool iextTranslatedKeyword_exists = false;
 	bool iextValChunkData_exists = false;
 
-	std::string iextIdChunkData() {
+	const std::string& iextIdChunkData() {
 		assert_cond(iextIdChunkData_exists, "struct field iextIdChunkData does not exist");
 		return iextIdChunkData_var;
 	}
@@ -849,15 +904,15 @@ public:
 		assert_cond(iextComprMethod_exists, "struct field iextComprMethod does not exist");
 		return iextComprMethod_var;
 	}
-	std::string iextLanguageTag() {
+	const std::string& iextLanguageTag() {
 		assert_cond(iextLanguageTag_exists, "struct field iextLanguageTag does not exist");
 		return iextLanguageTag_var;
 	}
-	std::string iextTranslatedKeyword() {
+	const std::string& iextTranslatedKeyword() {
 		assert_cond(iextTranslatedKeyword_exists, "struct field iextTranslatedKeyword does not exist");
 		return iextTranslatedKeyword_var;
 	}
-	std::string iextValChunkData() {
+	const std::string& iextValChunkData() {
 		assert_cond(iextValChunkData_exists, "struct field iextValChunkData does not exist");
 		return iextValChunkData_var;
 	}
@@ -878,9 +933,10 @@ public:
 			PNG_CHUNK_IEXT* instance = instances.back();
 			instances.pop_back();
 			if (instance->generated == 2)
-				delete instance;
+				arena_delete(instance);
 		}
 	}
+	template<bool Generate>
 	PNG_CHUNK_IEXT* generate(int32 chunkLen);
 };
 
@@ -898,7 +954,7 @@ public:
 	bool comprMethod_exists = false;
 	bool zextValChunkData_exists = false;
 
-	std::string zextIdChunkData() {
+	const std::string& zextIdChunkData() {
 		assert_cond(zextIdChunkData_exists, "struct field zextIdChunkData does not exist");
 		return zextIdChunkData_var;
 	}
@@ -906,7 +962,7 @@ public:
 		assert_cond(comprMethod_exists, "struct field comprMethod does not exist");
 		return comprMethod_var;
 	}
-	std::string zextValChunkData() {
+	const std::string& zextValChunkData() {
 		assert_cond(zextValChunkData_exists, "struct field zextValChunkData does not exist");
 		return zextValChunkData_var;
 	}
@@ -927,9 +983,10 @@ public:
 			PNG_CHUNK_ZEXT* instance = instances.back();
 			instances.pop_back();
 			if (instance->generated == 2)
-				delete instance;
+				arena_delete(instance);
 		}
 	}
+	template<bool Generate>
 	PNG_CHUNK_ZEXT* generate(int32 chunkLen);
 };
 
@@ -938,26 +995,29 @@ public:
 class int16_class {
 	int small;
 	std::vector<int16> known_values;
+	known_index<int16> known_lookup;
 	int16 value;
 public:
 	int64 _startof = 0;
 	std::size_t _sizeof = sizeof(int16);
 	int16 operator () () { return value; }
-	int16_class(int small, std::vector<int16> known_values = {}) : small(small), known_values(known_values) {}
+	int16_class(int small, std::vector<int16> known_values = {}) : small(small), known_values(known_values), known_lookup(known_values) {}
 
+	template<bool Generate>
 	int16 generate() {
 		_startof = FTell();
 		if (known_values.empty()) {
-			value = file_acc.file_integer(sizeof(int16), 0, small);
+			value = file_acc.file_integer<Generate>(sizeof(int16), 0, small);
 		} else {
-			value = file_acc.file_integer(sizeof(int16), 0, known_values);
+			value = file_acc.file_integer<Generate>(sizeof(int16), 0, known_values, known_lookup);
 		}
 		return value;
 	}
 
-	int16 generate(std::vector<int16> possible_values) {
+	template<bool Generate>
+	int16 generate(value_span<int16> possible_values) {
 		_startof = FTell();
-		value = file_acc.file_integer(sizeof(int16), 0, possible_values);
+		value = file_acc.file_integer<Generate>(sizeof(int16), 0, possible_values);
 		return value;
 	}
 };
@@ -1023,9 +1083,10 @@ public:
 			PNG_CHUNK_TIME* instance = instances.back();
 			instances.pop_back();
 			if (instance->generated == 2)
-				delete instance;
+				arena_delete(instance);
 		}
 	}
+	template<bool Generate>
 	PNG_CHUNK_TIME* generate();
 };
 
@@ -1034,26 +1095,29 @@ public:
 class uint_class {
 	int small;
 	std::vector<uint> known_values;
+	known_index<uint> known_lookup;
 	uint value;
 public:
 	int64 _startof = 0;
 	std::size_t _sizeof = sizeof(uint);
 	uint operator () () { return value; }
-	uint_class(int small, std::vector<uint> known_values = {}) : small(small), known_values(known_values) {}
+	uint_class(int small, std::vector<uint> known_values = {}) : small(small), known_values(known_values), known_lookup(known_values) {}
 
+	template<bool Generate>
 	uint generate() {
 		_startof = FTell();
 		if (known_values.empty()) {
-			value = file_acc.file_integer(sizeof(uint), 0, small);
+			value = file_acc.file_integer<Generate>(sizeof(uint), 0, small);
 		} else {
-			value = file_acc.file_integer(sizeof(uint), 0, known_values);
+			value = file_acc.file_integer<Generate>(sizeof(uint), 0, known_values, known_lookup);
 		}
 		return value;
 	}
 
-	uint generate(std::vector<uint> possible_values) {
+	template<bool Generate>
+	uint generate(value_span<uint> possible_values) {
 		_startof = FTell();
-		value = file_acc.file_integer(sizeof(uint), 0, possible_values);
+		value = file_acc.file_integer<Generate>(sizeof(uint), 0, possible_values);
 		return value;
 	}
 };
@@ -1064,13 +1128,16 @@ enum physUnitSpec_enum : byte {
 	Meter = (byte) 1,
 };
 std::vector<byte> physUnitSpec_enum_values = { UnkownUnit, Meter };
+known_index<byte> physUnitSpec_enum_values_index(physUnitSpec_enum_values);
 
+template<bool Generate>
 physUnitSpec_enum physUnitSpec_enum_generate() {
-	return (physUnitSpec_enum) file_acc.file_integer(sizeof(byte), 0, physUnitSpec_enum_values);
+	return (physUnitSpec_enum) file_acc.file_integer<Generate>(sizeof(byte), 0, physUnitSpec_enum_values, physUnitSpec_enum_values_index);
 }
 
-physUnitSpec_enum physUnitSpec_enum_generate(std::vector<byte> known_values) {
-	return (physUnitSpec_enum) file_acc.file_integer(sizeof(byte), 0, known_values);
+template<bool Generate>
+physUnitSpec_enum physUnitSpec_enum_generate(value_span<byte> known_values) {
+	return (physUnitSpec_enum) file_acc.file_integer<Generate>(sizeof(byte), 0, known_values);
 }
 
 
@@ -1115,9 +1182,10 @@ public:
 			PNG_CHUNK_PHYS* instance = instances.back();
 			instances.pop_back();
 			if (instance->generated == 2)
-				delete instance;
+				arena_delete(instance);
 		}
 	}
+	template<bool Generate>
 	PNG_CHUNK_PHYS* generate();
 };
 
@@ -1176,9 +1244,10 @@ public:
 			PNG_CHUNK_BKGD* instance = instances.back();
 			instances.pop_back();
 			if (instance->generated == 2)
-				delete instance;
+				arena_delete(instance);
 		}
 	}
+	template<bool Generate>
 	PNG_CHUNK_BKGD* generate(int32 colorType);
 };
 
@@ -1285,9 +1354,10 @@ public:
 			PNG_CHUNK_SBIT* instance = instances.back();
 			instances.pop_back();
 			if (instance->generated == 2)
-				delete instance;
+				arena_delete(instance);
 		}
 	}
+	template<bool Generate>
 	PNG_CHUNK_SBIT* generate(int32 colorType);
 };
 
@@ -1296,12 +1366,13 @@ public:
 class byte_array_class {
 	byte_class& element;
 	std::vector<std::string> known_values;
+	known_index<std::string> known_lookup;
 	std::unordered_map<int, std::vector<byte>> element_known_values;
 	std::string value;
 public:
 	int64 _startof = 0;
 	std::size_t _sizeof = 0;
-	std::string operator () () { return value; }
+	const std::string& operator () () { return value; }
 	byte operator [] (int index) {
 		assert_cond((unsigned)index < value.size(), "array index out of bounds");
 		return value[index];
@@ -1309,20 +1380,21 @@ public:
 	byte_array_class(byte_class& element, std::unordered_map<int, std::vector<byte>> element_known_values = {})
 		: element(element), element_known_values(element_known_values) {}
 	byte_array_class(byte_class& element, std::vector<std::string> known_values)
-		: element(element), known_values(known_values) {}
+		: element(element), known_values(known_values), known_lookup(known_values) {}
 
-	std::string generate(unsigned size, std::vector<std::string> possible_values = {}) {
-		check_array_length(size);
+	template<bool Generate>
+	const std::string& generate(unsigned size, value_span<std::string> possible_values = {}) {
+		check_array_length<Generate>(size);
 		_startof = FTell();
 		value = "";
 		if (possible_values.size()) {
-			value = file_acc.file_string(possible_values);
+			value = file_acc.file_string<Generate>(possible_values);
 			assert(value.length() == size);
 			_sizeof = size;
 			return value;
 		}
 		if (known_values.size()) {
-			value = file_acc.file_string(known_values);
+			value = file_acc.file_string<Generate>(known_values, known_lookup);
 			assert(value.length() == size);
 			_sizeof = size;
 			return value;
@@ -1330,10 +1402,10 @@ public:
 		for (unsigned i = 0; i < size; ++i) {
 			auto known = element_known_values.find(i);
 			if (known == element_known_values.end()) {
-				value.push_back(element.generate());
+				value.push_back(element.generate<Generate>());
 				_sizeof += element._sizeof;
 			} else {
-				value.push_back(file_acc.file_integer(sizeof(byte), 0, known->second));
+				value.push_back(file_acc.file_integer<Generate>(sizeof(byte), 0, known->second));
 				_sizeof += sizeof(byte);
 			}
 		}
@@ -1355,7 +1427,7 @@ public:
 	bool sampleDepth_exists = false;
 	bool spltData_exists = false;
 
-	std::string paletteName() {
+	const std::string& paletteName() {
 		assert_cond(paletteName_exists, "struct field paletteName does not exist");
 		return paletteName_var;
 	}
@@ -1363,7 +1435,7 @@ public:
 		assert_cond(sampleDepth_exists, "struct field sampleDepth does not exist");
 		return sampleDepth_var;
 	}
-	std::string spltData() {
+	const std::string& spltData() {
 		assert_cond(spltData_exists, "struct field spltData does not exist");
 		return spltData_var;
 	}
@@ -1384,9 +1456,10 @@ public:
 			PNG_CHUNK_SPLT* instance = instances.back();
 			instances.pop_back();
 			if (instance->generated == 2)
-				delete instance;
+				arena_delete(instance);
 		}
 	}
+	template<bool Generate>
 	PNG_CHUNK_SPLT* generate(int32 chunkLen);
 };
 
@@ -1427,27 +1500,32 @@ public:
 			PNG_CHUNK_ACTL* instance = instances.back();
 			instances.pop_back();
 			if (instance->generated == 2)
-				delete instance;
+				arena_delete(instance);
 		}
 	}
+	template<bool Generate>
 	PNG_CHUNK_ACTL* generate();
 };
 
 
+template<bool Generate>
 APNG_DISPOSE_OP APNG_DISPOSE_OP_generate() {
-	return (APNG_DISPOSE_OP) file_acc.file_integer(sizeof(byte), 0, APNG_DISPOSE_OP_values);
+	return (APNG_DISPOSE_OP) file_acc.file_integer<Generate>(sizeof(byte), 0, APNG_DISPOSE_OP_values, APNG_DISPOSE_OP_values_index);
 }
 
-APNG_DISPOSE_OP APNG_DISPOSE_OP_generate(std::vector<byte> known_values) {
-	return (APNG_DISPOSE_OP) file_acc.file_integer(sizeof(byte), 0, known_values);
+template<bool Generate>
+APNG_DISPOSE_OP APNG_DISPOSE_OP_generate(value_span<byte> known_values) {
+	return (APNG_DISPOSE_OP) file_acc.file_integer<Generate>(sizeof(byte), 0, known_values);
 }
 
+template<bool Generate>
 APNG_BLEND_OP APNG_BLEND_OP_generate() {
-	return (APNG_BLEND_OP) file_acc.file_integer(sizeof(byte), 0, APNG_BLEND_OP_values);
+	return (APNG_BLEND_OP) file_acc.file_integer<Generate>(sizeof(byte), 0, APNG_BLEND_OP_values, APNG_BLEND_OP_values_index);
 }
 
-APNG_BLEND_OP APNG_BLEND_OP_generate(std::vector<byte> known_values) {
-	return (APNG_BLEND_OP) file_acc.file_integer(sizeof(byte), 0, known_values);
+template<bool Generate>
+APNG_BLEND_OP APNG_BLEND_OP_generate(value_span<byte> known_values) {
+	return (APNG_BLEND_OP) file_acc.file_integer<Generate>(sizeof(byte), 0, known_values);
 }
 
 
@@ -1528,9 +1606,10 @@ public:
 			PNG_CHUNK_FCTL* instance = instances.back();
 			instances.pop_back();
 			if (instance->generated == 2)
-				delete instance;
+				arena_delete(instance);
 		}
 	}
+	template<bool Generate>
 	PNG_CHUNK_FCTL* generate();
 };
 
@@ -1539,12 +1618,13 @@ public:
 class ubyte_array_class {
 	ubyte_class& element;
 	std::vector<std::string> known_values;
+	known_index<std::string> known_lookup;
 	std::unordered_map<int, std::vector<ubyte>> element_known_values;
 	std::string value;
 public:
 	int64 _startof = 0;
 	std::size_t _sizeof = 0;
-	std::string operator () () { return value; }
+	const std::string& operator () () { return value; }
 	ubyte operator [] (int index) {
 		assert_cond((unsigned)index < value.size(), "array index out of bounds");
 		return value[index];
@@ -1552,20 +1632,21 @@ public:
 	ubyte_array_class(ubyte_class& element, std::unordered_map<int, std::vector<ubyte>> element_known_values = {})
 		: element(element), element_known_values(element_known_values) {}
 	ubyte_array_class(ubyte_class& element, std::vector<std::string> known_values)
-		: element(element), known_values(known_values) {}
+		: element(element), known_values(known_values), known_lookup(known_values) {}
 
-	std::string generate(unsigned size, std::vector<std::string> possible_values = {}) {
-		check_array_length(size);
+	template<bool Generate>
+	const std::string& generate(unsigned size, value_span<std::string> possible_values = {}) {
+		check_array_length<Generate>(size);
 		_startof = FTell();
 		value = "";
 		if (possible_values.size()) {
-			value = file_acc.file_string(possible_values);
+			value = file_acc.file_string<Generate>(possible_values);
 			assert(value.length() == size);
 			_sizeof = size;
 			return value;
 		}
 		if (known_values.size()) {
-			value = file_acc.file_string(known_values);
+			value = file_acc.file_string<Generate>(known_values, known_lookup);
 			assert(value.length() == size);
 			_sizeof = size;
 			return value;
@@ -1573,10 +1654,10 @@ public:
 		for (unsigned i = 0; i < size; ++i) {
 			auto known = element_known_values.find(i);
 			if (known == element_known_values.end()) {
-				value.push_back(element.generate());
+				value.push_back(element.generate<Generate>());
 				_sizeof += element._sizeof;
 			} else {
-				value.push_back(file_acc.file_integer(sizeof(ubyte), 0, known->second));
+				value.push_back(file_acc.file_integer<Generate>(sizeof(ubyte), 0, known->second));
 				_sizeof += sizeof(ubyte);
 			}
 		}
@@ -1600,7 +1681,7 @@ public:
 		assert_cond(sequence_number_exists, "struct field sequence_number does not exist");
 		return sequence_number_var;
 	}
-	std::string frame_data() {
+	const std::string& frame_data() {
 		assert_cond(frame_data_exists, "struct field frame_data does not exist");
 		return frame_data_var;
 	}
@@ -1621,9 +1702,10 @@ public:
 			PNG_CHUNK_FDAT* instance = instances.back();
 			instances.pop_back();
 			if (instance->generated == 2)
-				delete instance;
+				arena_delete(instance);
 		}
 	}
+	template<bool Generate>
 	PNG_CHUNK_FDAT* generate();
 };
 
@@ -1743,7 +1825,7 @@ public:
 		assert_cond(fdat_exists, "struct field fdat does not exist");
 		return *fdat_var;
 	}
-	std::string data() {
+	const std::string& data() {
 		assert_cond(data_exists, "struct field data does not exist");
 		return data_var;
 	}
@@ -1758,10 +1840,10 @@ public:
 
 	/* locals */
 	int64 pos_start;
+	int crc_range;
 	int64 pos_end;
 	uint32 correct_length;
 	int evil;
-	int64 data_size;
 	uint32 crc_calc;
 	std::string msg;
 
@@ -1781,55 +1863,74 @@ public:
 			PNG_CHUNK* instance = instances.back();
 			instances.pop_back();
 			if (instance->generated == 2)
-				delete instance;
+				arena_delete(instance);
 		}
 	}
+	template<bool Generate>
 	PNG_CHUNK* generate();
 };
 
 std::vector<byte> ReadByteInitValues;
+known_index<byte> ReadByteInitIndex(ReadByteInitValues);
 std::vector<ubyte> ReadUByteInitValues;
+known_index<ubyte> ReadUByteInitIndex(ReadUByteInitValues);
 std::vector<short> ReadShortInitValues;
+known_index<short> ReadShortInitIndex(ReadShortInitValues);
 std::vector<ushort> ReadUShortInitValues;
+known_index<ushort> ReadUShortInitIndex(ReadUShortInitValues);
 std::vector<int> ReadIntInitValues;
+known_index<int> ReadIntInitIndex(ReadIntInitValues);
 std::vector<uint> ReadUIntInitValues;
+known_index<uint> ReadUIntInitIndex(ReadUIntInitValues);
 std::vector<int64> ReadQuadInitValues;
+known_index<int64> ReadQuadInitIndex(ReadQuadInitValues);
 std::vector<uint64> ReadUQuadInitValues;
+known_index<uint64> ReadUQuadInitIndex(ReadUQuadInitValues);
 std::vector<int64> ReadInt64InitValues;
+known_index<int64> ReadInt64InitIndex(ReadInt64InitValues);
 std::vector<uint64> ReadUInt64InitValues;
+known_index<uint64> ReadUInt64InitIndex(ReadUInt64InitValues);
 std::vector<hfloat> ReadHFloatInitValues;
+known_index<hfloat> ReadHFloatInitIndex(ReadHFloatInitValues);
 std::vector<float> ReadFloatInitValues;
+known_index<float> ReadFloatInitIndex(ReadFloatInitValues);
 std::vector<double> ReadDoubleInitValues;
+known_index<double> ReadDoubleInitIndex(ReadDoubleInitValues);
 std::vector<std::string> ReadBytesInitValues;
-
-
-std::vector<PNG_SIGNATURE*> PNG_SIGNATURE_sig_instances;
-std::vector<CTYPE*> CTYPE_type_instances;
-std::vector<PNG_CHUNK_IHDR*> PNG_CHUNK_IHDR_ihdr_instances;
-std::vector<PNG_CHUNK_TEXT*> PNG_CHUNK_TEXT_text_instances;
-std::vector<PNG_PALETTE_PIXEL*> PNG_PALETTE_PIXEL_plteChunkData_element_instances;
-std::vector<PNG_CHUNK_PLTE*> PNG_CHUNK_PLTE_plte_instances;
-std::vector<PNG_POINT*> PNG_POINT_white_instances;
-std::vector<PNG_POINT*> PNG_POINT_red_instances;
-std::vector<PNG_POINT*> PNG_POINT_green_instances;
-std::vector<PNG_POINT*> PNG_POINT_blue_instances;
-std::vector<PNG_CHUNK_CHRM*> PNG_CHUNK_CHRM_chrm_instances;
-std::vector<PNG_CHUNK_SRGB*> PNG_CHUNK_SRGB_srgb_instances;
-std::vector<PNG_CHUNK_IEXT*> PNG_CHUNK_IEXT_iext_instances;
-std::vector<PNG_CHUNK_ZEXT*> PNG_CHUNK_ZEXT_zext_instances;
-std::vector<PNG_CHUNK_TIME*> PNG_CHUNK_TIME_time__instances;
-std::vector<PNG_CHUNK_PHYS*> PNG_CHUNK_PHYS_phys_instances;
-std::vector<PNG_CHUNK_BKGD*> PNG_CHUNK_BKGD_bkgd_instances;
-std::vector<PNG_CHUNK_SBIT*> PNG_CHUNK_SBIT_sbit_instances;
-std::vector<PNG_CHUNK_SPLT*> PNG_CHUNK_SPLT_splt_instances;
-std::vector<PNG_CHUNK_ACTL*> PNG_CHUNK_ACTL_actl_instances;
-std::vector<PNG_CHUNK_FCTL*> PNG_CHUNK_FCTL_fctl_instances;
-std::vector<PNG_CHUNK_FDAT*> PNG_CHUNK_FDAT_fdat_instances;
-std::vector<PNG_CHUNK*> PNG_CHUNK_chunk_instances;
+known_index<std::string> ReadBytesInitIndex(ReadBytesInitValues);
+
+
+thread_local std::vector<PNG_SIGNATURE*> PNG_SIGNATURE_sig_instances;
+thread_local std::vector<CTYPE*> CTYPE_type_instances;
+thread_local std::vector<PNG_CHUNK_IHDR*> PNG_CHUNK_IHDR_ihdr_instances;
+thread_local std::vector<PNG_CHUNK_TEXT*> PNG_CHUNK_TEXT_text_instances;
+thread_local std::vector<PNG_PALETTE_PIXEL*> PNG_PALETTE_PIXEL_plteChunkData_element_instances;
+thread_local std::vector<PNG_CHUNK_PLTE*> PNG_CHUNK_PLTE_plte_instances;
+thread_local std::vector<PNG_POINT*> PNG_POINT_white_instances;
+thread_local std::vector<PNG_POINT*> PNG_POINT_red_instances;
+thread_local std::vector<PNG_POINT*> PNG_POINT_green_instances;
+thread_local std::vector<PNG_POINT*> PNG_POINT_blue_instances;
+thread_local std::vector<PNG_CHUNK_CHRM*> PNG_CHUNK_CHRM_chrm_instances;
+thread_local std::vector<PNG_CHUNK_SRGB*> PNG_CHUNK_SRGB_srgb_instances;
+thread_local std::vector<PNG_CHUNK_IEXT*> PNG_CHUNK_IEXT_iext_instances;
+thread_local std::vector<PNG_CHUNK_ZEXT*> PNG_CHUNK_ZEXT_zext_instances;
+thread_local std::vector<PNG_CHUNK_TIME*> PNG_CHUNK_TIME_time__instances;
+thread_local std::vector<PNG_CHUNK_PHYS*> PNG_CHUNK_PHYS_phys_instances;
+thread_local std::vector<PNG_CHUNK_BKGD*> PNG_CHUNK_BKGD_bkgd_instances;
+thread_local std::vector<PNG_CHUNK_SBIT*> PNG_CHUNK_SBIT_sbit_instances;
+thread_local std::vector<PNG_CHUNK_SPLT*> PNG_CHUNK_SPLT_splt_instances;
+thread_local std::vector<PNG_CHUNK_ACTL*> PNG_CHUNK_ACTL_actl_instances;
+thread_local std::vector<PNG_CHUNK_FCTL*> PNG_CHUNK_FCTL_fctl_instances;
+thread_local std::vector<PNG_CHUNK_FDAT*> PNG_CHUNK_FDAT_fdat_instances;
+thread_local std::vector<PNG_CHUNK*> PNG_CHUNK_chunk_instances;
 
 
 std::unordered_map<std::string, std::string> variable_types = { { "btPngSignature", "uint16_array_class" }, { "sig", "PNG_SIGNATURE" }, { "length", "uint32_class" }, { "cname", "char_array_class" }, { "ctype", "uint32_class" }, { "type", "CTYPE" }, { "width", "uint32_class" }, { "height", "uint32_class" }, { "bits", "ubyte_class" }, { "color_type", "PNG_COLOR_SPACE_TYPE" }, { "compr_method", "PNG_COMPR_METHOD" }, { "filter_method", "PNG_FILTER_METHOD" }, { "interlace_method", "PNG_INTERLACE_METHOD" }, { "ihdr", "PNG_CHUNK_IHDR" }, { "label", "string_class" }, { "data", "char_array_class" }, { "text", "PNG_CHUNK_TEXT" }, { "btRed", "byte_class" }, { "btGreen", "byte_class" }, { "btBlue", "byte_class" }, { "plteChunkData", "PNG_PALETTE_PIXEL_array_class" }, { "plte", "PNG_CHUNK_PLTE" }, { "x", "uint32_class" }, { "y", "uint32_class" }, { "white", "PNG_POINT" }, { "red", "PNG_POINT" }, { "green", "PNG_POINT" }, { "blue", "PNG_POINT" }, { "chrm", "PNG_CHUNK_CHRM" }, { "srgbChunkData", "PNG_SRGB_CHUNK_DATA" }, { "srgb", "PNG_CHUNK_SRGB" }, { "iextIdChunkData", "string_class" }, { "iextCompressionFlag", "byte_class" }, { "iextComprMethod", "PNG_COMPR_METHOD" }, { "iextLanguageTag", "string_class" }, { "iextTranslatedKeyword", "string_class" }, { "iextValChunkData", "char_array_class" }, { "iext", "PNG_CHUNK_IEXT" }, { "zextIdChunkData", "string_class" }, { "comprMethod", "PNG_COMPR_METHOD" }, { "zextValChunkData", "char_array_class" }, { "zext", "PNG_CHUNK_ZEXT" }, { "timeYear", "int16_class" }, { "timeMonth", "byte_class" }, { "timeDay", "byte_class" }, { "timeHour", "byte_class" }, { "timeMin", "byte_class" }, { "timeSec", "byte_class" }, { "time_", "PNG_CHUNK_TIME" }, { "physPixelPerUnitX", "uint_class" }, { "physPixelPerUnitY", "uint_class" }, { "physUnitSpec", "physUnitSpec_enum" }, { "phys", "PNG_CHUNK_PHYS" }, { "bgColorPaletteIndex", "ubyte_class" }, { "bgGrayscalePixelValue", "uint16_class" }, { "bgColorPixelRed", "uint16_class" }, { "bgColorPixelGreen", "uint16_class" }, { "bgColorPixelBlue", "uint16_class" }, { "bkgd", "PNG_CHUNK_BKGD" }, { "sbitRed", "byte_class" }, { "sbitGreen", "byte_class" }, { "sbitBlue", "byte_class" }, { "sbitGraySource", "byte_class" }, { "sbitGrayAlphaSource", "byte_class" }, { "sbitGrayAlphaSourceAlpha", "byte_class" }, { "sbitColorRed", "byte_class" }, { "sbitColorGreen", "byte_class" }, { "sbitColorBlue", "byte_class" }, { "sbitColorAlphaRed", "byte_class" }, { "sbitColorAlphaGreen", "byte_class" }, { "sbitColorAlphaBlue", "byte_class" }, { "sbitColorAlphaAlpha", "byte_class" }, { "sbit", "PNG_CHUNK_SBIT" }, { "paletteName", "string_class" }, { "sampleDepth", "byte_class" }, { "spltData", "byte_array_class" }, { "splt", "PNG_CHUNK_SPLT" }, { "num_frames", "uint32_class" }, { "num_plays", "uint32_class" }, { "actl", "PNG_CHUNK_ACTL" }, { "sequence_number", "uint32_class" }, { "x_offset", "uint32_class" }, { "y_offset", "uint32_class" }, { "delay_num", "int16_class" }, { "delay_den", "int16_class" }, { "dispose_op", "APNG_DISPOSE_OP" }, { "blend_op", "APNG_BLEND_OP" }, { "fctl", "PNG_CHUNK_FCTL" }, { "frame_data", "ubyte_array_class" }, { "fdat", "PNG_CHUNK_FDAT" }, { "data_", "ubyte_array_class" }, { "crc", "uint32_class" }, { "pad", "uint16_class" }, { "chunk", "PNG_CHUNK" } };
 
+enum field_id : unsigned { field_id_PNG_SIGNATURE_btPngSignature, field_id_CTYPE_cname, field_id_CTYPE_ctype, field_id_PNG_CHUNK_IHDR_width, field_id_PNG_CHUNK_IHDR_height, field_id_PNG_CHUNK_IHDR_bits, field_id_PNG_CHUNK_IHDR_color_type, field_id_PNG_CHUNK_IHDR_compr_method, field_id_PNG_CHUNK_IHDR_filter_method, field_id_PNG_CHUNK_IHDR_interlace_method, field_id_PNG_CHUNK_TEXT_label, field_id_PNG_CHUNK_TEXT_data, field_id_PNG_PALETTE_PIXEL_btRed, field_id_PNG_PALETTE_PIXEL_btGreen, field_id_PNG_PALETTE_PIXEL_btBlue, field_id_PNG_CHUNK_PLTE_plteChunkData, field_id_PNG_POINT_x, field_id_PNG_POINT_y, field_id_PNG_CHUNK_CHRM_white, field_id_PNG_CHUNK_CHRM_red, field_id_PNG_CHUNK_CHRM_green, field_id_PNG_CHUNK_CHRM_blue, field_id_PNG_CHUNK_SRGB_srgbChunkData, field_id_PNG_CHUNK_IEXT_iextIdChunkData, field_id_PNG_CHUNK_IEXT_iextCompressionFlag, field_id_PNG_CHUNK_IEXT_iextComprMethod, field_id_PNG_CHUNK_IEXT_iextLanguageTag, field_id_PNG_CHUNK_IEXT_iextTranslatedKeyword, field_id_PNG_CHUNK_IEXT_iextValChunkData, field_id_PNG_CHUNK_ZEXT_zextIdChunkData, field_id_PNG_CHUNK_ZEXT_comprMethod, field_id_PNG_CHUNK_ZEXT_zextValChunkData, field_id_PNG_CHUNK_TIME_timeYear, field_id_PNG_CHUNK_TIME_timeMonth, field_id_PNG_CHUNK_TIME_timeDay, field_id_PNG_CHUNK_TIME_timeHour, field_id_PNG_CHUNK_TIME_timeMin, field_id_PNG_CHUNK_TIME_timeSec, field_id_PNG_CHUNK_PHYS_physPixelPerUnitX, field_id_PNG_CHUNK_PHYS_physPixelPerUnitY, field_id_PNG_CHUNK_PHYS_physUnitSpec, field_id_PNG_CHUNK_BKGD_bgColorPaletteIndex, field_id_PNG_CHUNK_BKGD_bgGrayscalePixelValue, field_id_PNG_CHUNK_BKGD_bgColorPixelRed, field_id_PNG_CHUNK_BKGD_bgColorPixelGreen, field_id_PNG_CHUNK_BKGD_bgColorPixelBlue, field_id_PNG_CHUNK_SBIT_sbitRed, field_id_PNG_CHUNK_SBIT_sbitGreen, field_id_PNG_CHUNK_SBIT_sbitBlue, field_id_PNG_CHUNK_SBIT_sbitGraySource, field_id_PNG_CHUNK_SBIT_sbitGrayAlphaSource, field_id_PNG_CHUNK_SBIT_sbitGrayAlphaSourceAlpha, field_id_PNG_CHUNK_SBIT_sbitColorRed, field_id_PNG_CHUNK_SBIT_sbitColorGreen, field_id_PNG_CHUNK_SBIT_sbitColorBlue, field_id_PNG_CHUNK_SBIT_sbitColorAlphaRed, field_id_PNG_CHUNK_SBIT_sbitColorAlphaGreen, field_id_PNG_CHUNK_SBIT_sbitColorAlphaBlue, field_id_PNG_CHUNK_SBIT_sbitColorAlphaAlpha, field_id_PNG_CHUNK_SPLT_paletteName, field_id_PNG_CHUNK_SPLT_sampleDepth, field_id_PNG_CHUNK_SPLT_spltData, field_id_PNG_CHUNK_ACTL_num_frames, field_id_PNG_CHUNK_ACTL_num_plays, field_id_PNG_CHUNK_FCTL_sequence_number, field_id_PNG_CHUNK_FCTL_width, field_id_PNG_CHUNK_FCTL_height, field_id_PNG_CHUNK_FCTL_x_offset, field_id_PNG_CHUNK_FCTL_y_offset, field_id_PNG_CHUNK_FCTL_delay_num, field_id_PNG_CHUNK_FCTL_delay_den, field_id_PNG_CHUNK_FCTL_dispose_op, field_id_PNG_CHUNK_FCTL_blend_op, field_id_PNG_CHUNK_FDAT_sequence_number, field_id_PNG_CHUNK_FDAT_frame_data, field_id_PNG_CHUNK_length, field_id_PNG_CHUNK_type, field_id_PNG_CHUNK_ihdr, field_id_PNG_CHUNK_text, field_id_PNG_CHUNK_plte, field_id_PNG_CHUNK_chrm, field_id_PNG_CHUNK_srgb, field_id_PNG_CHUNK_iext, field_id_PNG_CHUNK_zext, field_id_PNG_CHUNK_time, field_id_PNG_CHUNK_phys, field_id_PNG_CHUNK_bkgd, field_id_PNG_CHUNK_sbit, field_id_PNG_CHUNK_splt, field_id_PNG_CHUNK_actl, field_id_PNG_CHUNK_fctl, field_id_PNG_CHUNK_fdat, field_id_PNG_CHUNK_data, field_id_PNG_CHUNK_crc, field_id_PNG_CHUNK_pad, field_id_sig, field_id_chunk };
+const unsigned field_count = 97;
+const char* const field_types[] = { "uint16_array_class", "char_array_class", "uint32_class", "uint32_class", "uint32_class", "ubyte_class", "PNG_COLOR_SPACE_TYPE", "PNG_COMPR_METHOD", "PNG_FILTER_METHOD", "PNG_INTERLACE_METHOD", "string_class", "char_array_class", "byte_class", "byte_class", "byte_class", "PNG_PALETTE_PIXEL_array_class", "uint32_class", "uint32_class", "PNG_POINT", "PNG_POINT", "PNG_POINT", "PNG_POINT", "PNG_SRGB_CHUNK_DATA", "string_class", "byte_class", "PNG_COMPR_METHOD", "string_class", "string_class", "char_array_class", "string_class", "PNG_COMPR_METHOD", "char_array_class", "int16_class", "byte_class", "byte_class", "byte_class", "byte_class", "byte_class", "uint_class", "uint_class", "physUnitSpec_enum", "ubyte_class", "uint16_class", "uint16_class", "uint16_class", "uint16_class", "byte_class", "byte_class", "byte_class", "byte_class", "byte_class", "byte_class", "byte_class", "byte_class", "byte_class", "byte_class", "byte_class", "byte_class", "byte_class", "string_class", "byte_class", "byte_array_class", "uint32_class", "uint32_class", "uint32_class", "uint32_class", "uint32_class", "uint32_class", "uint32_class", "int16_class", "int16_class", "APNG_DISPOSE_OP", "APNG_BLEND_OP", "uint32_class", "ubyte_array_class", "uint32_class", "CTYPE", "PNG_CHUNK_IHDR", "PNG_CHUNK_TEXT", "PNG_CHUNK_PLTE", "PNG_CHUNK_CHRM", "PNG_CHUNK_SRGB", "PNG_CHUNK_IEXT", "PNG_CHUNK_ZEXT", "PNG_CHUNK_TIME", "PNG_CHUNK_PHYS", "PNG_CHUNK_BKGD", "PNG_CHUNK_SBIT", "PNG_CHUNK_SPLT", "PNG_CHUNK_ACTL", "PNG_CHUNK_FCTL", "PNG_CHUNK_FDAT", "ubyte_array_class", "uint32_class", "uint16_class", "PNG_SIGNATURE", "PNG_CHUNK" };
+
 std::vector<std::vector<int>> integer_ranges = { { 1, 16 }, { 1, 24 }, { 1, 24 } };
 
 class globals_class {
@@ -2028,286 +2129,301 @@ public:
 	{}
 };
 
-globals_class* g;
+thread_local globals_class* g;
 
+template<bool Generate>
 void error_message(std::string msg) {
 	Warning(msg);
 	Printf((msg + "\n"));
 }
 
+template<bool Generate>
 PNG_SIGNATURE* PNG_SIGNATURE::generate() {
 	if (generated == 1) {
-		PNG_SIGNATURE* new_instance = new PNG_SIGNATURE(instances);
+		PNG_SIGNATURE* new_instance = arena_new<PNG_SIGNATURE>(instances);
 		new_instance->generated = 2;
-		return new_instance->generate();
+		return new_instance->generate<Generate>();
 	}
 	if (!generated)
 		generated = 1;
 	_startof = FTell();
 
-	GENERATE_VAR(btPngSignature, ::g->btPngSignature.generate(4));
+	GENERATE_VAR(btPngSignature, 0, field_id_PNG_SIGNATURE_btPngSignature, ::g->btPngSignature.generate<Generate>(4));
 
 	_sizeof = FTell() - _startof;
 	return this;
 }
 
 
+template<bool Generate>
 CTYPE* CTYPE::generate() {
 	if (generated == 1) {
-		CTYPE* new_instance = new CTYPE(instances);
+		CTYPE* new_instance = arena_new<CTYPE>(instances);
 		new_instance->generated = 2;
-		return new_instance->generate();
+		return new_instance->generate<Generate>();
 	}
 	if (!generated)
 		generated = 1;
 	_startof = FTell();
 
-	GENERATE_VAR(cname, ::g->cname.generate(4));
-	GENERATE_EXISTS(ctype, ::g->ctype.generate());
+	GENERATE_VAR(cname, 3, field_id_CTYPE_cname, ::g->cname.generate<Generate>(4));
+	GENERATE_EXISTS(ctype, 4, field_id_CTYPE_ctype, ::g->ctype.generate<Generate>());
 
 	_sizeof = FTell() - _startof;
 	return this;
 }
 
 
+template<bool Generate>
 PNG_CHUNK_IHDR* PNG_CHUNK_IHDR::generate() {
 	if (generated == 1) {
-		PNG_CHUNK_IHDR* new_instance = new PNG_CHUNK_IHDR(instances);
+		PNG_CHUNK_IHDR* new_instance = arena_new<PNG_CHUNK_IHDR>(instances);
 		new_instance->generated = 2;
-		return new_instance->generate();
+		return new_instance->generate<Generate>();
 	}
 	if (!generated)
 		generated = 1;
 	_startof = FTell();
 
-	GENERATE_VAR(width, ::g->width.generate());
-	GENERATE_VAR(height, ::g->height.generate());
-	switch (ReadByte((FTell() + 1), color_types)) {
+	GENERATE_VAR(width, 6, field_id_PNG_CHUNK_IHDR_width, ::g->width.generate<Generate>());
+	GENERATE_VAR(height, 7, field_id_PNG_CHUNK_IHDR_height, ::g->height.generate<Generate>());
+	switch (ReadByte<Generate>((FTell() + 1), color_types)) {
 	case GrayScale:
-		GENERATE_VAR(bits, ::g->bits.generate({ 1, 2, 4, 8, 16 }));
+		GENERATE_VAR(bits, 8, field_id_PNG_CHUNK_IHDR_bits, ::g->bits.generate<Generate>({ 1, 2, 4, 8, 16 }));
 		break;
 	case TrueColor:
-		GENERATE_VAR(bits, ::g->bits.generate({ 8, 16 }));
+		GENERATE_VAR(bits, 9, field_id_PNG_CHUNK_IHDR_bits, ::g->bits.generate<Generate>({ 8, 16 }));
 		break;
 	case Indexed:
-		GENERATE_VAR(bits, ::g->bits.generate({ 1, 2, 4, 8 }));
+		GENERATE_VAR(bits, 10, field_id_PNG_CHUNK_IHDR_bits, ::g->bits.generate<Generate>({ 1, 2, 4, 8 }));
 		break;
 	case AlphaGrayScale:
-		GENERATE_VAR(bits, ::g->bits.generate({ 8, 16 }));
+		GENERATE_VAR(bits, 11, field_id_PNG_CHUNK_IHDR_bits, ::g->bits.generate<Generate>({ 8, 16 }));
 		break;
 	case AlphaTrueColor:
-		GENERATE_VAR(bits, ::g->bits.generate({ 8, 16 }));
+		GENERATE_VAR(bits, 12, field_id_PNG_CHUNK_IHDR_bits, ::g->bits.generate<Generate>({ 8, 16 }));
 		break;
 	default:
-		GENERATE_VAR(bits, ::g->bits.generate());
+		GENERATE_VAR(bits, 13, field_id_PNG_CHUNK_IHDR_bits, ::g->bits.generate<Generate>());
 		break;
 	};
-	GENERATE_VAR(color_type, PNG_COLOR_SPACE_TYPE_generate());
-	GENERATE_VAR(compr_method, PNG_COMPR_METHOD_generate());
-	GENERATE_VAR(filter_method, PNG_FILTER_METHOD_generate());
-	GENERATE_VAR(interlace_method, PNG_INTERLACE_METHOD_generate());
+	GENERATE_VAR(color_type, 14, field_id_PNG_CHUNK_IHDR_color_type, PNG_COLOR_SPACE_TYPE_generate<Generate>());
+	GENERATE_VAR(compr_method, 15, field_id_PNG_CHUNK_IHDR_compr_method, PNG_COMPR_METHOD_generate<Generate>());
+	GENERATE_VAR(filter_method, 16, field_id_PNG_CHUNK_IHDR_filter_method, PNG_FILTER_METHOD_generate<Generate>());
+	GENERATE_VAR(interlace_method, 17, field_id_PNG_CHUNK_IHDR_interlace_method, PNG_INTERLACE_METHOD_generate<Generate>());
 
 	_sizeof = FTell() - _startof;
 	return this;
 }
 
 
+template<bool Generate>
 PNG_CHUNK_TEXT* PNG_CHUNK_TEXT::generate() {
 	if (generated == 1) {
-		PNG_CHUNK_TEXT* new_instance = new PNG_CHUNK_TEXT(instances);
+		PNG_CHUNK_TEXT* new_instance = arena_new<PNG_CHUNK_TEXT>(instances);
 		new_instance->generated = 2;
-		return new_instance->generate();
+		return new_instance->generate<Generate>();
 	}
 	if (!generated)
 		generated = 1;
 	_startof = FTell();
 
-	GENERATE_VAR(label, ::g->label.generate());
-	GENERATE_VAR(data, ::g->data.generate(((::g->length() - Strlen(label())) - 1)));
+	GENERATE_VAR(label, 19, field_id_PNG_CHUNK_TEXT_label, ::g->label.generate<Generate>());
+	GENERATE_VAR(data, 20, field_id_PNG_CHUNK_TEXT_data, ::g->data.generate<Generate>(((::g->length() - Strlen(label())) - 1)));
 
 	_sizeof = FTell() - _startof;
 	return this;
 }
 
 
+template<bool Generate>
 PNG_PALETTE_PIXEL* PNG_PALETTE_PIXEL::generate() {
 	if (generated == 1) {
-		PNG_PALETTE_PIXEL* new_instance = new PNG_PALETTE_PIXEL(instances);
+		PNG_PALETTE_PIXEL* new_instance = arena_new<PNG_PALETTE_PIXEL>(instances);
 		new_instance->generated = 2;
-		return new_instance->generate();
+		return new_instance->generate<Generate>();
 	}
 	if (!generated)
 		generated = 1;
 	_startof = FTell();
 
-	GENERATE_VAR(btRed, ::g->btRed.generate());
-	GENERATE_VAR(btGreen, ::g->btGreen.generate());
-	GENERATE_VAR(btBlue, ::g->btBlue.generate());
+	GENERATE_VAR(btRed, 22, field_id_PNG_PALETTE_PIXEL_btRed, ::g->btRed.generate<Generate>());
+	GENERATE_VAR(btGreen, 23, field_id_PNG_PALETTE_PIXEL_btGreen, ::g->btGreen.generate<Generate>());
+	GENERATE_VAR(btBlue, 24, field_id_PNG_PALETTE_PIXEL_btBlue, ::g->btBlue.generate<Generate>());
 
 	_sizeof = FTell() - _startof;
 	return this;
 }
 
 
+template<bool Generate>
 PNG_CHUNK_PLTE* PNG_CHUNK_PLTE::generate(int32 chunkLen) {
 	if (generated == 1) {
-		PNG_CHUNK_PLTE* new_instance = new PNG_CHUNK_PLTE(instances);
+		PNG_CHUNK_PLTE* new_instance = arena_new<PNG_CHUNK_PLTE>(instances);
 		new_instance->generated = 2;
-		return new_instance->generate(chunkLen);
+		return new_instance->generate<Generate>(chunkLen);
 	}
 	if (!generated)
 		generated = 1;
 	_startof = FTell();
 
-	GENERATE_VAR(plteChunkData, ::g->plteChunkData.generate((chunkLen / 3)));
+	GENERATE_VAR(plteChunkData, 25, field_id_PNG_CHUNK_PLTE_plteChunkData, ::g->plteChunkData.generate<Generate>((chunkLen / 3)));
 
 	_sizeof = FTell() - _startof;
 	return this;
 }
 
 
+template<bool Generate>
 PNG_POINT* PNG_POINT::generate() {
 	if (generated == 1) {
-		PNG_POINT* new_instance = new PNG_POINT(instances);
+		PNG_POINT* new_instance = arena_new<PNG_POINT>(instances);
 		new_instance->generated = 2;
-		return new_instance->generate();
+		return new_instance->generate<Generate>();
 	}
 	if (!generated)
 		generated = 1;
 	_startof = FTell();
 
-	GENERATE_VAR(x, ::g->x.generate());
-	GENERATE_VAR(y, ::g->y.generate());
+	GENERATE_VAR(x, 27, field_id_PNG_POINT_x, ::g->x.generate<Generate>());
+	GENERATE_VAR(y, 28, field_id_PNG_POINT_y, ::g->y.generate<Generate>());
 
 	_sizeof = FTell() - _startof;
 	return this;
 }
 
 
+template<bool Generate>
 PNG_CHUNK_CHRM* PNG_CHUNK_CHRM::generate() {
 	if (generated == 1) {
-		PNG_CHUNK_CHRM* new_instance = new PNG_CHUNK_CHRM(instances);
+		PNG_CHUNK_CHRM* new_instance = arena_new<PNG_CHUNK_CHRM>(instances);
 		new_instance->generated = 2;
-		return new_instance->generate();
+		return new_instance->generate<Generate>();
 	}
 	if (!generated)
 		generated = 1;
 	_startof = FTell();
 
-	GENERATE_VAR(white, ::g->white.generate());
-	GENERATE_VAR(red, ::g->red.generate());
-	GENERATE_VAR(green, ::g->green.generate());
-	GENERATE_VAR(blue, ::g->blue.generate());
+	GENERATE_VAR(white, 29, field_id_PNG_CHUNK_CHRM_white, ::g->white.generate<Generate>());
+	GENERATE_VAR(red, 30, field_id_PNG_CHUNK_CHRM_red, ::g->red.generate<Generate>());
+	GENERATE_VAR(green, 31, field_id_PNG_CHUNK_CHRM_green, ::g->green.generate<Generate>());
+	GENERATE_VAR(blue, 32, field_id_PNG_CHUNK_CHRM_blue, ::g->blue.generate<Generate>());
 
 	_sizeof = FTell() - _startof;
 	return this;
 }
 
 
+template<bool Generate>
 PNG_CHUNK_SRGB* PNG_CHUNK_SRGB::generate() {
 	if (generated == 1) {
-		PNG_CHUNK_SRGB* new_instance = new PNG_CHUNK_SRGB(instances);
+		PNG_CHUNK_SRGB* new_instance = arena_new<PNG_CHUNK_SRGB>(instances);
 		new_instance->generated = 2;
-		return new_instance->generate();
+		return new_instance->generate<Generate>();
 	}
 	if (!generated)
 		generated = 1;
 	_startof = FTell();
 
-	GENERATE_VAR(srgbChunkData, PNG_SRGB_CHUNK_DATA_generate());
+	GENERATE_VAR(srgbChunkData, 34, field_id_PNG_CHUNK_SRGB_srgbChunkData, PNG_SRGB_CHUNK_DATA_generate<Generate>());
 
 	_sizeof = FTell() - _startof;
 	return this;
 }
 
 
+template<bool Generate>
 PNG_CHUNK_IEXT* PNG_CHUNK_IEXT::generate(int32 chunkLen) {
 	if (generated == 1) {
-		PNG_CHUNK_IEXT* new_instance = new PNG_CHUNK_IEXT(instances);
+		PNG_CHUNK_IEXT* new_instance = arena_new<PNG_CHUNK_IEXT>(instances);
 		new_instance->generated = 2;
-		return new_instance->generate(chunkLen);
+		return new_instance->generate<Generate>(chunkLen);
 	}
 	if (!generated)
 		generated = 1;
 	_startof = FTell();
 
-	GENERATE_VAR(iextIdChunkData, ::g->iextIdChunkData.generate());
-	GENERATE_VAR(iextCompressionFlag, ::g->iextCompressionFlag.generate());
-	GENERATE_VAR(iextComprMethod, PNG_COMPR_METHOD_generate());
-	GENERATE_VAR(iextLanguageTag, ::g->iextLanguageTag.generate());
-	GENERATE_VAR(iextTranslatedKeyword, ::g->iextTranslatedKeyword.generate());
-	GENERATE_VAR(iextValChunkData, ::g->iextValChunkData.generate((((((((chunkLen - Strlen(iextIdChunkData())) - 1) - Strlen(iextLanguageTag())) - 1) - Strlen(iextTranslatedKeyword())) - 1) - 2)));
+	GENERATE_VAR(iextIdChunkData, 36, field_id_PNG_CHUNK_IEXT_iextIdChunkData, ::g->iextIdChunkData.generate<Generate>());
+	GENERATE_VAR(iextCompressionFlag, 37, field_id_PNG_CHUNK_IEXT_iextCompressionFlag, ::g->iextCompressionFlag.generate<Generate>());
+	GENERATE_VAR(iextComprMethod, 38, field_id_PNG_CHUNK_IEXT_iextComprMethod, PNG_COMPR_METHOD_generate<Generate>());
+	GENERATE_VAR(iextLanguageTag, 39, field_id_PNG_CHUNK_IEXT_iextLanguageTag, ::g->iextLanguageTag.generate<Generate>());
+	GENERATE_VAR(iextTranslatedKeyword, 40, field_id_PNG_CHUNK_IEXT_iextTranslatedKeyword, ::g->iextTranslatedKeyword.generate<Generate>());
+	GENERATE_VAR(iextValChunkData, 41, field_id_PNG_CHUNK_IEXT_iextValChunkData, ::g->iextValChunkData.generate<Generate>((((((((chunkLen - Strlen(iextIdChunkData())) - 1) - Strlen(iextLanguageTag())) - 1) - Strlen(iextTranslatedKeyword())) - 1) - 2)));
 
 	_sizeof = FTell() - _startof;
 	return this;
 }
 
 
+template<bool Generate>
 PNG_CHUNK_ZEXT* PNG_CHUNK_ZEXT::generate(int32 chunkLen) {
 	if (generated == 1) {
-		PNG_CHUNK_ZEXT* new_instance = new PNG_CHUNK_ZEXT(instances);
+		PNG_CHUNK_ZEXT* new_instance = arena_new<PNG_CHUNK_ZEXT>(instances);
 		new_instance->generated = 2;
-		return new_instance->generate(chunkLen);
+		return new_instance->generate<Generate>(chunkLen);
 	}
 	if (!generated)
 		generated = 1;
 	_startof = FTell();
 
-	GENERATE_VAR(zextIdChunkData, ::g->zextIdChunkData.generate());
-	GENERATE_VAR(comprMethod, PNG_COMPR_METHOD_generate());
-	GENERATE_VAR(zextValChunkData, ::g->zextValChunkData.generate(((chunkLen - Strlen(zextIdChunkData())) - 2)));
+	GENERATE_VAR(zextIdChunkData, 43, field_id_PNG_CHUNK_ZEXT_zextIdChunkData, ::g->zextIdChunkData.generate<Generate>());
+	GENERATE_VAR(comprMethod, 44, field_id_PNG_CHUNK_ZEXT_comprMethod, PNG_COMPR_METHOD_generate<Generate>());
+	GENERATE_VAR(zextValChunkData, 45, field_id_PNG_CHUNK_ZEXT_zextValChunkData, ::g->zextValChunkData.generate<Generate>(((chunkLen - Strlen(zextIdChunkData())) - 2)));
 
 	_sizeof = FTell() - _startof;
 	return this;
 }
 
 
+template<bool Generate>
 PNG_CHUNK_TIME* PNG_CHUNK_TIME::generate() {
 	if (generated == 1) {
-		PNG_CHUNK_TIME* new_instance = new PNG_CHUNK_TIME(instances);
+		PNG_CHUNK_TIME* new_instance = arena_new<PNG_CHUNK_TIME>(instances);
 		new_instance->generated = 2;
-		return new_instance->generate();
+		return new_instance->generate<Generate>();
 	}
 	if (!generated)
 		generated = 1;
 	_startof = FTell();
 
-	GENERATE_VAR(timeYear, ::g->timeYear.generate());
-	GENERATE_VAR(timeMonth, ::g->timeMonth.generate());
-	GENERATE_VAR(timeDay, ::g->timeDay.generate());
-	GENERATE_VAR(timeHour, ::g->timeHour.generate());
-	GENERATE_VAR(timeMin, ::g->timeMin.generate());
-	GENERATE_VAR(timeSec, ::g->timeSec.generate());
+	GENERATE_VAR(timeYear, 47, field_id_PNG_CHUNK_TIME_timeYear, ::g->timeYear.generate<Generate>());
+	GENERATE_VAR(timeMonth, 48, field_id_PNG_CHUNK_TIME_timeMonth, ::g->timeMonth.generate<Generate>());
+	GENERATE_VAR(timeDay, 49, field_id_PNG_CHUNK_TIME_timeDay, ::g->timeDay.generate<Generate>());
+	GENERATE_VAR(timeHour, 50, field_id_PNG_CHUNK_TIME_timeHour, ::g->timeHour.generate<Generate>());
+	GENERATE_VAR(timeMin, 51, field_id_PNG_CHUNK_TIME_timeMin, ::g->timeMin.generate<Generate>());
+	GENERATE_VAR(timeSec, 52, field_id_PNG_CHUNK_TIME_timeSec, ::g->timeSec.generate<Generate>());
 
 	_sizeof = FTell() - _startof;
 	return this;
 }
 
 
+template<bool Generate>
 PNG_CHUNK_PHYS* PNG_CHUNK_PHYS::generate() {
 	if (generated == 1) {
-		PNG_CHUNK_PHYS* new_instance = new PNG_CHUNK_PHYS(instances);
+		PNG_CHUNK_PHYS* new_instance = arena_new<PNG_CHUNK_PHYS>(instances);
 		new_instance->generated = 2;
-		return new_instance->generate();
+		return new_instance->generate<Generate>();
 	}
 	if (!generated)
 		generated = 1;
 	_startof = FTell();
 
-	GENERATE_VAR(physPixelPerUnitX, ::g->physPixelPerUnitX.generate());
-	GENERATE_VAR(physPixelPerUnitY, ::g->physPixelPerUnitY.generate());
-	GENERATE_VAR(physUnitSpec, physUnitSpec_enum_generate());
+	GENERATE_VAR(physPixelPerUnitX, 54, field_id_PNG_CHUNK_PHYS_physPixelPerUnitX, ::g->physPixelPerUnitX.generate<Generate>());
+	GENERATE_VAR(physPixelPerUnitY, 55, field_id_PNG_CHUNK_PHYS_physPixelPerUnitY, ::g->physPixelPerUnitY.generate<Generate>());
+	GENERATE_VAR(physUnitSpec, 56, field_id_PNG_CHUNK_PHYS_physUnitSpec, physUnitSpec_enum_generate<Generate>());
 
 	_sizeof = FTell() - _startof;
 	return this;
 }
 
 
+template<bool Generate>
 PNG_CHUNK_BKGD* PNG_CHUNK_BKGD::generate(int32 colorType) {
 	if (generated == 1) {
-		PNG_CHUNK_BKGD* new_instance = new PNG_CHUNK_BKGD(instances);
+		PNG_CHUNK_BKGD* new_instance = arena_new<PNG_CHUNK_BKGD>(instances);
 		new_instance->generated = 2;
-		return new_instance->generate(colorType);
+		return new_instance->generate<Generate>(colorType);
 	}
 	if (!generated)
 		generated = 1;
@@ -2315,20 +2431,20 @@ PNG_CHUNK_BKGD* PNG_CHUNK_BKGD::generate(int32 colorType) {
 
 	switch (colorType) {
 	case 3:
-		GENERATE_VAR(bgColorPaletteIndex, ::g->bgColorPaletteIndex.generate());
+		GENERATE_VAR(bgColorPaletteIndex, 58, field_id_PNG_CHUNK_BKGD_bgColorPaletteIndex, ::g->bgColorPaletteIndex.generate<Generate>());
 		break;
 	case 0:
 	case 4:
-		GENERATE_VAR(bgGrayscalePixelValue, ::g->bgGrayscalePixelValue.generate());
+		GENERATE_VAR(bgGrayscalePixelValue, 59, field_id_PNG_CHUNK_BKGD_bgGrayscalePixelValue, ::g->bgGrayscalePixelValue.generate<Generate>());
 		break;
 	case 2:
 	case 6:
-		GENERATE_VAR(bgColorPixelRed, ::g->bgColorPixelRed.generate());
-		GENERATE_VAR(bgColorPixelGreen, ::g->bgColorPixelGreen.generate());
-		GENERATE_VAR(bgColorPixelBlue, ::g->bgColorPixelBlue.generate());
+		GENERATE_VAR(bgColorPixelRed, 60, field_id_PNG_CHUNK_BKGD_bgColorPixelRed, ::g->bgColorPixelRed.generate<Generate>());
+		GENERATE_VAR(bgColorPixelGreen, 61, field_id_PNG_CHUNK_BKGD_bgColorPixelGreen, ::g->bgColorPixelGreen.generate<Generate>());
+		GENERATE_VAR(bgColorPixelBlue, 62, field_id_PNG_CHUNK_BKGD_bgColorPixelBlue, ::g->bgColorPixelBlue.generate<Generate>());
 		break;
 	default:
-		error_message("*WARNING: Unknown Color Model Type for background color chunk.");
+		error_message<Generate>("*WARNING: Unknown Color Model Type for background color chunk.");
 		exit_template(-4);
 	};
 
@@ -2337,11 +2453,12 @@ PNG_CHUNK_BKGD* PNG_CHUNK_BKGD::generate(int32 colorType) {
 }
 
 
+template<bool Generate>
 PNG_CHUNK_SBIT* PNG_CHUNK_SBIT::generate(int32 colorType) {
 	if (generated == 1) {
-		PNG_CHUNK_SBIT* new_instance = new PNG_CHUNK_SBIT(instances);
+		PNG_CHUNK_SBIT* new_instance = arena_new<PNG_CHUNK_SBIT>(instances);
 		new_instance->generated = 2;
-		return new_instance->generate(colorType);
+		return new_instance->generate<Generate>(colorType);
 	}
 	if (!generated)
 		generated = 1;
@@ -2349,30 +2466,30 @@ PNG_CHUNK_SBIT* PNG_CHUNK_SBIT::generate(int32 colorType) {
 
 	switch (colorType) {
 	case 3:
-		GENERATE_VAR(sbitRed, ::g->sbitRed.generate());
-		GENERATE_VAR(sbitGreen, ::g->sbitGreen.generate());
-		GENERATE_VAR(sbitBlue, ::g->sbitBlue.generate());
+		GENERATE_VAR(sbitRed, 64, field_id_PNG_CHUNK_SBIT_sbitRed, ::g->sbitRed.generate<Generate>());
+		GENERATE_VAR(sbitGreen, 65, field_id_PNG_CHUNK_SBIT_sbitGreen, ::g->sbitGreen.generate<Generate>());
+		GENERATE_VAR(sbitBlue, 66, field_id_PNG_CHUNK_SBIT_sbitBlue, ::g->sbitBlue.generate<Generate>());
 		break;
 	case 0:
-		GENERATE_VAR(sbitGraySource, ::g->sbitGraySource.generate());
+		GENERATE_VAR(sbitGraySource, 67, field_id_PNG_CHUNK_SBIT_sbitGraySource, ::g->sbitGraySource.generate<Generate>());
 		break;
 	case 4:
-		GENERATE_VAR(sbitGrayAlphaSource, ::g->sbitGrayAlphaSource.generate());
-		GENERATE_VAR(sbitGrayAlphaSourceAlpha, ::g->sbitGrayAlphaSourceAlpha.generate());
+		GENERATE_VAR(sbitGrayAlphaSource, 68, field_id_PNG_CHUNK_SBIT_sbitGrayAlphaSource, ::g->sbitGrayAlphaSource.generate<Generate>());
+		GENERATE_VAR(sbitGrayAlphaSourceAlpha, 69, field_id_PNG_CHUNK_SBIT_sbitGrayAlphaSourceAlpha, ::g->sbitGrayAlphaSourceAlpha.generate<Generate>());
 		break;
 	case 2:
-		GENERATE_VAR(sbitColorRed, ::g->sbitColorRed.generate());
-		GENERATE_VAR(sbitColorGreen, ::g->sbitColorGreen.generate());
-		GENERATE_VAR(sbitColorBlue, ::g->sbitColorBlue.generate());
+		GENERATE_VAR(sbitColorRed, 70, field_id_PNG_CHUNK_SBIT_sbitColorRed, ::g->sbitColorRed.generate<Generate>());
+		GENERATE_VAR(sbitColorGreen, 71, field_id_PNG_CHUNK_SBIT_sbitColorGreen, ::g->sbitColorGreen.generate<Generate>());
+		GENERATE_VAR(sbitColorBlue, 72, field_id_PNG_CHUNK_SBIT_sbitColorBlue, ::g->sbitColorBlue.generate<Generate>());
 		break;
 	case 6:
-		GENERATE_VAR(sbitColorAlphaRed, ::g->sbitColorAlphaRed.generate());
-		GENERATE_VAR(sbitColorAlphaGreen, ::g->sbitColorAlphaGreen.generate());
-		GENERATE_VAR(sbitColorAlphaBlue, ::g->sbitColorAlphaBlue.generate());
-		GENERATE_VAR(sbitColorAlphaAlpha, ::g->sbitColorAlphaAlpha.generate());
+		GENERATE_VAR(sbitColorAlphaRed, 73, field_id_PNG_CHUNK_SBIT_sbitColorAlphaRed, ::g->sbitColorAlphaRed.generate<Generate>());
+		GENERATE_VAR(sbitColorAlphaGreen, 74, field_id_PNG_CHUNK_SBIT_sbitColorAlphaGreen, ::g->sbitColorAlphaGreen.generate<Generate>());
+		GENERATE_VAR(sbitColorAlphaBlue, 75, field_id_PNG_CHUNK_SBIT_sbitColorAlphaBlue, ::g->sbitColorAlphaBlue.generate<Generate>());
+		GENERATE_VAR(sbitColorAlphaAlpha, 76, field_id_PNG_CHUNK_SBIT_sbitColorAlphaAlpha, ::g->sbitColorAlphaAlpha.generate<Generate>());
 		break;
 	default:
-		error_message("*WARNING: Unknown Color Model Type for background color chunk.");
+		error_message<Generate>("*WARNING: Unknown Color Model Type for background color chunk.");
 		exit_template(-4);
 	};
 
@@ -2381,288 +2498,190 @@ PNG_CHUNK_SBIT* PNG_CHUNK_SBIT::generate(int32 colorType) {
 }
 
 
+template<bool Generate>
 PNG_CHUNK_SPLT* PNG_CHUNK_SPLT::generate(int32 chunkLen) {
 	if (generated == 1) {
-		PNG_CHUNK_SPLT* new_instance = new PNG_CHUNK_SPLT(instances);
+		PNG_CHUNK_SPLT* new_instance = arena_new<PNG_CHUNK_SPLT>(instances);
 		new_instance->generated = 2;
-		return new_instance->generate(chunkLen);
+		return new_instance->generate<Generate>(chunkLen);
 	}
 	if (!generated)
 		generated = 1;
 	_startof = FTell();
 
-	GENERATE_VAR(paletteName, ::g->paletteName.generate());
-	GENERATE_VAR(sampleDepth, ::g->sampleDepth.generate());
-	GENERATE_VAR(spltData, ::g->spltData.generate(((chunkLen - Strlen(paletteName())) - 2)));
+	GENERATE_VAR(paletteName, 78, field_id_PNG_CHUNK_SPLT_paletteName, ::g->paletteName.generate<Generate>());
+	GENERATE_VAR(sampleDepth, 79, field_id_PNG_CHUNK_SPLT_sampleDepth, ::g->sampleDepth.generate<Generate>());
+	GENERATE_VAR(spltData, 80, field_id_PNG_CHUNK_SPLT_spltData, ::g->spltData.generate<Generate>(((chunkLen - Strlen(paletteName())) - 2)));
 
 	_sizeof = FTell() - _startof;
 	return this;
 }
 
 
+template<bool Generate>
 PNG_CHUNK_ACTL* PNG_CHUNK_ACTL::generate() {
 	if (generated == 1) {
-		PNG_CHUNK_ACTL* new_instance = new PNG_CHUNK_ACTL(instances);
+		PNG_CHUNK_ACTL* new_instance = arena_new<PNG_CHUNK_ACTL>(instances);
 		new_instance->generated = 2;
-		return new_instance->generate();
+		return new_instance->generate<Generate>();
 	}
 	if (!generated)
 		generated = 1;
 	_startof = FTell();
 
-	GENERATE_VAR(num_frames, ::g->num_frames.generate());
-	GENERATE_VAR(num_plays, ::g->num_plays.generate());
+	GENERATE_VAR(num_frames, 82, field_id_PNG_CHUNK_ACTL_num_frames, ::g->num_frames.generate<Generate>());
+	GENERATE_VAR(num_plays, 83, field_id_PNG_CHUNK_ACTL_num_plays, ::g->num_plays.generate<Generate>());
 
 	_sizeof = FTell() - _startof;
 	return this;
 }
 
 
+template<bool Generate>
 PNG_CHUNK_FCTL* PNG_CHUNK_FCTL::generate() {
 	if (generated == 1) {
-		PNG_CHUNK_FCTL* new_instance = new PNG_CHUNK_FCTL(instances);
+		PNG_CHUNK_FCTL* new_instance = arena_new<PNG_CHUNK_FCTL>(instances);
 		new_instance->generated = 2;
-		return new_instance->generate();
+		return new_instance->generate<Generate>();
 	}
 	if (!generated)
 		generated = 1;
 	_startof = FTell();
 
-	GENERATE_VAR(sequence_number, ::g->sequence_number.generate({ ::g->sec_num++ }));
-	GENERATE_VAR(width, ::g->width.generate());
-	GENERATE_VAR(height, ::g->height.generate());
-	GENERATE_VAR(x_offset, ::g->x_offset.generate());
-	GENERATE_VAR(y_offset, ::g->y_offset.generate());
-	GENERATE_VAR(delay_num, ::g->delay_num.generate());
-	GENERATE_VAR(delay_den, ::g->delay_den.generate());
-	GENERATE_VAR(dispose_op, APNG_DISPOSE_OP_generate());
-	GENERATE_VAR(blend_op, APNG_BLEND_OP_generate());
+	GENERATE_VAR(sequence_number, 85, field_id_PNG_CHUNK_FCTL_sequence_number, ::g->sequence_number.generate<Generate>({ ::g->sec_num++ }));
+	GENERATE_VAR(width, 86, field_id_PNG_CHUNK_FCTL_width, ::g->width.generate<Generate>());
+	GENERATE_VAR(height, 87, field_id_PNG_CHUNK_FCTL_height, ::g->height.generate<Generate>());
+	GENERATE_VAR(x_offset, 88, field_id_PNG_CHUNK_FCTL_x_offset, ::g->x_offset.generate<Generate>());
+	GENERATE_VAR(y_offset, 89, field_id_PNG_CHUNK_FCTL_y_offset, ::g->y_offset.generate<Generate>());
+	GENERATE_VAR(delay_num, 90, field_id_PNG_CHUNK_FCTL_delay_num, ::g->delay_num.generate<Generate>());
+	GENERATE_VAR(delay_den, 91, field_id_PNG_CHUNK_FCTL_delay_den, ::g->delay_den.generate<Generate>());
+	GENERATE_VAR(dispose_op, 92, field_id_PNG_CHUNK_FCTL_dispose_op, APNG_DISPOSE_OP_generate<Generate>());
+	GENERATE_VAR(blend_op, 93, field_id_PNG_CHUNK_FCTL_blend_op, APNG_BLEND_OP_generate<Generate>());
 
 	_sizeof = FTell() - _startof;
 	return this;
 }
 
 
+template<bool Generate>
 PNG_CHUNK_FDAT* PNG_CHUNK_FDAT::generate() {
 	if (generated == 1) {
-		PNG_CHUNK_FDAT* new_instance = new PNG_CHUNK_FDAT(instances);
+		PNG_CHUNK_FDAT* new_instance = arena_new<PNG_CHUNK_FDAT>(instances);
 		new_instance->generated = 2;
-		return new_instance->generate();
+		return new_instance->generate<Generate>();
 	}
 	if (!generated)
 		generated = 1;
 	_startof = FTell();
 
-	GENERATE_VAR(sequence_number, ::g->sequence_number.generate({ ::g->sec_num++ }));
-	GENERATE_VAR(frame_data, ::g->frame_data.generate((::g->length() - 4)));
+	GENERATE_VAR(sequence_number, 95, field_id_PNG_CHUNK_FDAT_sequence_number, ::g->sequence_number.generate<Generate>({ ::g->sec_num++ }));
+	GENERATE_VAR(frame_data, 96, field_id_PNG_CHUNK_FDAT_frame_data, ::g->frame_data.generate<Generate>((::g->length() - 4)));
 
 	_sizeof = FTell() - _startof;
 	return this;
 }
 
 
-
-std::string compress_data(std::string data, int level) {
-	unsigned long data_len = data.size();
-	unsigned long comp_len = compressBound(data_len);
-	unsigned char* compressed = (unsigned char*) malloc(comp_len);
-	compress2(compressed, &comp_len, (const Bytef*) data.c_str(), data_len, level);
-	std::string compressed_str((char*) compressed, comp_len);
-	free(compressed);
-	return compressed_str;
-}
-
-std::string generate_data(uint32 width, uint32 height, PNG_COLOR_SPACE_TYPE color, ubyte bit_depth, PNG_INTERLACE_METHOD interlace) {
-	int channels_per_pixel[] = {1, 0, 3, 1, 2, 0, 4};
-	int bits_per_pixel = 0;
-	if (0 <= color && color <= 6)
-		bits_per_pixel = channels_per_pixel[color] * bit_depth;
-	assert_cond(bits_per_pixel, "Invalid color");
-	const unsigned max_size = 16384;
-	assert_cond(width <= max_size && height <= max_size && bits_per_pixel * width * height <= 4 * max_size, "image dimensions too large");
-	std::string data;
-	data.reserve(max_size);
-	unsigned char uncompressed[max_size];
-	unsigned long data_len = max_size;
-	if (!file_acc.generate) {
-		int res = uncompress(uncompressed, &data_len, &file_acc.file_buffer[file_acc.file_pos], ::g->length());
-		assert_cond (res == Z_OK, "failed to uncompress IDAT data");
-	}
-
-	int interlacing[7][4] = {{0, 8, 0, 8},
-		                 {4, 8, 0, 8},
-		                 {0, 4, 4, 8},
-		                 {2, 4, 0, 4},
-		                 {0, 2, 2, 4},
-		                 {1, 2, 0, 2},
-		                 {0, 1, 1, 2}};
-
-	if (!interlace) {
-		for (unsigned y = 0; y < height; ++y) {
-			assert_cond(data.length() < max_size, "image dimensions too large");
-			unsigned char current_byte = uncompressed[data.length()];
-			if (!file_acc.generate)
-				file_acc.parse = [&current_byte](unsigned char* file_buf) -> long long { return current_byte; };
-			unsigned char filter_type = file_acc.rand_int(5, file_acc.parse);
-			data += filter_type;
-			int bytes_per_scanline = (bits_per_pixel * width + 7)/8;
-			if (file_acc.generate) {
-				data += file_acc.rand_bytes(bytes_per_scanline);
-			} else {
-				memcpy(&file_acc.rand_buffer[file_acc.rand_pos], &uncompressed[data.length()], bytes_per_scanline);
-				file_acc.rand_pos += bytes_per_scanline;
-				std::string s((char*)&uncompressed[data.length()], bytes_per_scanline);
-				data += s;
-			}
-		}
-	} else {
-		for (unsigned pass = 0; pass < 7; ++pass) {
-			int pixels_per_scanline = (width - interlacing[pass][0] + interlacing[pass][1] - 1)/interlacing[pass][1];
-			if (!pixels_per_scanline)
-				continue;
-			int scanlines_per_pass = (height - interlacing[pass][2] + interlacing[pass][3] - 1)/interlacing[pass][3];
-			int bytes_per_scanline = (bits_per_pixel * pixels_per_scanline + 7)/8;
-			for (int y = 0; y < scanlines_per_pass; ++y) {
-				assert_cond(data.length() < max_size, "image dimensions too large");
-				unsigned char current_byte = uncompressed[data.length()];
-				if (!file_acc.generate)
-					file_acc.parse = [&current_byte](unsigned char* file_buf) -> long long { return current_byte; };
-				unsigned char filter_type = file_acc.rand_int(5, file_acc.parse);
-				data += filter_type;
-				if (file_acc.generate) {
-					data += file_acc.rand_bytes(bytes_per_scanline);
-				} else {
-					memcpy(&file_acc.rand_buffer[file_acc.rand_pos], &uncompressed[data.length()], bytes_per_scanline);
-					file_acc.rand_pos += bytes_per_scanline;
-					std::string s((char*)&uncompressed[data.length()], bytes_per_scanline);
-					data += s;
-				}
-			}
-		}
-	}
-
-	if (!file_acc.generate) {
-		assert_cond(data_len == data.length(), "wrong length for uncompressed IDAT data");
-		file_acc.parse = NULL;
-		std::string compressed((char*)&file_acc.file_buffer[file_acc.file_pos], ::g->length());
-		for (int l = 0; l < 10; ++l)
-			if (compress_data(data, l) == compressed) {
-				file_acc.parse = [l](unsigned char* file_buf) -> long long { return l + 1; };
-				break;
-			}
-		assert_cond(!!file_acc.parse, "failed to find working compression level");
-	}
-	int level = file_acc.rand_int(11, file_acc.parse) - 1;
-	return compress_data(data, level);
-}
-
-
-
+template<bool Generate>
 PNG_CHUNK* PNG_CHUNK::generate() {
 	if (generated == 1) {
-		PNG_CHUNK* new_instance = new PNG_CHUNK(instances);
+		PNG_CHUNK* new_instance = arena_new<PNG_CHUNK>(instances);
 		new_instance->generated = 2;
-		return new_instance->generate();
+		return new_instance->generate<Generate>();
 	}
 	if (!generated)
 		generated = 1;
 	_startof = FTell();
 
-	GENERATE_VAR(length, ::g->length.generate());
+	GENERATE_VAR(length, 2, field_id_PNG_CHUNK_length, ::g->length.generate<Generate>());
 	pos_start = FTell();
-	GENERATE_VAR(type, ::g->type.generate());
-	if ((type().cname() == "IHDR")) {
-		GENERATE_VAR(ihdr, ::g->ihdr.generate());
-	} else {
-	if ((type().cname() == "tEXt")) {
-		GENERATE_VAR(text, ::g->text.generate());
-	} else {
-	if ((type().cname() == "PLTE")) {
-		GENERATE_VAR(plte, ::g->plte.generate(length()));
-	} else {
-	if ((type().cname() == "cHRM")) {
-		GENERATE_VAR(chrm, ::g->chrm.generate());
-	} else {
-	if ((type().cname() == "sRGB")) {
-		GENERATE_VAR(srgb, ::g->srgb.generate());
-	} else {
-	if ((type().cname() == "iEXt")) {
-		GENERATE_VAR(iext, ::g->iext.generate(length()));
-	} else {
-	if ((type().cname() == "zEXt")) {
-		GENERATE_VAR(zext, ::g->zext.generate(length()));
-	} else {
-	if ((type().cname() == "tIME")) {
-		GENERATE_VAR(time, ::g->time_.generate());
-	} else {
-	if ((type().cname() == "pHYs")) {
-		GENERATE_VAR(phys, ::g->phys.generate());
-	} else {
-	if ((type().cname() == "bKGD")) {
-		GENERATE_VAR(bkgd, ::g->bkgd.generate(::g->chunk()[0]->ihdr().color_type()));
-	} else {
-	if ((type().cname() == "sBIT")) {
-		GENERATE_VAR(sbit, ::g->sbit.generate(::g->chunk()[0]->ihdr().color_type()));
-	} else {
-	if ((type().cname() == "sPLT")) {
-		GENERATE_VAR(splt, ::g->splt.generate(length()));
-	} else {
-	if ((type().cname() == "acTL")) {
-		GENERATE_VAR(actl, ::g->actl.generate());
-	} else {
-	if ((type().cname() == "fcTL")) {
-		GENERATE_VAR(fctl, ::g->fctl.generate());
-	} else {
-	if ((type().cname() == "fdAT")) {
-		GENERATE_VAR(fdat, ::g->fdat.generate());
-	} else {
-	if ((type().cname() == "IDAT")) {
-		std::string compressed_data = generate_data(::g->chunk()[0]->ihdr().width(), ::g->chunk()[0]->ihdr().height(), (PNG_COLOR_SPACE_TYPE) ::g->chunk()[0]->ihdr().color_type(), ::g->chunk()[0]->ihdr().bits(), (PNG_INTERLACE_METHOD) ::g->chunk()[0]->ihdr().interlace_method());
-		std::vector<std::string> good_data = { compressed_data };
-		bool evil = file_acc.set_evil_bit(false);
-		start_generation("data");
-		file_acc.file_string(good_data);
-		end_generation();
-		file_acc.set_evil_bit(evil);
-	} else {
-	if (((length() > 0) && (type().cname() != "IEND"))) {
-		GENERATE_VAR(data, ::g->data_.generate(length()));
-	};
-	};
-	};
-	};
-	};
-	};
-	};
-	};
-	};
-	};
-	};
-	};
-	};
-	};
-	};
-	};
+	crc_range = ChecksumStart(CHECKSUM_CRC32);
+	GENERATE_VAR(type, 5, field_id_PNG_CHUNK_type, ::g->type.generate<Generate>());
+	switch (STR2KEY(type().cname(), 4)) {
+	case STR2INT("IHDR"): {
+		GENERATE_VAR(ihdr, 18, field_id_PNG_CHUNK_ihdr, ::g->ihdr.generate<Generate>());
+		break;
+	}
+	case STR2INT("tEXt"): {
+		GENERATE_VAR(text, 21, field_id_PNG_CHUNK_text, ::g->text.generate<Generate>());
+		break;
+	}
+	case STR2INT("PLTE"): {
+		GENERATE_VAR(plte, 26, field_id_PNG_CHUNK_plte, ::g->plte.generate<Generate>(length()));
+		break;
+	}
+	case STR2INT("cHRM"): {
+		GENERATE_VAR(chrm, 33, field_id_PNG_CHUNK_chrm, ::g->chrm.generate<Generate>());
+		break;
+	}
+	case STR2INT("sRGB"): {
+		GENERATE_VAR(srgb, 35, field_id_PNG_CHUNK_srgb, ::g->srgb.generate<Generate>());
+		break;
+	}
+	case STR2INT("iEXt"): {
+		GENERATE_VAR(iext, 42, field_id_PNG_CHUNK_iext, ::g->iext.generate<Generate>(length()));
+		break;
+	}
+	case STR2INT("zEXt"): {
+		GENERATE_VAR(zext, 46, field_id_PNG_CHUNK_zext, ::g->zext.generate<Generate>(length()));
+		break;
+	}
+	case STR2INT("tIME"): {
+		GENERATE_VAR(time, 53, field_id_PNG_CHUNK_time, ::g->time_.generate<Generate>());
+		break;
+	}
+	case STR2INT("pHYs"): {
+		GENERATE_VAR(phys, 57, field_id_PNG_CHUNK_phys, ::g->phys.generate<Generate>());
+		break;
+	}
+	case STR2INT("bKGD"): {
+		GENERATE_VAR(bkgd, 63, field_id_PNG_CHUNK_bkgd, ::g->bkgd.generate<Generate>(::g->chunk()[0]->ihdr().color_type()));
+		break;
+	}
+	case STR2INT("sBIT"): {
+		GENERATE_VAR(sbit, 77, field_id_PNG_CHUNK_sbit, ::g->sbit.generate<Generate>(::g->chunk()[0]->ihdr().color_type()));
+		break;
+	}
+	case STR2INT("sPLT"): {
+		GENERATE_VAR(splt, 81, field_id_PNG_CHUNK_splt, ::g->splt.generate<Generate>(length()));
+		break;
+	}
+	case STR2INT("acTL"): {
+		GENERATE_VAR(actl, 84, field_id_PNG_CHUNK_actl, ::g->actl.generate<Generate>());
+		break;
+	}
+	case STR2INT("fcTL"): {
+		GENERATE_VAR(fctl, 94, field_id_PNG_CHUNK_fctl, ::g->fctl.generate<Generate>());
+		break;
+	}
+	case STR2INT("fdAT"): {
+		GENERATE_VAR(fdat, 97, field_id_PNG_CHUNK_fdat, ::g->fdat.generate<Generate>());
+		break;
+	}
+	default: {
+		if (((length() > 0) && (type().cname() != "IEND"))) {
+			GENERATE_VAR(data, 98, field_id_PNG_CHUNK_data, ::g->data_.generate<Generate>(length()));
+		};
+	}
 	};
 	pos_end = FTell();
 	correct_length = ((pos_end - pos_start) - 4);
 	if ((length() != correct_length)) {
-		FSeek((pos_start - 4));
+		FSeek<Generate>((pos_start - 4));
 		evil = SetEvilBit(false);
-		GENERATE_VAR(length, ::g->length.generate({ correct_length }));
+		GENERATE_VAR(length, 99, field_id_PNG_CHUNK_length, ::g->length.generate<Generate>({ correct_length }));
 		SetEvilBit(evil);
-		FSeek(pos_end);
+		FSeek<Generate>(pos_end);
 	};
-	data_size = (pos_end - pos_start);
-	crc_calc = Checksum(CHECKSUM_CRC32, pos_start, data_size);
-	GENERATE_VAR(crc, ::g->crc.generate({ crc_calc }));
+	crc_calc = ChecksumEnd(crc_range);
+	GENERATE_VAR(crc, 100, field_id_PNG_CHUNK_crc, ::g->crc.generate<Generate>({ crc_calc }));
 	if ((crc() != crc_calc)) {
 		SPrintf(msg, "*ERROR: CRC Mismatch @ chunk[%d]; in data: %08x; expected: %08x", ::g->CHUNK_CNT, crc(), crc_calc);
-		error_message(msg);
+		error_message<Generate>(msg);
 	};
 	::g->CHUNK_CNT++;
 	if ((type().cname() == "eXIf")) {
-		GENERATE_VAR(pad, ::g->pad.generate());
+		GENERATE_VAR(pad, 101, field_id_PNG_CHUNK_pad, ::g->pad.generate<Generate>());
 	};
 
 	_sizeof = FTell() - _startof;
@@ -2671,26 +2690,27 @@ PNG_CHUNK* PNG_CHUNK::generate() {
 
 
 
+template<bool Generate>
 void generate_file() {
-	::g = new globals_class();
+	::g = arena_new<globals_class>();
 
 	BigEndian();
 	::g->sec_num = 0;
 	::g->CHUNK_CNT = 0;
 	::g->evil = SetEvilBit(false);
-	GENERATE(sig, ::g->sig.generate());
+	GENERATE(sig, 1, field_id_sig, ::g->sig.generate<Generate>());
 	SetEvilBit(::g->evil);
 	if (((((::g->sig().btPngSignature()[0] != 0x8950) || (::g->sig().btPngSignature()[1] != 0x4E47)) || (::g->sig().btPngSignature()[2] != 0x0D0A)) || (::g->sig().btPngSignature()[3] != 0x1A0A))) {
-		error_message("*ERROR: File is not a PNG image. Template stopped.");
+		error_message<Generate>("*ERROR: File is not a PNG image. Template stopped.");
 		exit_template(-1);
 	};
 	ChangeArrayLength();
 	::g->chunk_count = 0;
 	::g->preferred_chunks = { "IHDR" };
 	::g->possible_chunks = { "IHDR" };
-	while (ReadBytes(::g->chunk_type, (FTell() + 4), 4, ::g->preferred_chunks, ::g->possible_chunks)) {
+	while (ReadBytes<Generate>(::g->chunk_type, (FTell() + 4), 4, ::g->preferred_chunks, ::g->possible_chunks)) {
 		SetBackColor(((::g->chunk_count++ % 2) ? cNone : cLtGray));
-		GENERATE(chunk, ::g->chunk.generate());
+		GENERATE(chunk, 102, field_id_chunk, ::g->chunk.generate<Generate>());
 		switch (STR2INT(::g->chunk_type)) {
 		case STR2INT("IHDR"):
 			switch (::g->chunk().ihdr().color_type()) {
@@ -2756,16 +2776,21 @@ void generate_file() {
 	};
 	if ((::g->CHUNK_CNT > 1)) {
 		if ((::g->chunk()[0]->type().cname() != "IHDR")) {
-			error_message("*ERROR: Chunk IHDR must be first chunk.");
+			error_message<Generate>("*ERROR: Chunk IHDR must be first chunk.");
 		};
 		if ((::g->chunk()[(::g->CHUNK_CNT - 1)]->type().cname() != "IEND")) {
-			error_message("*ERROR: Chunk IEND must be last chunk.");
+			error_message<Generate>("*ERROR: Chunk IEND must be last chunk.");
 		};
 	};
 
-	file_acc.finish();
+	file_acc.finish<Generate>();
 	delete_globals();
 }
 
-void delete_globals() { delete ::g; }
+void delete_globals() {
+	arena_delete(::g);
+	instance_arena.reset();
+}
+
+const uint64_t template_hash = 0x110a994b3024eacbULL;
 
@@ -0,0 +1,98 @@
+// afl_mutator_test.cpp
+// Minimal driver for the AFL++ custom mutator (afl_mutator.cpp)
+//
+// Plays the part of afl-fuzz: it writes generated decision files to a
+// temporary queue directory, announces and selects them, and passes every
+// mutation through afl_custom_post_process().  Build and run with
+// `make gif-afl-test'.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <stdint.h>
+#include <unistd.h>
+
+#include "formatfuzzer.h"
+
+extern "C" size_t ff_generate_seed(uint64_t seed, unsigned char** new_data);
+extern "C" void ff_set_decision_tail(int mode);
+extern "C" int process_data(const unsigned char *data, size_t size);
+extern "C" void *afl_custom_init(void *afl, unsigned int seed);
+extern "C" void afl_custom_deinit(void *data);
+extern "C" uint8_t afl_custom_queue_new_entry(void *data, const uint8_t *filename_new_queue, const uint8_t *filename_orig_queue);
+extern "C" uint8_t afl_custom_queue_get(void *data, const uint8_t *filename);
+extern "C" size_t afl_custom_fuzz(void *data, uint8_t *buf, size_t buf_size, uint8_t **out_buf, uint8_t *add_buf, size_t add_buf_size, size_t max_size);
+extern "C" size_t afl_custom_post_process(void *data, uint8_t *buf, size_t buf_size, uint8_t **out_buf);
+unsigned copy_rand(unsigned char *dest);
+unsigned int consumedRand();
+
+#define MAX_INPUT 65536
+
+static int failures = 0;
+
+#define CHECK(cond) do { if (!(cond)) { fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); failures++; } } while (0)
+
+// The decisions of the file generated from seed
+static std::vector<uint8_t> decisions(uint64_t seed) {
+	unsigned char *file = NULL;
+	ff_generate_seed(seed, &file);
+	std::vector<uint8_t> rand(consumedRand());
+	copy_rand(rand.data());
+	return rand;
+}
+
+int main() {
+	char dir[] = "/tmp/ff-afl-test-XXXXXX";
+	if (!mkdtemp(dir)) {
+		perror(dir);
+		return 1;
+	}
+	void *m = afl_custom_init(NULL, 1);
+
+	std::vector<std::string> queue;
+	std::vector<std::vector<uint8_t>> inputs;
+	for (uint64_t seed = 1; seed <= 3; ++seed) {
+		queue.push_back(std::string(dir) + "/id:00000" + std::to_string(seed));
+		inputs.push_back(decisions(seed));
+		FILE *f = fopen(queue.back().c_str(), "wb");
+		CHECK(f && fwrite(inputs.back().data(), 1, inputs.back().size(), f) == inputs.back().size());
+		if (f)
+			fclose(f);
+		afl_custom_queue_new_entry(m, (const uint8_t *) queue.back().c_str(), NULL);
+	}
+
+	int files = 0;
+	for (int i = 0; i < 300; ++i) {
+		size_t entry = i % queue.size();
+		afl_custom_queue_get(m, (const uint8_t *) queue[entry].c_str());
+		uint8_t *mutated = NULL, *file = NULL;
+		size_t size = afl_custom_fuzz(m, inputs[entry].data(), inputs[entry].size(), &mutated, NULL, 0, MAX_INPUT);
+		CHECK(mutated && size > 0 && size <= MAX_INPUT);
+		std::vector<uint8_t> copy(mutated, mutated + size);
+		files += afl_custom_post_process(m, copy.data(), copy.size(), &file) > 0 && file;
+	}
+	CHECK(files == 300);
+
+	// An input without a queue entry that cannot be parsed is tried only
+	// once and then mutated byte by byte
+	ff_set_decision_tail(FF_TAIL_FAIL);
+	uint8_t bad[] = {1, 2, 3};
+	for (int i = 0; i < 10; ++i) {
+		afl_custom_queue_get(m, (const uint8_t *) "/nonexistent");
+		uint8_t *mutated = NULL;
+		size_t size = afl_custom_fuzz(m, bad, sizeof(bad), &mutated, NULL, 0, MAX_INPUT);
+		CHECK(mutated && size == sizeof(bad));
+	}
+	// Neither the queue entries nor the failed input were added twice
+	CHECK(process_data(inputs[0].data(), inputs[0].size()) == (int) queue.size());
+
+	afl_custom_deinit(m);
+	for (const std::string& name : queue)
+		unlink(name.c_str());
+	rmdir(dir);
+	printf("AFL++ adapter: %d files generated, %d failures\n", files, failures);
+	return failures != 0;
+}
@@ -0,0 +1,91 @@
+// libfuzzer_mutator_test.cpp
+// Minimal driver for the libFuzzer adapter (libfuzzer_mutator.cpp)
+//
+// Plays the part of libFuzzer: it feeds generated decision files to the
+// custom mutator and crossover and runs every result through
+// LLVMFuzzerTestOneInput().  Build and run with `make gif-libfuzzer-test'.
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <stdint.h>
+
+#include "formatfuzzer.h"
+
+extern "C" size_t ff_generate_seed(uint64_t seed, unsigned char** new_data);
+extern "C" void ff_set_decision_tail(int mode);
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+extern "C" size_t LLVMFuzzerCustomMutator(uint8_t *data, size_t size, size_t max_size, unsigned int seed);
+extern "C" size_t LLVMFuzzerCustomCrossOver(const uint8_t *data1, size_t size1, const uint8_t *data2, size_t size2, uint8_t *out, size_t max_out_size, unsigned int seed);
+unsigned copy_rand(unsigned char *dest);
+unsigned int consumedRand();
+
+#define MAX_INPUT 65536
+
+static int files_tested = 0;
+static int failures = 0;
+
+#define CHECK(cond) do { if (!(cond)) { fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); failures++; } } while (0)
+
+extern "C" int ff_test_one_input(const uint8_t *data, size_t size) {
+	if (data && size)
+		files_tested++;
+	return 0;
+}
+
+// libFuzzer's own mutator is not linked in; change one byte instead
+extern "C" size_t LLVMFuzzerMutate(uint8_t *data, size_t size, size_t max_size) {
+	if (size)
+		data[size / 2] ^= 0xff;
+	return size;
+}
+
+// The decisions of the file generated from seed
+static std::vector<uint8_t> decisions(uint64_t seed) {
+	unsigned char *file = NULL;
+	ff_generate_seed(seed, &file);
+	std::vector<uint8_t> rand(consumedRand());
+	copy_rand(rand.data());
+	return rand;
+}
+
+int main() {
+	std::vector<uint8_t> input1 = decisions(1), input2 = decisions(2);
+	std::vector<uint8_t> out(MAX_INPUT);
+
+	for (unsigned seed = 0; seed < 100; ++seed) {
+		std::vector<uint8_t> data = input1;
+		data.resize(MAX_INPUT);
+		size_t size = LLVMFuzzerCustomMutator(data.data(), input1.size(), data.size(), seed);
+		CHECK(size > 0 && size <= MAX_INPUT);
+		int tested = files_tested;
+		LLVMFuzzerTestOneInput(data.data(), size);
+		CHECK(files_tested == tested + 1);
+
+		size = LLVMFuzzerCustomCrossOver(input1.data(), input1.size(), input2.data(), input2.size(), out.data(), out.size(), seed);
+		CHECK(size > 0 && size <= MAX_INPUT);
+		LLVMFuzzerTestOneInput(out.data(), size);
+		CHECK(files_tested == tested + 2);
+	}
+
+	// Inputs that cannot be parsed are spliced byte by byte
+	ff_set_decision_tail(FF_TAIL_FAIL);
+	const uint8_t short1[] = {1, 2, 3}, short2[] = {4, 5, 6, 7};
+	int spliced = 0;
+	for (unsigned seed = 0; seed < 100; ++seed) {
+		memset(out.data(), 0, 8);
+		size_t size = LLVMFuzzerCustomCrossOver(short1, sizeof(short1), short2, sizeof(short2), out.data(), 5, seed);
+		CHECK(size <= 5);
+		spliced += size > 0;
+		size_t head = 0;
+		while (head < size && head < sizeof(short1) && out[head] == short1[head])
+			head++;
+		CHECK(memcmp(out.data() + head, short2 + sizeof(short2) - (size - head), size - head) == 0);
+	}
+	CHECK(spliced > 50);
+
+	printf("libFuzzer adapter: %d files tested, %d failures\n", files_tested, failures);
+	return failures != 0;
+}